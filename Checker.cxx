@@ -14,6 +14,11 @@
  *************************************************************************/
 
 #include "Checker.hxx"
+#include "CheckerAsync.hxx"
+#include "CheckerBuffers.hxx"
+#include "CheckerFilePool.hxx"
+#include "CheckerMemory.hxx"
+#include "CheckerScan.hxx"
 #include <ROOT/RNTuple.hxx>
 #include <ROOT/RNTupleModel.hxx>
 #include <ROOT/RNTupleReader.hxx>
@@ -24,6 +29,8 @@
 #include <ROOT/RField.hxx>
 #include <ROOT/RNTupleUtil.hxx>
 
+#include <algorithm>
+#include <cstdint>
 #include <iomanip>
 #include <TTree.h>
 #include <TFile.h>
@@ -39,45 +46,169 @@
 
 namespace Checker {
 
+    namespace {
+        // Reads a scalar branch kBatchEntries entries at a time into a pooled buffer and passes each batch to fn
+        template <typename T, typename Fn>
+        void ForEachBatch(TBranch* branch, Fn&& fn) {
+            PooledBuffer<T> batch;
+            T value;
+            branch->SetAddress(&value);
+
+            const Long64_t nEntries = branch->GetEntries();
+            for (Long64_t first = 0; first < nEntries; first += kBatchEntries) {
+                const Long64_t last = std::min<Long64_t>(first + kBatchEntries, nEntries);
+                batch->clear();
+                for (Long64_t j = first; j < last; ++j) {
+                    branch->GetEntry(j);
+                    batch->push_back(value);
+                }
+                fn(*batch);
+            }
+            branch->ResetAddress();
+        }
+
+        // Reads a vector branch and passes the elements of about kBatchEntries elements' worth of entries to fn,
+        // flattened into one pooled buffer. ROOT streams every entry into the same pooled vector.
+        template <typename T, typename Fn>
+        void ForEachVectorBatch(TBranch* branch, Fn&& fn) {
+            PooledBuffer<T> batch;
+            PooledBuffer<T> entryValues(0);
+            std::vector<T>* vec = entryValues.Get();
+            branch->SetAddress(&vec);
+
+            const Long64_t nEntries = branch->GetEntries();
+            for (Long64_t j = 0; j < nEntries; ++j) {
+                branch->GetEntry(j);
+                batch->insert(batch->end(), vec->begin(), vec->end());
+                if (batch->size() >= kBatchEntries) {
+                    fn(*batch);
+                    batch->clear();
+                }
+            }
+            if (!batch->empty()) {
+                fn(*batch);
+            }
+            branch->ResetAddress();
+        }
+
+        // Reads a scalar RNTuple field kBatchEntries entries at a time into a pooled buffer and passes each batch to fn
+        template <typename T, typename Fn>
+        void ForEachBatch(ROOT::Experimental::RNTupleReader& reader, const std::string& fieldName, Fn&& fn) {
+            auto fieldView = reader.GetView<T>(fieldName);
+            PooledBuffer<T> batch;
+
+            const auto nEntries = reader.GetNEntries();
+            for (std::uint64_t first = 0; first < nEntries; first += kBatchEntries) {
+                const std::uint64_t last = std::min<std::uint64_t>(first + kBatchEntries, nEntries);
+                batch->clear();
+                for (std::uint64_t j = first; j < last; ++j) {
+                    batch->push_back(fieldView(j));
+                }
+                fn(*batch);
+            }
+        }
+
+        // Reads a vector RNTuple field and passes its elements to fn in flattened batches, as for TTree branches
+        template <typename T, typename Fn>
+        void ForEachVectorBatch(ROOT::Experimental::RNTupleReader& reader, const std::string& fieldName, Fn&& fn) {
+            auto fieldView = reader.GetView<std::vector<T>>(fieldName);
+            PooledBuffer<T> batch;
+
+            const auto nEntries = reader.GetNEntries();
+            for (std::uint64_t j = 0; j < nEntries; ++j) {
+                const auto& vec = fieldView(j);
+                batch->insert(batch->end(), vec.begin(), vec.end());
+                if (batch->size() >= kBatchEntries) {
+                    fn(*batch);
+                    batch->clear();
+                }
+            }
+            if (!batch->empty()) {
+                fn(*batch);
+            }
+        }
+    } // namespace
+
     Checker::Checker(const std::string& ttreeFile, const std::string& rntupleFile, const std::string& ttreeName, const std::string& rntupleName)
         : fTTreeFile(ttreeFile), fRNTupleFile(rntupleFile), fTTreeName(ttreeName), fRNTupleName(rntupleName) {
+        // Nothing is opened here; each check loads what it needs on first use
+    }
 
-        // Open the TTree file
-        tfile = std::unique_ptr<TFile>(TFile::Open(ttreeFile.c_str()));
+    Checker::~Checker() {
+        // The TTree is this Checker's alone while it holds the file; the file then goes back to the FilePool
+        if (ttree) {
+            ttree->ResetBranchAddresses();
+        }
+    }
+
+    TTree* Checker::LoadTTree() {
+        if (ttree) {
+            return ttree;
+        }
+
+        // Open the TTree file, or reuse one that an earlier Checker released to the pool
+        if (!tfile) {
+            tfile = FilePool::Instance().GetFile(fTTreeFile);
+        }
         if (!tfile || tfile->IsZombie()) {
-            throw std::runtime_error("Cannot open TTree file: " + ttreeFile);
+            throw std::runtime_error("Cannot open TTree file: " + fTTreeFile);
         }
         // Retrieve the TTree object
-        tfile = std::unique_ptr<TFile>(TFile::Open(ttreeFile.c_str()));
-        ttree = dynamic_cast<TTree*>(tfile->Get(ttreeName.c_str()));
-        if (!TTreeExists()) {
-            throw std::runtime_error("Cannot find TTree: " + ttreeName + " in file: " + ttreeFile);
+        ttree = dynamic_cast<TTree*>(tfile->Get(fTTreeName.c_str()));
+        if (!ttree) {
+            throw std::runtime_error("Cannot find TTree: " + fTTreeName + " in file: " + fTTreeFile);
         }
+        return ttree;
+    }
 
-        // Open the RNTuple file
-        rfile = std::unique_ptr<TFile>(TFile::Open(rntupleFile.c_str()));
-        if (!rfile || rfile->IsZombie()) {
-            throw std::runtime_error("Cannot open RNTuple file: " + rntupleFile);
-        }
-        if (!RNTupleExists()) {
-            throw std::runtime_error("Cannot find RNTuple: " + rntupleName + " in file: " + rntupleFile);
+    const ROOT::Experimental::RNTupleDescriptor& Checker::LoadDescriptor() {
+        if (fDescriptor) {
+            return *fDescriptor;
         }
 
-        // Initialize the RNTuple reader
-        rntupleReader = ROOT::Experimental::RNTupleReader::Open(rntupleName, rntupleFile);
-        if (!rntupleReader) {
-            throw std::runtime_error("Failed to open RNTupleReader.");
+        // Only the header and footer are read, and only once per RNTuple and process
+        try {
+            fDescriptor = FilePool::Instance().GetDescriptor(fRNTupleFile, fRNTupleName);
         }
+        catch (const std::exception&) {
+            // Look at the file only now, to tell a missing file from a missing RNTuple
+            if (!RNTupleExists()) {
+                if (!rfile || rfile->IsZombie()) {
+                    throw std::runtime_error("Cannot open RNTuple file: " + fRNTupleFile);
+                }
+                throw std::runtime_error("Cannot find RNTuple: " + fRNTupleName + " in file: " + fRNTupleFile);
+            }
+            throw;
+        }
+        return *fDescriptor;
     }
 
-    Checker::~Checker() {
-        if (tfile) {
-            tfile->Close();
+    ROOT::Experimental::RNTupleReader& Checker::LoadReader() {
+        if (rntupleReader) {
+            return *rntupleReader;
         }
+
+        // Report a missing file or RNTuple the same way as the metadata checks
+        LoadDescriptor();
+        if (!rfile) {
+            rfile = FilePool::Instance().GetFile(fRNTupleFile);
+        }
+        if (!rfile || rfile->IsZombie()) {
+            throw std::runtime_error("Cannot open RNTuple file: " + fRNTupleFile);
+        }
+        // Read through the pooled file, which the Checker holds for as long as the reader
+        rntupleReader = OpenRNTupleReader(*rfile, fRNTupleName);
+        if (!rntupleReader) {
+            throw std::runtime_error("Failed to open RNTupleReader.");
+        }
+        return *rntupleReader;
     }
 
     bool Checker::TTreeExists() {
         try {
+            if (!tfile) {
+                tfile = FilePool::Instance().GetFile(fTTreeFile);
+            }
             // Check if the TFile pointer is valid and the file is not in a zombie state
             if (!tfile || tfile->IsZombie()) {
                 return false;  // If the file is not valid, the TTree cannot exist
@@ -97,6 +228,13 @@ namespace Checker {
 
     bool Checker::RNTupleExists() {
         try {
+            if (!rfile) {
+                rfile = FilePool::Instance().GetFile(fRNTupleFile);
+            }
+            if (!rfile || rfile->IsZombie()) {
+                return false;
+            }
+
             // Retrieve the list of keys (objects) stored in the ROOT file
             auto keys = rfile->GetListOfKeys();
 
@@ -120,19 +258,20 @@ namespace Checker {
     }
 
     std::pair<int, int> Checker::CountEntries() {
-        return { static_cast<int>(ttree->GetEntries()), static_cast<int>(rntupleReader->GetNEntries()) };
+        // The RNTuple entry count is in its footer; no reader is needed
+        return { static_cast<int>(LoadTTree()->GetEntries()), static_cast<int>(LoadDescriptor().GetNEntries()) };
     }
 
     std::pair<int, int> Checker::CountFields() {
         // Get TTree field count
-        const auto ttreeBranches = ttree->GetListOfBranches();
+        const auto ttreeBranches = LoadTTree()->GetListOfBranches();
         const int ttreeFieldCount = ttreeBranches ? ttreeBranches->GetEntries() : 0;
 
         // To store counted fields
         int rntupleFieldCount = 0;
         try {
             // Using RNTupleInspector to count fields based on type patterns - for field matching capabilities
-            const auto inspector = ROOT::Experimental::RNTupleInspector::Create(fRNTupleName, fRNTupleFile);
+            const auto inspector = FilePool::Instance().GetInspector(fRNTupleFile, fRNTupleName);
             std::regex typePattern(".*");
             rntupleFieldCount = inspector->GetFieldCountByType(typePattern, true);
         }
@@ -146,7 +285,7 @@ namespace Checker {
         try {
             for (int i = 0; i < rntupleFieldCount - 1; ++i) {
                 try {
-                    const auto& fieldDescriptor = rntupleReader->GetDescriptor().GetFieldDescriptor(i);
+                    const auto& fieldDescriptor = LoadDescriptor().GetFieldDescriptor(i);
                     if (fieldDescriptor.GetFieldName() == "_0") {
                         ++extraFieldCount;
                     }
@@ -172,12 +311,12 @@ namespace Checker {
     std::vector<std::pair<std::string, std::string>> Checker::CompareFieldNames() {
         std::vector<std::pair<std::string, std::string>> fieldNames;
 
-        const auto ttreeBranches = ttree->GetListOfBranches();
+        const auto ttreeBranches = LoadTTree()->GetListOfBranches();
         const int ttreeFieldCount = ttreeBranches->GetEntries();
 
         // Store RNTuple fields in a map for easy lookup
         std::unordered_map<std::string, std::string> rntupleFields;
-        const auto& descriptor = rntupleReader->GetDescriptor();
+        const auto& descriptor = LoadDescriptor();
         const int rntupleFieldCount = descriptor.GetNFields();
 
         // Collect RNTuple field names
@@ -225,12 +364,12 @@ namespace Checker {
     std::vector<std::tuple<std::string, std::string, std::string>> Checker::CompareFieldTypes() {
         std::vector<std::tuple<std::string, std::string, std::string>> fieldTypes;
 
-        const auto ttreeBranches = ttree->GetListOfBranches();
+        const auto ttreeBranches = LoadTTree()->GetListOfBranches();
         const int ttreeFieldCount = ttreeBranches->GetEntries();
 
         // Store RNTuple fields and their types in a map for easy lookup
         std::unordered_map<std::string, std::string> rntupleFieldTypes;
-        const auto& descriptor = rntupleReader->GetDescriptor();
+        const auto& descriptor = LoadDescriptor();
         const int rntupleFieldCount = descriptor.GetNFields();
 
         for (int i = 0; i < rntupleFieldCount - 1; ++i) {
@@ -292,48 +431,21 @@ namespace Checker {
     size_t Checker::CountSubFieldsInBranch(TBranch* branch, const std::string& branchTypeName) {
         size_t totalSubfields = 0;
 
+        // Accumulates the number of elements over all entries of the branch
+        auto count = [&totalSubfields](const auto& batch) { totalSubfields += batch.size(); };
+
         // For integer branches
         if (branchTypeName == "vector<int>") {
-            std::vector<int>* vec = nullptr;
-            branch->SetAddress(&vec);
-
-            // Iterate over each entry in the branch to accumulate the total number of subfields
-            for (Long64_t j = 0; j < branch->GetEntries(); ++j) {
-                branch->GetEntry(j);
-                if (vec) {
-                    totalSubfields += vec->size();
-                }
-            }
+            ForEachVectorBatch<int>(branch, count);
         } //     + float bramches
         else if (branchTypeName == "vector<float>") {
-            std::vector<float>* vec = nullptr;
-            branch->SetAddress(&vec);
-            for (Long64_t j = 0; j < branch->GetEntries(); ++j) {
-                branch->GetEntry(j);
-                if (vec) {
-                    totalSubfields += vec->size();
-                }
-            }
+            ForEachVectorBatch<float>(branch, count);
         } //     + double branches
         else if (branchTypeName == "vector<double>") {
-            std::vector<double>* vec = nullptr;
-            branch->SetAddress(&vec);
-            for (Long64_t j = 0; j < branch->GetEntries(); ++j) {
-                branch->GetEntry(j);
-                if (vec) {
-                    totalSubfields += vec->size();
-                }
-            }
+            ForEachVectorBatch<double>(branch, count);
         } //     + bool branches
         else if (branchTypeName == "vector<bool>") {
-            std::vector<bool>* vec = nullptr;
-            branch->SetAddress(&vec);
-            for (Long64_t j = 0; j < branch->GetEntries(); ++j) {
-                branch->GetEntry(j);
-                if (vec) {
-                    totalSubfields += vec->size();
-                }
-            }
+            ForEachVectorBatch<bool>(branch, count);
         }
         return totalSubfields;
     }
@@ -341,15 +453,14 @@ namespace Checker {
     size_t Checker::CountSubFieldsInRNTuple(const std::string& branchName, const std::string& rntupleSubFieldType) {
         size_t numSubfields = 0;
 
-        // Ensure the RNTupleReader is initialised
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
         try {
             // Retrieve the descriptor of the RNTuple, for its information about the fields
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
 
+            // Accumulates the number of elements over all entries of the field
+            auto count = [&numSubfields](const auto& batch) { numSubfields += batch.size(); };
+
             // Create a regex pattern to match the vector type corresponding to the given subfield type
             std::string regexPattern = "std::vector<.*" + rntupleSubFieldType + ".*>";
             std::regex typeVectorRegex(regexPattern);
@@ -372,48 +483,16 @@ namespace Checker {
 
                     // Depending on the subfield type, get the corresponding vector view and count its elements
                     if (rntupleSubFieldType.find("int") != std::string::npos) {
-                        auto fieldView = rntupleReader->GetView<std::vector<int>>(branchName);
-                        for (auto entryId : *rntupleReader) {
-
-                            // Ensure the entry ID is within valid range
-                            if (entryId >= rntupleReader->GetNEntries()) {
-                                throw std::out_of_range("Entry ID is out of range");
-                            }
-
-                            // Count the number of elements in the vector
-                            const auto& vec = fieldView(entryId);
-                            numSubfields += vec.size();
-                        }
+                        ForEachVectorBatch<int>(LoadReader(), branchName, count);
                     }
                     else if (rntupleSubFieldType.find("float") != std::string::npos) {
-                        auto fieldView = rntupleReader->GetView<std::vector<float>>(branchName);
-                        for (auto entryId : *rntupleReader) {
-                            if (entryId >= rntupleReader->GetNEntries()) {
-                                throw std::out_of_range("Entry ID is out of range");
-                            }
-                            const auto& vec = fieldView(entryId);
-                            numSubfields += vec.size();
-                        }
+                        ForEachVectorBatch<float>(LoadReader(), branchName, count);
                     }
                     else if (rntupleSubFieldType.find("double") != std::string::npos) {
-                        auto fieldView = rntupleReader->GetView<std::vector<double>>(branchName);
-                        for (auto entryId : *rntupleReader) {
-                            if (entryId >= rntupleReader->GetNEntries()) {
-                                throw std::out_of_range("Entry ID is out of range");
-                            }
-                            const auto& vec = fieldView(entryId);
-                            numSubfields += vec.size();
-                        }
+                        ForEachVectorBatch<double>(LoadReader(), branchName, count);
                     }
                     else if (rntupleSubFieldType.find("bool") != std::string::npos) {
-                        auto fieldView = rntupleReader->GetView<std::vector<bool>>(branchName);
-                        for (auto entryId : *rntupleReader) {
-                            if (entryId >= rntupleReader->GetNEntries()) {
-                                throw std::out_of_range("Entry ID is out of range");
-                            }
-                            const auto& vec = fieldView(entryId);
-                            numSubfields += vec.size();
-                        }
+                        ForEachVectorBatch<bool>(LoadReader(), branchName, count);
                     }
                 }
             }
@@ -433,11 +512,11 @@ namespace Checker {
         std::vector<std::tuple<std::string, std::vector<std::string>, std::vector<std::string>, size_t, size_t>> subFieldComparisons;
 
         // Get the list of branches from the TTree
-        const auto ttreeBranches = ttree->GetListOfBranches();
+        const auto ttreeBranches = LoadTTree()->GetListOfBranches();
         const int ttreeFieldCount = ttreeBranches->GetEntries();
 
         // Get the descriptor of the RNTuple to access its fields
-        const auto& descriptor = rntupleReader->GetDescriptor();
+        const auto& descriptor = LoadDescriptor();
 
         // Iterate over each branch in the TTree
         for (int i = 0; i < ttreeFieldCount; ++i) {
@@ -484,15 +563,18 @@ namespace Checker {
         return subFieldComparisons;
     }
 
+    ScanResult Checker::Scan(ScanVisitor& visitor, const ScanRequest& request) {
+        return RunScan(PlanScan({ fTTreeFile, fRNTupleFile, fTTreeName, fRNTupleName }, request), &visitor);
+    }
 
-    std::vector<int> Checker::ReadIntFromTTree() {
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
+    ScanHandle Checker::StartScan(const ScanRequest& request, ScanVisitor* visitor) {
+        return ::Checker::StartScan({ fTTreeFile, fRNTupleFile, fTTreeName, fRNTupleName }, request, visitor);
+    }
 
+    std::vector<int> Checker::ReadIntFromTTree() {
         std::vector<int> intValues;
 
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -507,27 +589,21 @@ namespace Checker {
             // Get the type of the branch and check if it is of type "Int_t"
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "Int_t") {
-                int value;
-                branch->SetAddress(&value);
-
-                // Loop over all entries in the branch and extract the integer values
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    intValues.push_back(value);
-                }
+                MemoryPhase phase("ReadIntFromTTree", branch->GetName());
+                intValues.reserve(intValues.size() + branch->GetEntries());
+                // Read the branch batch by batch and append the integer values
+                ForEachBatch<int>(branch, [&](const std::vector<int>& batch) {
+                    intValues.insert(intValues.end(), batch.begin(), batch.end());
+                });
             }
         }
         return intValues;
     }
 
     std::vector<float> Checker::ReadFloatFromTTree() {
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
-
         std::vector<float> floatValues;
 
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -542,27 +618,21 @@ namespace Checker {
             // Get the type of the branch and check if it is of type "Float_t"
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "Float_t") {
-                float value;
-                branch->SetAddress(&value);
-
-                // Loop over all entries in the branch and extract the floating-point values
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    floatValues.push_back(value);
-                }
+                MemoryPhase phase("ReadFloatFromTTree", branch->GetName());
+                floatValues.reserve(floatValues.size() + branch->GetEntries());
+                // Read the branch batch by batch and append the floating-point values
+                ForEachBatch<float>(branch, [&](const std::vector<float>& batch) {
+                    floatValues.insert(floatValues.end(), batch.begin(), batch.end());
+                });
             }
         }
         return floatValues;
     }
 
     std::vector<double> Checker::ReadDoubleFromTTree() {
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
-
         std::vector<double> doubleValues;
 
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -577,27 +647,21 @@ namespace Checker {
             // Get the type of the branch and check if it is of type "Double_t"
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "Double_t") {
-                double value;
-                branch->SetAddress(&value);
-
-                // Loop over all entries in the branch and extract the double precision values
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    doubleValues.push_back(value);
-                }
+                MemoryPhase phase("ReadDoubleFromTTree", branch->GetName());
+                doubleValues.reserve(doubleValues.size() + branch->GetEntries());
+                // Read the branch batch by batch and append the double precision values
+                ForEachBatch<double>(branch, [&](const std::vector<double>& batch) {
+                    doubleValues.insert(doubleValues.end(), batch.begin(), batch.end());
+                });
             }
         }
         return doubleValues;
     }
 
     std::vector<bool> Checker::ReadBoolFromTTree() {
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
-
         std::vector<bool> boolValues;
 
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -612,14 +676,12 @@ namespace Checker {
             // Get the type of the branch and check if it is of type "Bool_t"
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "Bool_t") {
-                bool value;
-                branch->SetAddress(&value);
-
-                // Loop over all entries in the branch and extract the boolean values
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    boolValues.push_back(value);
-                }
+                MemoryPhase phase("ReadBoolFromTTree", branch->GetName());
+                boolValues.reserve(boolValues.size() + branch->GetEntries());
+                // Read the branch batch by batch and append the boolean values
+                ForEachBatch<bool>(branch, [&](const std::vector<bool>& batch) {
+                    boolValues.insert(boolValues.end(), batch.begin(), batch.end());
+                });
             }
         }
         return boolValues;
@@ -628,12 +690,8 @@ namespace Checker {
     std::vector<int> Checker::ReadIntFromRNTuple() {
         std::vector<int> intVector;
 
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
 
             // Iterate over all fields in the RNTuple to find int fields
@@ -644,12 +702,12 @@ namespace Checker {
 
                 // Check if the field is of type "int"
                 if (fieldTypeName.find("int") != std::string::npos) {
-                    auto fieldView = rntupleReader->GetView<int>(fieldName);
-
-                    // Iterate through all entries and store the values
-                    for (auto entryId : *rntupleReader) {
-                        intVector.push_back(fieldView(entryId));
-                    }
+                    MemoryPhase phase("ReadIntFromRNTuple", fieldName);
+                    intVector.reserve(intVector.size() + LoadReader().GetNEntries());
+                    // Read the field batch by batch and store the values
+                    ForEachBatch<int>(LoadReader(), fieldName, [&](const std::vector<int>& batch) {
+                        intVector.insert(intVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -664,12 +722,8 @@ namespace Checker {
     std::vector<float> Checker::ReadFloatFromRNTuple() {
         std::vector<float> floatVector;
 
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
 
             // Iterate over all fields in the RNTuple to find float fields
@@ -680,12 +734,12 @@ namespace Checker {
 
                 // Check if the field is of type "float"
                 if (fieldTypeName == "float") {
-                    auto fieldView = rntupleReader->GetView<float>(fieldName);
-
-                    // Iterate through all entries and store the values
-                    for (auto entryId : *rntupleReader) {
-                        floatVector.push_back(fieldView(entryId));
-                    }
+                    MemoryPhase phase("ReadFloatFromRNTuple", fieldName);
+                    floatVector.reserve(floatVector.size() + LoadReader().GetNEntries());
+                    // Read the field batch by batch and store the values
+                    ForEachBatch<float>(LoadReader(), fieldName, [&](const std::vector<float>& batch) {
+                        floatVector.insert(floatVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -700,12 +754,8 @@ namespace Checker {
     std::vector<double> Checker::ReadDoubleFromRNTuple() {
         std::vector<double> doubleVector;
 
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
 
             // Iterate over all fields in the RNTuple to find double fields
@@ -716,12 +766,12 @@ namespace Checker {
 
                 // Check if the field is of type "double"
                 if (fieldTypeName == "double") {
-                    auto fieldView = rntupleReader->GetView<double>(fieldName);
-
-                    // Iterate through all entries and store the values
-                    for (auto entryId : *rntupleReader) {
-                        doubleVector.push_back(fieldView(entryId));
-                    }
+                    MemoryPhase phase("ReadDoubleFromRNTuple", fieldName);
+                    doubleVector.reserve(doubleVector.size() + LoadReader().GetNEntries());
+                    // Read the field batch by batch and store the values
+                    ForEachBatch<double>(LoadReader(), fieldName, [&](const std::vector<double>& batch) {
+                        doubleVector.insert(doubleVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -736,12 +786,8 @@ namespace Checker {
     std::vector<bool> Checker::ReadBoolFromRNTuple() {
         std::vector<bool> boolVector;
 
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
 
             // Iterate over all fields in the RNTuple to find bool fields
@@ -752,12 +798,12 @@ namespace Checker {
 
                 // Check if the field is of type "bool"
                 if (fieldTypeName == "bool") {
-                    auto fieldView = rntupleReader->GetView<bool>(fieldName);
-
-                    // Iterate through all entries and store the values
-                    for (auto entryId : *rntupleReader) {
-                        boolVector.push_back(fieldView(entryId));
-                    }
+                    MemoryPhase phase("ReadBoolFromRNTuple", fieldName);
+                    boolVector.reserve(boolVector.size() + LoadReader().GetNEntries());
+                    // Read the field batch by batch and store the values
+                    ForEachBatch<bool>(LoadReader(), fieldName, [&](const std::vector<bool>& batch) {
+                        boolVector.insert(boolVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -770,15 +816,10 @@ namespace Checker {
     }
 
     std::vector<int> Checker::ReadIntVectorFromTTree() {
-        // Ensure the TTree pointer is not null
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
-
         std::vector<int> intVector;
 
         // Get the list of branches from the TTree
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -793,21 +834,12 @@ namespace Checker {
             // Check if the branch is of type vector<int>
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "vector<int>") {
-                std::vector<int>* vec = nullptr;
-                branch->SetAddress(&vec);
-
-                int totalSubfields = 0;  // to count elements in vector
-
-                // Iterate over all entries for the current branch
-                for (Long64_t j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    if (vec) {
-                        totalSubfields += vec->size(); // count number of elements in vector for this entry
+                MemoryPhase phase("ReadIntVectorFromTTree", branch->GetName());
 
-                        // Append the contents of vec to the combined vector
-                        intVector.insert(intVector.end(), vec->begin(), vec->end());
-                    }
-                }
+                // Read the branch in batches of elements and append them to the combined vector
+                ForEachVectorBatch<int>(branch, [&](const std::vector<int>& batch) {
+                    intVector.insert(intVector.end(), batch.begin(), batch.end());
+                });
             }
         }
 
@@ -815,15 +847,10 @@ namespace Checker {
     }
 
     std::vector<float> Checker::ReadFloatVectorFromTTree() {
-        // Ensure the TTree pointer is not null
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
-
         std::vector<float> floatVector;
 
         // Retrieve the list of branches from the TTree
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -838,32 +865,22 @@ namespace Checker {
             // Check if the branch is of type vector<float>
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "vector<float>") {
-                std::vector<float>* vec = nullptr;
-                branch->SetAddress(&vec);
+                MemoryPhase phase("ReadFloatVectorFromTTree", branch->GetName());
 
-                // Iterate over all entries for the current branch
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    if (vec) {
-                        // Append the contents of vec to the combined vector
-                        floatVector.insert(floatVector.end(), vec->begin(), vec->end());
-                    }
-                }
+                // Read the branch in batches of elements and append them to the combined vector
+                ForEachVectorBatch<float>(branch, [&](const std::vector<float>& batch) {
+                    floatVector.insert(floatVector.end(), batch.begin(), batch.end());
+                });
             }
         }
         return floatVector;
     }
 
     std::vector<double> Checker::ReadDoubleVectorFromTTree() {
-        // Ensure the TTree pointer is not null
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
-
         std::vector<double> doubleVector;
 
         // Retrieve the list of branches from the TTree
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -878,31 +895,22 @@ namespace Checker {
             // Check if the branch is of type vector<double>
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "vector<double>") {
-                std::vector<double>* vec = nullptr;
-                branch->SetAddress(&vec);
+                MemoryPhase phase("ReadDoubleVectorFromTTree", branch->GetName());
 
-                // Iterate over all entries for the current branch
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    if (vec) {
-                        // Append the contents of vec to the combined vector
-                        doubleVector.insert(doubleVector.end(), vec->begin(), vec->end());
-                    }
-                }
+                // Read the branch in batches of elements and append them to the combined vector
+                ForEachVectorBatch<double>(branch, [&](const std::vector<double>& batch) {
+                    doubleVector.insert(doubleVector.end(), batch.begin(), batch.end());
+                });
             }
         }
         return doubleVector;
     }
 
     std::vector<bool> Checker::ReadBoolVectorFromTTree() {
-        // Ensure the TTree pointer is not null
-        if (!ttree) {
-            throw std::runtime_error("TTree pointer is null");
-        }
         std::vector<bool> boolVector;
 
         // Retrieve the list of branches from the TTree
-        TObjArray* branches = ttree->GetListOfBranches();
+        TObjArray* branches = LoadTTree()->GetListOfBranches();
         if (!branches) {
             throw std::runtime_error("TTree has no branches");
         }
@@ -917,33 +925,23 @@ namespace Checker {
             // Check if the branch is of type vector<bool>
             std::string branchTypeName = branch->GetLeaf(branch->GetName())->GetTypeName();
             if (branchTypeName == "vector<bool>") {
-                std::vector<bool>* vec = nullptr;
-                branch->SetAddress(&vec);
+                MemoryPhase phase("ReadBoolVectorFromTTree", branch->GetName());
 
-                // Iterate over all entries for the current branch
-                for (int j = 0; j < branch->GetEntries(); ++j) {
-                    branch->GetEntry(j);
-                    if (vec) {
-                        // Append the contents of vec to the combined vector
-                        boolVector.insert(boolVector.end(), vec->begin(), vec->end());
-                    }
-                }
+                // Read the branch in batches of elements and append them to the combined vector
+                ForEachVectorBatch<bool>(branch, [&](const std::vector<bool>& batch) {
+                    boolVector.insert(boolVector.end(), batch.begin(), batch.end());
+                });
             }
         }
         return boolVector;
     }
 
     std::vector<int> Checker::ReadIntVectorFromRNTuple() {
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         std::vector<int> intVector;
 
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
-            size_t numSubfields = 0;
 
             // Regex to match forms of integer vector types
             std::regex intVectorRegex(R"(std::vector<.*int.*>)");
@@ -955,25 +953,12 @@ namespace Checker {
 
                 // Check if field type matches a vector of integers
                 if (std::regex_match(fieldTypeName, intVectorRegex)) {
+                    MemoryPhase phase("ReadIntVectorFromRNTuple", fieldName);
 
-                    // Create a view for the vector<int> field
-                    auto fieldView = rntupleReader->GetView<std::vector<int>>(fieldName);
-
-                    // Iterate over all entries
-                    for (auto entryId : *rntupleReader) {
-                        if (entryId >= rntupleReader->GetNEntries()) {
-                            throw std::out_of_range("Entry ID is out of range");
-                        }
-
-                        // vector<int> for the current entry
-                        const auto& vec = fieldView(entryId);
-
-                        intVector.insert(intVector.end(), vec.begin(), vec.end());
-
-                        numSubfields += vec.size();
-                    }
-                }
-                else {
+                    // Read the field in batches of elements and append them to the combined vector
+                    ForEachVectorBatch<int>(LoadReader(), fieldName, [&](const std::vector<int>& batch) {
+                        intVector.insert(intVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -986,14 +971,10 @@ namespace Checker {
     }
 
     std::vector<float> Checker::ReadFloatVectorFromRNTuple() {
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         std::vector<float> floatVector;
 
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const float rntupleFieldCount = descriptor.GetNFields();
 
             // Regex to match forms of float vector types
@@ -1006,16 +987,12 @@ namespace Checker {
 
                 // Check if field type matches float vector
                 if (std::regex_match(fieldTypeName, floatVectorRegex)) {
-                    auto fieldView = rntupleReader->GetView<std::vector<float>>(fieldName);
+                    MemoryPhase phase("ReadFloatVectorFromRNTuple", fieldName);
 
-                    for (auto entryId : *rntupleReader) {
-                        if (entryId >= rntupleReader->GetNEntries()) {
-                            throw std::out_of_range("Entry ID is out of range");
-                        }
-
-                        const auto& vec = fieldView(entryId);
-                        floatVector.insert(floatVector.end(), vec.begin(), vec.end());
-                    }
+                    // Read the field in batches of elements and append them to the combined vector
+                    ForEachVectorBatch<float>(LoadReader(), fieldName, [&](const std::vector<float>& batch) {
+                        floatVector.insert(floatVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -1028,14 +1005,10 @@ namespace Checker {
     }
 
     std::vector<double> Checker::ReadDoubleVectorFromRNTuple() {
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         std::vector<double> doubleVector;
 
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const double rntupleFieldCount = descriptor.GetNFields();
 
             // Regex to match forms of double vector types
@@ -1048,16 +1021,12 @@ namespace Checker {
 
                 // Check if field type matches double vector
                 if (std::regex_match(fieldTypeName, doubleVectorRegex)) {
-                    auto fieldView = rntupleReader->GetView<std::vector<double>>(fieldName);
+                    MemoryPhase phase("ReadDoubleVectorFromRNTuple", fieldName);
 
-                    for (auto entryId : *rntupleReader) {
-                        if (entryId >= rntupleReader->GetNEntries()) {
-                            throw std::out_of_range("Entry ID is out of range");
-                        }
-
-                        const auto& vec = fieldView(entryId);
-                        doubleVector.insert(doubleVector.end(), vec.begin(), vec.end());
-                    }
+                    // Read the field in batches of elements and append them to the combined vector
+                    ForEachVectorBatch<double>(LoadReader(), fieldName, [&](const std::vector<double>& batch) {
+                        doubleVector.insert(doubleVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -1070,14 +1039,10 @@ namespace Checker {
     }
 
     std::vector<bool> Checker::ReadBoolVectorFromRNTuple() {
-        if (!rntupleReader) {
-            throw std::runtime_error("RNTupleReader pointer is null");
-        }
-
         std::vector<bool> boolVector;
 
         try {
-            const auto& descriptor = rntupleReader->GetDescriptor();
+            const auto& descriptor = LoadDescriptor();
             const int rntupleFieldCount = descriptor.GetNFields();
 
             // Regex to match this exact form!
@@ -1090,16 +1055,12 @@ namespace Checker {
 
                 // Exactly type "std::vector<bool>" to be matched
                 if (std::regex_match(fieldTypeName, boolVectorRegex)) {
-                    auto fieldView = rntupleReader->GetView<std::vector<bool>>(fieldName);
+                    MemoryPhase phase("ReadBoolVectorFromRNTuple", fieldName);
 
-                    for (auto entryId : *rntupleReader) {
-                        if (entryId >= rntupleReader->GetNEntries()) {
-                            throw std::out_of_range("Entry ID is out of range");
-                        }
-
-                        const auto& vec = fieldView(entryId);
-                        boolVector.insert(boolVector.end(), vec.begin(), vec.end());
-                    }
+                    // Read the field in batches of elements and append them to the combined vector
+                    ForEachVectorBatch<bool>(LoadReader(), fieldName, [&](const std::vector<bool>& batch) {
+                        boolVector.insert(boolVector.end(), batch.begin(), batch.end());
+                    });
                 }
             }
         }
@@ -19,6 +19,7 @@
 #include <ROOT/RNTuple.hxx>
 #include <ROOT/RNTupleModel.hxx>
 #include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleDescriptor.hxx>
 #include <ROOT/RPageStorageFile.hxx>
 #include <ROOT/RError.hxx>
 #include <ROOT/RField.hxx>
@@ -46,6 +47,10 @@
   */
 namespace Checker {
     struct CheckerConfig;
+    struct ScanRequest;
+    struct ScanResult;
+    class ScanHandle;
+    class ScanVisitor;
 
     class Checker {
 
@@ -54,22 +59,25 @@ namespace Checker {
         /**
          * @brief Constructs a Checker object for comparing TTree and RNTuple data.
          *
-         * This constructor opens the provided TTree and RNTuple files, initializes the respective data structures,
-         * and checks for the existence of the specified TTree and RNTuple objects.
+         * The constructor only stores the paths and names. Each check loads what it needs on first use: the
+         * TTree, the RNTuple descriptor (header and footer only), or a full RNTupleReader for the Read* functions.
+         * Files and RNTuple descriptors come from the process-wide FilePool. Descriptors are shared; each file is
+         * held by one Checker at a time, and a Checker created after another one is destroyed reuses its files.
          *
          * @param - ttreeFile Path to the file containing the TTree.
          * @param - rntupleFile Path to the file containing the RNTuple.
          * @param - ttreeName Name of the TTree within the file.
          * @param - rntupleName Name of the RNTuple within the file.
          *
-         * @throws std::runtime_error if the TTree or RNTuple cannot be found or opened.
+         * The checks throw std::runtime_error on first use if the TTree or RNTuple cannot be found or opened.
          */
         Checker(const std::string& ttreeFile, const std::string& rntupleFile, const std::string& ttreeName, const std::string& rntupleName);
 
         /**
          * @brief Destructor for the Checker class.
          *
-         * This destructor ensures that the TFile associated with the TTree is properly closed.
+         * This destructor releases the branch addresses of the TTree. The files go back to the FilePool and stay
+         * open for later Checkers until the pool evicts them.
          */
         ~Checker();
 
@@ -255,18 +263,60 @@ namespace Checker {
          */
         std::vector<std::tuple<std::string, std::vector<std::string>, std::vector<std::string>, size_t, size_t>> CompareSubFields();
 
+        /**
+         * @brief Runs the value comparison and statistics of a request over both files in one scan, and streams
+         *        every batch of values and every difference to a visitor as the scan finds it.
+         *
+         * Unlike the Read* functions, nothing is collected over the whole file: each batch is handed to the
+         * visitor and its buffer reused for the next. See PlanScan and RunScan.
+         *
+         * @return The outcome of the scan, as RunScan returns it.
+         * @throws std::runtime_error if either side cannot be opened or the request is invalid for these files.
+         */
+        ScanResult Scan(ScanVisitor& visitor, const ScanRequest& request);
+
+        /**
+         * @brief Starts the checks of a request on this pair on a thread of its own and returns at once, with a
+         *        handle to query the progress, cancel the scan or wait for its result. See StartScan.
+         *
+         * The scan does not use this Checker, which may be destroyed while the scan runs.
+         */
+        ScanHandle StartScan(const ScanRequest& request, ScanVisitor* visitor = nullptr);
+
     private:
+        /**
+         * @brief Opens the TTree file and locates the TTree on first use.
+         *
+         * @throws std::runtime_error if the file cannot be opened or does not contain the TTree.
+         */
+        TTree* LoadTTree();
+
+        /**
+         * @brief Reads the RNTuple header and footer on first use, without opening a reader.
+         *
+         * @throws std::runtime_error if the file cannot be opened or does not contain the RNTuple.
+         */
+        const ROOT::Experimental::RNTupleDescriptor& LoadDescriptor();
+
+        /**
+         * @brief Opens the full RNTupleReader on first use, for the functions that read values.
+         *
+         * @throws std::runtime_error if the file cannot be opened or does not contain the RNTuple.
+         */
+        ROOT::Experimental::RNTupleReader& LoadReader();
+
         std::string fTTreeFile;         // Path to the ROOT file containing the TTree
         std::string fRNTupleFile;       //                     & containing RNTuple
         std::string fTTreeName;         // Name of the TTree from ROOT file for TTree specified for check
         std::string fRNTupleName;       //           & RNTuple in ROOT file for RNTuple
 
-        std::unique_ptr<TFile> tfile;   // Unique pointer to the ROOT file containing the TTree
-        std::unique_ptr<TFile> rfile;   // Unique pointer to the ROOT file containing the RNTuple
+        std::shared_ptr<TFile> tfile;   // ROOT file containing the TTree, lent by the FilePool
+        std::shared_ptr<TFile> rfile;   // ROOT file containing the RNTuple, lent by the FilePool
 
         // TTree's and RNTuple's continued read access in Checker:
-        TTree* ttree;                                                     // Pointer to the TTree
+        TTree* ttree = nullptr;                                           // Pointer to the TTree, set by LoadTTree
         std::unique_ptr<ROOT::Experimental::RNTupleReader> rntupleReader; // Pointer to the RNTuple reader
+        std::shared_ptr<const ROOT::Experimental::RNTupleDescriptor> fDescriptor; // RNTuple metadata, shared through the FilePool
     };
 } // namespace Checker
 
@@ -0,0 +1,84 @@
+/// \file CheckerAsync.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerAsync.hxx"
+#include "CheckerFrame.hxx"
+
+#include <TROOT.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Checker {
+
+    void ScanHandle::Cancel() {
+        if (fControl) {
+            fControl->fCancel = true;
+        }
+    }
+
+    bool ScanHandle::IsCancelled() const {
+        return fControl && fControl->fCancel;
+    }
+
+    long long ScanHandle::GetEntriesDone() const {
+        return fControl ? fControl->fEntriesDone.load() : 0;
+    }
+
+    long long ScanHandle::GetEntriesTotal() const {
+        return fControl ? fControl->fEntriesTotal.load() : 0;
+    }
+
+    double ScanHandle::GetProgress() const {
+        if (IsReady()) {
+            return 1.0;
+        }
+        const long long total = GetEntriesTotal();
+        return total > 0 ? std::min(1.0, static_cast<double>(GetEntriesDone()) / total) : 0.0;
+    }
+
+    bool ScanHandle::IsReady() const {
+        return WaitFor(std::chrono::milliseconds(0));
+    }
+
+    bool ScanHandle::WaitFor(std::chrono::milliseconds timeout) const {
+        return fResult.valid() && fResult.wait_for(timeout) == std::future_status::ready;
+    }
+
+    const ScanResult& ScanHandle::Get() const {
+        if (!fResult.valid()) {
+            throw std::runtime_error("Scan handle does not refer to a scan");
+        }
+        return fResult.get();
+    }
+
+    ScanHandle StartScan(const PairSpec& pair, const ScanRequest& request, ScanVisitor* visitor) {
+        ScanHandle handle;
+        handle.fControl = std::make_shared<ScanControl>();
+        ROOT::EnableThreadSafety();
+        handle.fResult = std::async(std::launch::async, [pair, request, visitor, control = handle.fControl]() {
+            const ScanPlan plan = PlanScan(pair, request);
+            if (request.fEngine == ScanEngine::kDataFrame && !control->fCancel) {
+                control->fEntriesTotal = plan.fRanges.empty() ? 0 : plan.fRanges.back().fFirst + plan.fRanges.back().fNEntries;
+                ScanResult result = RunFrameScan(plan);
+                control->fEntriesDone = control->fEntriesTotal.load();
+                return result;
+            }
+            return RunScan(plan, visitor, control.get());
+        }).share();
+        return handle;
+    }
+
+} // namespace Checker
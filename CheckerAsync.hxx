@@ -0,0 +1,92 @@
+/// \file CheckerAsync.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERASYNC_HXX
+#define CHECKERASYNC_HXX
+
+#include "CheckerScan.hxx"
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+namespace Checker {
+
+    /**
+     * @brief A scan running on a thread of its own, see StartScan.
+     *
+     * Handles are cheap to copy and all copies refer to the same scan. Destroying the last handle of a scan
+     * that is still running waits for it to finish; Cancel() first keeps that wait to one range.
+     */
+    class ScanHandle {
+    public:
+        ScanHandle() = default;
+
+        /// False for a default-constructed handle
+        bool IsValid() const { return fResult.valid(); }
+
+        /**
+         * @brief Asks the scan to stop before its next range. Returns at once; the result then has fCancelled set.
+         */
+        void Cancel();
+        bool IsCancelled() const;
+
+        /// Entries scanned so far, and in total once the scan is planned (0 before)
+        long long GetEntriesDone() const;
+        long long GetEntriesTotal() const;
+
+        /**
+         * @brief Returns the fraction of the entries scanned, from 0 to 1; 1 once the scan has finished.
+         */
+        double GetProgress() const;
+
+        /// True once the result is available, without waiting
+        bool IsReady() const;
+
+        /**
+         * @brief Waits at most timeout for the scan to finish, and returns true if it has.
+         */
+        bool WaitFor(std::chrono::milliseconds timeout) const;
+
+        /**
+         * @brief Waits for the scan to finish and returns its result.
+         *
+         * @throws std::runtime_error as PlanScan and RunScan do, e.g. if either side cannot be opened.
+         */
+        const ScanResult& Get() const;
+
+    private:
+        friend ScanHandle StartScan(const PairSpec& pair, const ScanRequest& request, ScanVisitor* visitor);
+
+        std::shared_ptr<ScanControl> fControl;
+        std::shared_future<ScanResult> fResult;
+    };
+
+    /**
+     * @brief Plans and runs the scan of a pair on a new thread, and returns at once.
+     *
+     * Several scans may run at the same time, each on its own thread; each scan gets files of its own from
+     * the FilePool. The native engine can be cancelled between any two ranges and reports its progress range
+     * by range. The RDataFrame engine (see RunFrameScan) only sees a cancellation before its event loops start,
+     * and reports no progress until it has finished.
+     *
+     * @param visitor Gets the batches and differences of the native engine, called from the scan's thread; it
+     *                must outlive the scan.
+     */
+    ScanHandle StartScan(const PairSpec& pair, const ScanRequest& request = ScanRequest(), ScanVisitor* visitor = nullptr);
+
+} // namespace Checker
+
+#endif // CHECKERASYNC_HXX
@@ -0,0 +1,198 @@
+/// \file CheckerBaseline.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerBaseline.hxx"
+
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace Checker {
+
+    namespace {
+        // Minimal reader for the baseline layout: objects, numbers and strings only
+        class BaselineParser {
+        public:
+            explicit BaselineParser(const std::string& text) : fText(text) {}
+
+            Baseline Parse() {
+                Baseline baseline;
+                Expect('{');
+                while (!Consume('}')) {
+                    const std::string key = ParseString();
+                    Expect(':');
+                    if (key == "benchmarks") {
+                        Expect('{');
+                        while (!Consume('}')) {
+                            const std::string name = ParseString();
+                            Expect(':');
+                            Expect('{');
+                            while (!Consume('}')) {
+                                const std::string metric = ParseString();
+                                Expect(':');
+                                baseline.fMetrics[name][metric] = ParseNumber();
+                                Consume(',');
+                            }
+                            Consume(',');
+                        }
+                    }
+                    else if (key == "entries") {
+                        baseline.fEntries = static_cast<long long>(ParseNumber());
+                    }
+                    else {
+                        SkipValue();
+                    }
+                    Consume(',');
+                }
+                return baseline;
+            }
+
+        private:
+            void SkipSpace() {
+                while (fPos < fText.size() && std::isspace(static_cast<unsigned char>(fText[fPos]))) ++fPos;
+            }
+            bool Consume(char c) {
+                SkipSpace();
+                if (fPos < fText.size() && fText[fPos] == c) {
+                    ++fPos;
+                    return true;
+                }
+                return false;
+            }
+            void Expect(char c) {
+                if (!Consume(c)) {
+                    throw std::runtime_error(std::string("Malformed baseline: expected '") + c + "' at offset " + std::to_string(fPos));
+                }
+            }
+            std::string ParseString() {
+                Expect('"');
+                const auto end = fText.find('"', fPos);
+                if (end == std::string::npos) throw std::runtime_error("Malformed baseline: unterminated string");
+                std::string value = fText.substr(fPos, end - fPos);
+                fPos = end + 1;
+                return value;
+            }
+            double ParseNumber() {
+                SkipSpace();
+                std::size_t length = 0;
+                double value = 0;
+                try {
+                    value = std::stod(fText.substr(fPos), &length);
+                }
+                catch (const std::exception&) {
+                    throw std::runtime_error("Malformed baseline: expected a number at offset " + std::to_string(fPos));
+                }
+                fPos += length;
+                return value;
+            }
+            void SkipValue() {
+                SkipSpace();
+                if (fPos < fText.size() && fText[fPos] == '"') ParseString();
+                else ParseNumber();
+            }
+
+            const std::string& fText;
+            std::size_t fPos = 0;
+        };
+    }
+
+    bool Baseline::IsRecorded() const {
+        for (const auto& benchmark : fMetrics) {
+            for (const auto& metric : benchmark.second) {
+                if (metric.second > 0) return true;
+            }
+        }
+        return false;
+    }
+
+    Baseline ParseBaseline(const std::string& text) {
+        return BaselineParser(text).Parse();
+    }
+
+    Baseline ReadBaseline(const std::string& fileName) {
+        std::ifstream file(fileName);
+        if (!file) {
+            throw std::runtime_error("Cannot open baseline file: " + fileName);
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return ParseBaseline(buffer.str());
+    }
+
+    void WriteBaseline(const std::string& fileName, long long entries, const std::vector<BenchMetrics>& results) {
+        std::ofstream file(fileName);
+        if (!file) {
+            throw std::runtime_error("Cannot write baseline file: " + fileName);
+        }
+        file << "{\n  \"entries\": " << entries << ",\n  \"benchmarks\": {\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            file << "    \"" << results[i].fName << "\": { \"throughput\": " << std::fixed << std::setprecision(1)
+                 << results[i].fThroughput << ", \"peak_rss_mb\": " << results[i].fPeakMB << " }"
+                 << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  }\n}\n";
+    }
+
+    BaselineStatus CheckBaseline(const Baseline& baseline, long long entries, const std::vector<BenchMetrics>& results,
+                                 double threshold, std::ostream& os) {
+        if (!baseline.IsRecorded()) {
+            os << "The baseline holds no recorded metrics" << std::endl;
+            return BaselineStatus::kNotRecorded;
+        }
+        if (baseline.fEntries != entries) {
+            os << "Baseline was recorded with " << baseline.fEntries << " entries, this run used " << entries << std::endl;
+            return BaselineStatus::kFailed;
+        }
+
+        bool passed = true;
+        for (const auto& r : results) {
+            const auto it = baseline.fMetrics.find(r.fName);
+            if (it == baseline.fMetrics.end()) {
+                os << r.fName << ": no baseline recorded  MISSING" << std::endl;
+                passed = false;
+                continue;
+            }
+            const auto metric = [&](const char* key) {
+                const auto m = it->second.find(key);
+                return m == it->second.end() ? 0.0 : m->second;
+            };
+
+            const double baseThroughput = metric("throughput");
+            if (baseThroughput > 0) {
+                const double ratio = r.fThroughput / baseThroughput;
+                const bool ok = ratio >= 1.0 - threshold;
+                passed = passed && ok;
+                os << r.fName << ": throughput " << std::fixed << std::setprecision(2) << ratio * 100 << "% of baseline"
+                   << (ok ? "" : "  REGRESSION") << std::endl;
+            }
+            const double basePeak = metric("peak_rss_mb");
+            if (basePeak > 0) {
+                const double ratio = r.fPeakMB / basePeak;
+                const bool ok = ratio <= 1.0 + threshold;
+                passed = passed && ok;
+                os << r.fName << ": peak memory " << std::fixed << std::setprecision(2) << ratio * 100 << "% of baseline"
+                   << (ok ? "" : "  REGRESSION") << std::endl;
+            }
+            if (baseThroughput <= 0 || basePeak <= 0) {
+                os << r.fName << ": baseline metric missing or 0  MISSING" << std::endl;
+                passed = false;
+            }
+        }
+        return passed ? BaselineStatus::kPassed : BaselineStatus::kFailed;
+    }
+
+} // namespace Checker
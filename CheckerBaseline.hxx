@@ -0,0 +1,86 @@
+/// \file CheckerBaseline.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERBASELINE_HXX
+#define CHECKERBASELINE_HXX
+
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Throughput and peak memory of one benchmark run by CheckerBench.
+     */
+    struct BenchMetrics {
+        std::string fName;
+        double fThroughput = 0; // Entries per second, or runs per second for benchmarks that do not process entries
+        double fPeakMB = 0;     // Peak resident set size while running, in MB
+    };
+
+    /**
+     * @brief Stored benchmark results the performance gate compares against.
+     *
+     * The file layout is {"entries": N, "benchmarks": {"<name>": {"throughput": X, "peak_rss_mb": Y}, ...}}.
+     * Other top-level keys (e.g. a note) are ignored.
+     */
+    struct Baseline {
+        long long fEntries = 0;
+        std::map<std::string, std::map<std::string, double>> fMetrics;
+
+        /**
+         * @brief True if at least one metric is set; a baseline of zeros has not been recorded yet.
+         */
+        bool IsRecorded() const;
+    };
+
+    enum class BaselineStatus {
+        kPassed,      // Every benchmark has a baseline and none regressed beyond the threshold
+        kFailed,      // A metric regressed, a benchmark has no baseline, or the entries differ
+        kNotRecorded  // The baseline holds no metrics, so there is nothing to gate against
+    };
+
+    /**
+     * @brief Parses the text of a baseline file.
+     *
+     * @throws std::runtime_error if the text does not follow the layout above.
+     */
+    Baseline ParseBaseline(const std::string& text);
+
+    /**
+     * @brief Reads a baseline file.
+     *
+     * @throws std::runtime_error if the file cannot be opened or parsed.
+     */
+    Baseline ReadBaseline(const std::string& fileName);
+
+    void WriteBaseline(const std::string& fileName, long long entries, const std::vector<BenchMetrics>& results);
+
+    /**
+     * @brief Compares benchmark results to a baseline recorded with the same number of entries.
+     *
+     * Throughput may drop and peak memory may grow by at most `threshold` (a fraction). Once the baseline is
+     * recorded, a benchmark missing from it or a metric recorded as 0 fails the check. One line per metric is
+     * written to `os`.
+     */
+    BaselineStatus CheckBaseline(const Baseline& baseline, long long entries, const std::vector<BenchMetrics>& results,
+                                 double threshold, std::ostream& os = std::cout);
+
+} // namespace Checker
+
+#endif // CHECKERBASELINE_HXX
@@ -0,0 +1,383 @@
+/// \file CheckerBatch.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerBatch.hxx"
+#include "Checker.hxx"
+#include "CheckerCLI.hxx"
+#include "CheckerFilePool.hxx"
+
+#include <TROOT.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <glob.h>
+
+namespace Checker {
+
+    namespace {
+
+        std::string ReplaceStars(std::string text, const std::string& stem) {
+            for (std::size_t pos = text.find('*'); pos != std::string::npos; pos = text.find('*', pos + stem.size())) {
+                text.replace(pos, 1, stem);
+            }
+            return text;
+        }
+
+        // Expands the `*` of the TTree file and substitutes the matched part into the other columns. A pattern that
+        // matches nothing is kept as it is, so that CheckPair reports it instead of the line vanishing from the batch
+        void ExpandPattern(const PairSpec& pattern, std::vector<PairSpec>& pairs) {
+            const std::string& path = pattern.fTTreeFile;
+            const std::size_t star = path.find('*');
+            if (star == std::string::npos) {
+                pairs.push_back(pattern);
+                return;
+            }
+            if (path.find('*', star + 1) != std::string::npos) {
+                throw std::runtime_error("Only one '*' is allowed in a TTree file pattern: " + path);
+            }
+
+            glob_t matches;
+            const std::size_t before = pairs.size();
+            if (glob(path.c_str(), 0, nullptr, &matches) == 0) {
+                const std::size_t suffix = path.size() - star - 1;
+                for (std::size_t i = 0; i < matches.gl_pathc; ++i) {
+                    const std::string match = matches.gl_pathv[i];
+                    const std::string stem = match.substr(star, match.size() - star - suffix);
+                    pairs.push_back({ match, ReplaceStars(pattern.fRNTupleFile, stem),
+                                      ReplaceStars(pattern.fTTreeName, stem), ReplaceStars(pattern.fRNTupleName, stem) });
+                }
+            }
+            globfree(&matches);
+            if (pairs.size() == before) {
+                pairs.push_back(pattern);
+            }
+        }
+
+        // Names of the top-level keys of the file whose class is accepted, in key order and without repeated cycles
+        template <typename Accept>
+        std::vector<std::string> ListKeys(const std::string& path, Accept&& accept) {
+            auto file = FilePool::Instance().GetFile(path);
+            if (!file) {
+                throw std::runtime_error("Cannot open file: " + path);
+            }
+
+            std::vector<std::string> names;
+            std::set<std::string> seen;
+            auto keys = file->GetListOfKeys();
+            for (int i = 0; i < keys->GetEntries(); ++i) {
+                auto key = dynamic_cast<TKey*>(keys->At(i));
+                if (key && accept(std::string(key->GetClassName())) && seen.insert(key->GetName()).second) {
+                    names.push_back(key->GetName());
+                }
+            }
+            return names;
+        }
+
+        std::string PairKey(const PairSpec& pair) {
+            return "pair\t" + pair.fTTreeFile + "\t" + pair.fRNTupleFile + "\t" + pair.fTTreeName + "\t" + pair.fRNTupleName;
+        }
+
+        // Fields of a recorded result: passed, seconds, error, then "I" or "W" followed by an issue or warning
+        std::vector<std::string> SaveResult(const PairResult& result) {
+            std::vector<std::string> fields{ result.fPassed ? "1" : "0", std::to_string(result.fSeconds), result.fError };
+            for (const auto& issue : result.fIssues) fields.push_back("I" + issue);
+            for (const auto& warning : result.fWarnings) fields.push_back("W" + warning);
+            return fields;
+        }
+
+        // Expects at least the first three fields
+        PairResult RestoreResult(const PairSpec& pair, const std::vector<std::string>& fields) {
+            PairResult result;
+            result.fPair = pair;
+            result.fPassed = fields[0] == "1";
+            result.fSeconds = std::atof(fields[1].c_str());
+            result.fError = fields[2];
+            for (std::size_t i = 3; i < fields.size(); ++i) {
+                auto& messages = fields[i].compare(0, 1, "I") == 0 ? result.fIssues : result.fWarnings;
+                messages.push_back(fields[i].substr(1));
+            }
+            return result;
+        }
+
+        template <typename T>
+        void CompareValues(const std::vector<T>& ttreeValues, const std::vector<T>& rntupleValues, const std::string& type, PairResult& result) {
+            if (ttreeValues.size() != rntupleValues.size()) {
+                result.fIssues.push_back("Number of " + type + " values differs: " + std::to_string(ttreeValues.size())
+                                         + " (TTree) vs " + std::to_string(rntupleValues.size()) + " (RNTuple)");
+                return;
+            }
+            auto mismatch = std::mismatch(ttreeValues.begin(), ttreeValues.end(), rntupleValues.begin());
+            if (mismatch.first != ttreeValues.end()) {
+                result.fIssues.push_back("First differing " + type + " value at index "
+                                         + std::to_string(mismatch.first - ttreeValues.begin()));
+            }
+        }
+
+    } // namespace
+
+    std::vector<PairSpec> ReadManifest(const std::string& manifestFile) {
+        std::ifstream manifest(manifestFile);
+        if (!manifest) {
+            throw std::runtime_error("Cannot open manifest: " + manifestFile);
+        }
+
+        std::vector<PairSpec> pairs;
+        std::string line;
+        for (int lineNo = 1; std::getline(manifest, line); ++lineNo) {
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream columns(line);
+            std::vector<std::string> fields;
+            for (std::string field; columns >> field;) {
+                fields.push_back(field);
+            }
+            if (fields.empty()) {
+                continue;
+            }
+            if (fields.size() != 4) {
+                throw std::runtime_error("Malformed manifest line " + std::to_string(lineNo) + " in " + manifestFile
+                                         + ": expected <ttreeFile> <rntupleFile> <ttreeName> <rntupleName>");
+            }
+            ExpandPattern({ fields[0], fields[1], fields[2], fields[3] }, pairs);
+        }
+        return pairs;
+    }
+
+    std::vector<std::string> ListTTrees(const std::string& ttreeFile) {
+        return ListKeys(ttreeFile, [](const std::string& className) {
+            return className == "TTree" || className == "TNtuple" || className == "TNtupleD";
+        });
+    }
+
+    std::vector<std::string> ListRNTuples(const std::string& rntupleFile) {
+        return ListKeys(rntupleFile, [](const std::string& className) {
+            return className == "ROOT::Experimental::RNTuple";
+        });
+    }
+
+    AutoPairing PairByName(const std::string& ttreeFile, const std::string& rntupleFile, const std::string& rule) {
+        std::string from;
+        std::string to;
+        if (!rule.empty()) {
+            const std::size_t colon = rule.find(':');
+            if (colon == std::string::npos) {
+                throw std::runtime_error("Pairing rule must have the form <from>:<to>: " + rule);
+            }
+            from = rule.substr(0, colon);
+            to = rule.substr(colon + 1);
+        }
+
+        const auto rntupleNames = ListRNTuples(rntupleFile);
+        std::set<std::string> unpaired(rntupleNames.begin(), rntupleNames.end());
+
+        AutoPairing pairing;
+        for (const auto& ttreeName : ListTTrees(ttreeFile)) {
+            std::vector<std::string> candidates;
+            const std::size_t pos = from.empty() ? std::string::npos : ttreeName.find(from);
+            if (pos != std::string::npos) {
+                candidates.push_back(std::string(ttreeName).replace(pos, from.size(), to));
+            }
+            candidates.push_back(ttreeName);
+
+            auto match = std::find_if(candidates.begin(), candidates.end(),
+                                      [&](const std::string& name) { return unpaired.count(name) > 0; });
+            if (match == candidates.end()) {
+                pairing.fUnpairedTTrees.push_back(ttreeName);
+                continue;
+            }
+            pairing.fPairs.push_back({ ttreeFile, rntupleFile, ttreeName, *match });
+            unpaired.erase(*match);
+        }
+
+        // Keep the key order of the file for the RNTuples left over
+        for (const auto& rntupleName : rntupleNames) {
+            if (unpaired.count(rntupleName)) {
+                pairing.fUnpairedRNTuples.push_back(rntupleName);
+            }
+        }
+        return pairing;
+    }
+
+    std::vector<PairResult> ReportUnpaired(const AutoPairing& pairing, const std::string& ttreeFile, const std::string& rntupleFile) {
+        std::vector<PairResult> results;
+        for (const auto& ttreeName : pairing.fUnpairedTTrees) {
+            PairResult result;
+            result.fPair = { ttreeFile, rntupleFile, ttreeName, "" };
+            result.fError = "No RNTuple found for TTree: " + ttreeName;
+            results.push_back(result);
+        }
+        for (const auto& rntupleName : pairing.fUnpairedRNTuples) {
+            PairResult result;
+            result.fPair = { ttreeFile, rntupleFile, "", rntupleName };
+            result.fError = "No TTree found for RNTuple: " + rntupleName;
+            results.push_back(result);
+        }
+        return results;
+    }
+
+    std::vector<std::pair<std::string, std::string>> CheckStructure(Checker& checker, PairResult& result) {
+        std::vector<std::pair<std::string, std::string>> columns;
+
+        const auto entries = checker.CountEntries();
+        if (entries.first != entries.second) {
+            result.fIssues.push_back("Entry count differs: " + std::to_string(entries.first) + " (TTree) vs "
+                                     + std::to_string(entries.second) + " (RNTuple)");
+        }
+
+        const auto fields = checker.CountFields();
+        if (fields.first != fields.second) {
+            result.fIssues.push_back("Field count differs: " + std::to_string(fields.first) + " (TTree) vs "
+                                     + std::to_string(fields.second) + " (RNTuple)");
+        }
+
+        for (const auto& names : checker.CompareFieldNames()) {
+            if (names.second == "No match") {
+                result.fIssues.push_back("Field only in TTree: " + names.first);
+            }
+            else if (names.first == "No match") {
+                result.fIssues.push_back("Field only in RNTuple: " + names.second);
+            }
+        }
+
+        for (const auto& types : checker.CompareFieldTypes()) {
+            const std::string& name = std::get<0>(types);
+            const std::string& ttreeType = std::get<1>(types);
+            const std::string& rntupleType = std::get<2>(types);
+            if (ttreeType == "No match" || rntupleType == "No match") {
+                continue; // Already reported with the field names
+            }
+            switch (MatchFieldTypes(ttreeType, rntupleType)) {
+            case FieldTypeMatch::kExact:
+                columns.emplace_back(name, MapFieldType(ttreeType));
+                break;
+            case FieldTypeMatch::kNear:
+                result.fWarnings.push_back("No exact type match for " + name + ": " + ttreeType + " vs " + rntupleType);
+                break;
+            case FieldTypeMatch::kMismatch:
+                result.fIssues.push_back("Type mismatch for " + name + ": " + ttreeType + " vs " + rntupleType);
+                break;
+            case FieldTypeMatch::kMissing:
+                result.fWarnings.push_back("Type not checked for " + name + ": " + ttreeType + " vs " + rntupleType);
+                break;
+            }
+        }
+        return columns;
+    }
+
+    PairResult CheckPair(const PairSpec& pair, bool checkValues) {
+        PairResult result;
+        result.fPair = pair;
+        const auto start = std::chrono::steady_clock::now();
+
+        try {
+            if (pair.fTTreeFile.find('*') != std::string::npos) {
+                // Left unexpanded by ReadManifest
+                throw std::runtime_error("No file matches the pattern: " + pair.fTTreeFile);
+            }
+            Checker checker(pair.fTTreeFile, pair.fRNTupleFile, pair.fTTreeName, pair.fRNTupleName);
+
+            CheckStructure(checker, result);
+
+            // Values are only compared once the structure matches, otherwise the columns do not line up
+            if (checkValues && result.fIssues.empty()) {
+                CompareValues(checker.ReadIntFromTTree(), checker.ReadIntFromRNTuple(), "int", result);
+                CompareValues(checker.ReadFloatFromTTree(), checker.ReadFloatFromRNTuple(), "float", result);
+                CompareValues(checker.ReadDoubleFromTTree(), checker.ReadDoubleFromRNTuple(), "double", result);
+                CompareValues(checker.ReadBoolFromTTree(), checker.ReadBoolFromRNTuple(), "bool", result);
+            }
+        }
+        catch (const std::exception& e) {
+            result.fError = e.what();
+        }
+
+        result.fPassed = result.fError.empty() && result.fIssues.empty();
+        result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    std::vector<PairResult> RunBatch(const std::vector<PairSpec>& pairs, unsigned nThreads, bool checkValues, Checkpoint* checkpoint) {
+        std::vector<PairResult> results(pairs.size());
+        if (pairs.empty()) {
+            return results;
+        }
+        if (nThreads == 0) {
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        nThreads = std::min<unsigned>(nThreads, pairs.size());
+
+        // Order the pairs by file, then cut the order into groups of pairs sharing a file
+        std::vector<std::size_t> order(pairs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return std::tie(pairs[a].fTTreeFile, pairs[a].fRNTupleFile) < std::tie(pairs[b].fTTreeFile, pairs[b].fRNTupleFile);
+        });
+
+        // Groups larger than an even share per thread are split, so that a single big file still uses all threads
+        const std::size_t maxGroup = (pairs.size() + nThreads - 1) / nThreads;
+        std::vector<std::pair<std::size_t, std::size_t>> groups; // [begin, end) in order
+        for (std::size_t begin = 0; begin < order.size();) {
+            std::size_t end = begin + 1;
+            while (end < order.size() && end - begin < maxGroup
+                   && pairs[order[end]].fTTreeFile == pairs[order[begin]].fTTreeFile
+                   && pairs[order[end]].fRNTupleFile == pairs[order[begin]].fRNTupleFile) {
+                ++end;
+            }
+            groups.emplace_back(begin, end);
+            begin = end;
+        }
+
+        if (nThreads > 1) {
+            ROOT::EnableThreadSafety();
+        }
+
+        std::atomic<std::size_t> nextGroup{ 0 };
+        auto worker = [&]() {
+            for (std::size_t g = nextGroup++; g < groups.size(); g = nextGroup++) {
+                for (std::size_t i = groups[g].first; i < groups[g].second; ++i) {
+                    const PairSpec& pair = pairs[order[i]];
+                    std::vector<std::string> fields;
+                    if (checkpoint && checkpoint->Find(PairKey(pair), fields) && fields.size() >= 3) {
+                        results[order[i]] = RestoreResult(pair, fields);
+                        continue;
+                    }
+                    results[order[i]] = CheckPair(pair, checkValues);
+                    if (checkpoint && results[order[i]].fError.empty()) {
+                        checkpoint->Record(PairKey(pair), SaveResult(results[order[i]])); // Errors are retried on resume
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < nThreads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker(); // The calling thread works as well
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        return results;
+    }
+
+} // namespace Checker
@@ -0,0 +1,137 @@
+/// \file CheckerBatch.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERBATCH_HXX
+#define CHECKERBATCH_HXX
+
+#include "CheckerCheckpoint.hxx"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief One TTree/RNTuple pair to be verified.
+     */
+    struct PairSpec {
+        std::string fTTreeFile;
+        std::string fRNTupleFile;
+        std::string fTTreeName;
+        std::string fRNTupleName;
+    };
+
+    /**
+     * @brief Outcome of verifying one pair.
+     */
+    struct PairResult {
+        PairSpec fPair;
+        bool fPassed = false;
+        std::vector<std::string> fIssues;   // Differences that fail the pair
+        std::vector<std::string> fWarnings; // Near matches, e.g. float against double
+        std::string fError;                 // Set if the pair could not be checked at all
+        double fSeconds = 0;
+    };
+
+    /**
+     * @brief Reads the pairs to verify from a manifest file.
+     *
+     * Each line holds one pair as `<ttreeFile> <rntupleFile> <ttreeName> <rntupleName>`, separated by whitespace.
+     * Empty lines and everything after a `#` are ignored.
+     *
+     * The TTree file may contain one `*`, which is expanded with glob(3). For every matching file the part matched
+     * by the `*` is substituted for each `*` in the other three columns, so
+     * `data/run_*.root data/run_*_rntuple.root events events` pairs every run with its converted file.
+     * A pattern that matches no file is returned unexpanded, and CheckPair reports it as an error, as it does
+     * for a file that does not exist.
+     *
+     * @throws std::runtime_error if the manifest cannot be read or a line is malformed.
+     */
+    std::vector<PairSpec> ReadManifest(const std::string& manifestFile);
+
+    /**
+     * @brief Result of pairing all TTrees of one file with all RNTuples of another.
+     */
+    struct AutoPairing {
+        std::vector<PairSpec> fPairs;
+        std::vector<std::string> fUnpairedTTrees;
+        std::vector<std::string> fUnpairedRNTuples;
+    };
+
+    /**
+     * @brief Returns the names of all TTrees stored at the top level of a file, once each, in key order.
+     *
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    std::vector<std::string> ListTTrees(const std::string& ttreeFile);
+
+    /**
+     * @brief Returns the names of all RNTuples stored at the top level of a file, once each, in key order.
+     *
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    std::vector<std::string> ListRNTuples(const std::string& rntupleFile);
+
+    /**
+     * @brief Pairs every TTree of one file with an RNTuple of another.
+     *
+     * A TTree is paired with the RNTuple of the same name. A rule `<from>:<to>` is tried first: it replaces the
+     * first `<from>` in the TTree name by `<to>`, so "tree_:rntuple_" pairs tree_3 with rntuple_3.
+     *
+     * @throws std::runtime_error if a file cannot be opened or the rule has no ':'.
+     */
+    AutoPairing PairByName(const std::string& ttreeFile, const std::string& rntupleFile, const std::string& rule = "");
+
+    /**
+     * @brief Returns a failed result for every TTree and RNTuple of a pairing that was left without a partner.
+     */
+    std::vector<PairResult> ReportUnpaired(const AutoPairing& pairing, const std::string& ttreeFile, const std::string& rntupleFile);
+
+    class Checker;
+
+    /**
+     * @brief Compares entry counts, field counts, field names and field types of a pair, from metadata only,
+     *        and adds the differences to the issues and warnings of result.
+     *
+     * @return Name and common type (see MapFieldType) of every field whose type matches exactly on both sides.
+     */
+    std::vector<std::pair<std::string, std::string>> CheckStructure(Checker& checker, PairResult& result);
+
+    /**
+     * @brief Verifies one pair without printing anything.
+     *
+     * Compares entry counts, field counts, field names and field types and, if checkValues is set and the
+     * structure matches, the scalar int, float, double and bool values entry by entry.
+     */
+    PairResult CheckPair(const PairSpec& pair, bool checkValues = true);
+
+    /**
+     * @brief Verifies all pairs on a pool of worker threads.
+     *
+     * Pairs are grouped by file and each worker takes whole groups, so pairs from the same file reuse the file
+     * handles and RNTuple descriptors of the FilePool. Large groups are split when there are fewer groups than
+     * threads.
+     *
+     * @param nThreads Number of worker threads; 0 uses one per hardware thread.
+     * @param checkpoint If set, pairs recorded in it are not checked again and every checked pair is recorded.
+     * @return One result per pair, in the order of the input.
+     */
+    std::vector<PairResult> RunBatch(const std::vector<PairSpec>& pairs, unsigned nThreads = 0, bool checkValues = true,
+                                     Checkpoint* checkpoint = nullptr);
+
+} // namespace Checker
+
+#endif // CHECKERBATCH_HXX
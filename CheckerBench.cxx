@@ -0,0 +1,393 @@
+/// \file CheckerBench.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "Checker.hxx"
+#include "CheckerBaseline.hxx"
+#include "CheckerCLI.hxx"
+#include "CheckerGenerator.hxx"
+#include "CheckerMemory.hxx"
+
+#include <TFile.h>
+#include <TError.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Checker;
+
+namespace {
+    // Exit code of a baseline check without a recorded baseline; ctest reports the CheckerPerfGate test as skipped
+    constexpr int kSkipped = 77;
+
+    struct BenchResult {
+        std::string fName;
+        double fMinSeconds = 0;
+        double fMeanSeconds = 0;
+        long long fEntries = 0;   // Entries processed by one run
+        long long fBytes = 0;     // Bytes on disk touched by one run
+        double fPeakMB = 0;       // Peak resident set size while running, in MB
+
+        // Entries per second of the fastest run, or runs per second for benchmarks that do not process entries
+        double Throughput() const {
+            if (fMinSeconds <= 0) return 0;
+            return (fEntries > 0 ? fEntries : 1) / fMinSeconds;
+        }
+    };
+
+    // Runs fn `repetitions` times and keeps the fastest and the mean wall-clock time
+    BenchResult Measure(const std::string& name, int repetitions, long long entries, long long bytes, const std::function<void()>& fn) {
+        BenchResult result{ name, 0, 0, entries, bytes };
+        ResetPeakRSS();
+        double total = 0;
+        for (int r = 0; r < repetitions; ++r) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+            result.fMinSeconds = (r == 0) ? diff.count() : std::min(result.fMinSeconds, diff.count());
+            total += diff.count();
+        }
+        result.fMeanSeconds = total / repetitions;
+        result.fPeakMB = PeakRSSMB();
+        return result;
+    }
+
+    long long FileSize(const std::string& fileName) {
+        std::unique_ptr<TFile> file(TFile::Open(fileName.c_str()));
+        return (file && !file->IsZombie()) ? file->GetSize() : 0;
+    }
+
+    void PrintResults(const std::vector<BenchResult>& results) {
+        std::cout << std::left << std::setw(32) << "Benchmark"
+                  << std::right << std::setw(12) << "Min [ms]"
+                  << std::setw(12) << "Mean [ms]"
+                  << std::setw(16) << "Entries/s"
+                  << std::setw(12) << "MB/s"
+                  << std::setw(12) << "Peak [MB]" << std::endl;
+        std::cout << std::string(96, '-') << std::endl;
+
+        for (const auto& r : results) {
+            const double rate = r.fMinSeconds > 0 ? r.fEntries / r.fMinSeconds : 0;
+            const double mbps = r.fMinSeconds > 0 ? r.fBytes / r.fMinSeconds / 1e6 : 0;
+            std::cout << std::left << std::setw(32) << r.fName
+                      << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << r.fMinSeconds * 1e3
+                      << std::setw(12) << r.fMeanSeconds * 1e3
+                      << std::setw(16) << std::setprecision(0) << rate
+                      << std::setw(12) << std::setprecision(1) << mbps
+                      << std::setw(12) << r.fPeakMB << std::endl;
+        }
+    }
+
+    std::vector<BenchMetrics> Metrics(const std::vector<BenchResult>& results) {
+        std::vector<BenchMetrics> metrics;
+        for (const auto& r : results) {
+            metrics.push_back({ r.fName, r.Throughput(), r.fPeakMB });
+        }
+        return metrics;
+    }
+
+    // The whole CLI comparison; its console output is discarded so only the work is timed
+    void RunCompare(const CheckerConfig& cliConfig) {
+        CheckerCLI cli;
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        cli.Compare(cliConfig);
+        std::cout.rdbuf(coutBuffer);
+        std::cout.clear();
+    }
+
+    std::vector<long long> ParseList(const std::string& spec) {
+        std::vector<long long> values;
+        std::stringstream stream(spec);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            values.push_back(std::stoll(item));
+            if (values.back() <= 0) {
+                throw std::invalid_argument("expected positive numbers");
+            }
+        }
+        return values;
+    }
+
+    /**
+     * Runs Compare with the RDataFrame engine, the path that uses the thread count (CheckerConfig::fThreads), for
+     * every dataset size at every thread count. Speedup, efficiency and throughput are relative to a measured
+     * single-threaded run of the same size, which is added to the thread counts if they do not include 1.
+     */
+    void RunScaling(const GeneratorConfig& scalarConfig, const std::vector<long long>& sizes, const std::vector<long long>& threads,
+        int repetitions, const std::string& csvFile) {
+        std::ofstream csv;
+        if (!csvFile.empty()) {
+            csv.open(csvFile);
+            csv << "entries,threads,seconds,speedup,efficiency,entries_per_s,mb_per_s\n";
+        }
+
+        for (long long entries : sizes) {
+            GeneratorConfig config = scalarConfig;
+            config.fEntries = entries;
+            GenerateTTree(config, "bench_ttree.root", "bench");
+            GenerateRNTuple(config, "bench_rntuple.root", "bench");
+            const long long bytes = FileSize("bench_ttree.root") + FileSize("bench_rntuple.root");
+            CheckerConfig cliConfig;
+            cliConfig.fTTreeFile = "bench_ttree.root";
+            cliConfig.fRNTupleFile = "bench_rntuple.root";
+            cliConfig.fTTreeName = "bench";
+            cliConfig.fRNTupleName = "bench";
+            cliConfig.fShouldRun = true;
+            cliConfig.fEngine = "dataframe";
+
+            std::cout << "\nScaling for " << entries << " entries (" << std::fixed << std::setprecision(1) << bytes / 1e6 << " MB)" << std::endl;
+            std::cout << std::right << std::setw(8) << "Threads"
+                      << std::setw(12) << "Time [ms]"
+                      << std::setw(10) << "Speedup"
+                      << std::setw(12) << "Efficiency"
+                      << std::setw(16) << "Entries/s"
+                      << std::setw(12) << "MB/s" << std::endl;
+            std::cout << std::string(70, '-') << std::endl;
+
+            std::vector<long long> counts = threads;
+            counts.push_back(1);
+            std::sort(counts.begin(), counts.end());
+            counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+
+            double single = 0; // t(1), measured first
+            for (long long nThreads : counts) {
+                cliConfig.fThreads = static_cast<unsigned>(nThreads);
+                const BenchResult result = Measure("Compare", repetitions, entries, bytes, [&] { RunCompare(cliConfig); });
+                if (nThreads == 1) {
+                    single = result.fMinSeconds;
+                }
+                const double speedup = single / result.fMinSeconds;
+                const double efficiency = speedup / nThreads;
+                const double rate = entries / result.fMinSeconds;
+                const double mbps = bytes / result.fMinSeconds / 1e6;
+
+                std::cout << std::setw(8) << nThreads
+                          << std::fixed << std::setprecision(2) << std::setw(12) << result.fMinSeconds * 1e3
+                          << std::setw(10) << speedup
+                          << std::setw(11) << std::setprecision(1) << efficiency * 100 << "%"
+                          << std::setw(16) << std::setprecision(0) << rate
+                          << std::setw(12) << std::setprecision(1) << mbps << std::endl;
+                if (csv.is_open()) {
+                    csv << entries << "," << nThreads << "," << result.fMinSeconds << "," << speedup << ","
+                        << efficiency << "," << rate << "," << mbps << "\n";
+                }
+            }
+        }
+    }
+
+    void PrintUsage(const char* argv0) {
+        std::cerr << "Usage: " << argv0 << " [-n <entries>] [-c <columns>] [--types <i,f,d,b,vi,vf,vd,vb>]"
+                  << " [--vector-length <n>] [--compression <settings>] [--cluster-size <bytes>]"
+                  << " [--repetitions <n>] [--seed <n>] [--keep]\n"
+                  << "       " << argv0 << " [--baseline <file.json>] [--threshold <fraction>] [--write-baseline <file.json>]\n"
+                  << "       " << argv0 << " --scaling [--threads <1,2,4,...>] [--sizes <n1,n2,...>] [--csv <file>] [generator options]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    gErrorIgnoreLevel = kError;
+
+    GeneratorConfig genConfig;
+    genConfig.fEntries = 1000000;
+    genConfig.fColumns = 8;
+    genConfig.fTypes = ParseColumnTypes("i,f,d,b,vi,vf,vd,vb");
+    int repetitions = 3;
+    bool keep = false;
+    bool scaling = false;
+    std::vector<long long> threads;
+    std::vector<long long> sizes;
+    std::string csvFile;
+    std::string baselineFile;
+    std::string writeBaselineFile;
+    double threshold = 0.25;
+
+    // Loop through the command-line arguments to parse options and their values
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--keep") {
+            keep = true;
+            continue;
+        }
+        if (arg == "--scaling") {
+            scaling = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "-n" || arg == "--entries") genConfig.fEntries = std::stoll(value);
+            else if (arg == "-c" || arg == "--columns") genConfig.fColumns = std::stoi(value);
+            else if (arg == "--types") genConfig.fTypes = ParseColumnTypes(value);
+            else if (arg == "--vector-length") genConfig.fVectorLength = std::stoul(value);
+            else if (arg == "--compression") genConfig.fCompression = std::stoi(value);
+            else if (arg == "--cluster-size") genConfig.fClusterSize = std::stoul(value);
+            else if (arg == "--repetitions") repetitions = std::max(1, std::stoi(value));
+            else if (arg == "--seed") genConfig.fSeed = std::stoull(value);
+            else if (arg == "--threads") threads = ParseList(value);
+            else if (arg == "--sizes") sizes = ParseList(value);
+            else if (arg == "--csv") csvFile = value;
+            else if (arg == "--baseline") baselineFile = value;
+            else if (arg == "--write-baseline") writeBaselineFile = value;
+            else if (arg == "--threshold") threshold = std::stod(value);
+            else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Invalid value for " << arg << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Scalar and vector columns go into separate pairs, just like tree_N and tree_vec_N in testfiles/:
+    // the scalar Read* functions select RNTuple fields by type name and would also pick up vector fields.
+    GeneratorConfig scalarConfig = genConfig;
+    GeneratorConfig vectorConfig = genConfig;
+    scalarConfig.fTypes.clear();
+    vectorConfig.fTypes.clear();
+    for (auto type : genConfig.fTypes) {
+        if (type <= GenColumnType::kBool) scalarConfig.fTypes.push_back(type);
+        else if (type <= GenColumnType::kBoolVector) vectorConfig.fTypes.push_back(type);
+        else std::cerr << "Ignoring column type the Checker cannot read" << std::endl;
+    }
+
+    if (scaling) {
+        // Default: 1, 2, 4, ... up to the number of cores, at a tenth of and at the full dataset size
+        if (threads.empty()) {
+            const long long cores = std::max(1u, std::thread::hardware_concurrency());
+            for (long long n = 1; n < cores; n *= 2) threads.push_back(n);
+            threads.push_back(cores);
+        }
+        if (sizes.empty()) {
+            sizes = { std::max(1LL, genConfig.fEntries / 10), genConfig.fEntries };
+        }
+        if (scalarConfig.fTypes.empty()) {
+            std::cerr << "The scaling benchmark needs at least one scalar column type" << std::endl;
+            return 1;
+        }
+        RunScaling(scalarConfig, sizes, threads, repetitions, csvFile);
+        if (!keep) {
+            std::remove("bench_ttree.root");
+            std::remove("bench_rntuple.root");
+        }
+        return 0;
+    }
+
+    const std::string scalarTTreeFile = "bench_ttree.root";
+    const std::string scalarRNTupleFile = "bench_rntuple.root";
+    const std::string vectorTTreeFile = "bench_ttree_vec.root";
+    const std::string vectorRNTupleFile = "bench_rntuple_vec.root";
+
+    std::cout << "Generating " << genConfig.fEntries << " entries x " << genConfig.fColumns << " columns"
+              << " (compression " << genConfig.fCompression << ", cluster size " << genConfig.fClusterSize << " B)" << std::endl;
+
+    std::vector<BenchResult> results;
+
+    if (!scalarConfig.fTypes.empty()) {
+        GenerateTTree(scalarConfig, scalarTTreeFile, "bench");
+        GenerateRNTuple(scalarConfig, scalarRNTupleFile, "bench");
+        const long long ttreeBytes = FileSize(scalarTTreeFile);
+        const long long rntupleBytes = FileSize(scalarRNTupleFile);
+
+        Checker::Checker checker(scalarTTreeFile, scalarRNTupleFile, "bench", "bench");
+
+        results.push_back(Measure("ReadIntFromTTree", repetitions, genConfig.fEntries, ttreeBytes,
+            [&] { checker.ReadIntFromTTree(); }));
+        results.push_back(Measure("ReadIntFromRNTuple", repetitions, genConfig.fEntries, rntupleBytes,
+            [&] { checker.ReadIntFromRNTuple(); }));
+        results.push_back(Measure("CompareFieldTypes", repetitions, 0, 0,
+            [&] { checker.CompareFieldTypes(); }));
+
+        CheckerConfig cliConfig;
+        cliConfig.fTTreeFile = scalarTTreeFile;
+        cliConfig.fRNTupleFile = scalarRNTupleFile;
+        cliConfig.fTTreeName = "bench";
+        cliConfig.fRNTupleName = "bench";
+        cliConfig.fShouldRun = true;
+        results.push_back(Measure("Compare", repetitions, genConfig.fEntries, ttreeBytes + rntupleBytes,
+            [&] { RunCompare(cliConfig); }));
+    }
+
+    if (!vectorConfig.fTypes.empty()) {
+        GenerateTTree(vectorConfig, vectorTTreeFile, "bench_vec");
+        GenerateRNTuple(vectorConfig, vectorRNTupleFile, "bench_vec");
+        const long long rntupleBytes = FileSize(vectorRNTupleFile);
+
+        Checker::Checker checker(vectorTTreeFile, vectorRNTupleFile, "bench_vec", "bench_vec");
+
+        // Count the elements of the first vector column
+        const std::string fieldName = GenColumnName(vectorConfig, 0);
+        static const char* subTypes[] = { "int", "float", "double", "bool" };
+        const std::string subType = subTypes[static_cast<int>(vectorConfig.fTypes[0]) - static_cast<int>(GenColumnType::kIntVector)];
+        results.push_back(Measure("CountSubFieldsInRNTuple", repetitions, genConfig.fEntries, rntupleBytes,
+            [&] { checker.CountSubFieldsInRNTuple(fieldName, subType); }));
+    }
+
+    std::cout << std::endl;
+    PrintResults(results);
+
+    if (!keep) {
+        for (const auto& file : { scalarTTreeFile, scalarRNTupleFile, vectorTTreeFile, vectorRNTupleFile }) {
+            std::remove(file.c_str());
+        }
+    }
+
+    if (!writeBaselineFile.empty()) {
+        try {
+            WriteBaseline(writeBaselineFile, genConfig.fEntries, Metrics(results));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "\nBaseline written to " << writeBaselineFile << std::endl;
+    }
+
+    if (!baselineFile.empty()) {
+        try {
+            std::cout << std::endl;
+            const BaselineStatus status = CheckBaseline(ReadBaseline(baselineFile), genConfig.fEntries, Metrics(results), threshold);
+            if (status == BaselineStatus::kNotRecorded) {
+                std::cerr << "\nNo baseline recorded in " << baselineFile << ", skipping the regression check" << std::endl;
+                return kSkipped;
+            }
+            if (status == BaselineStatus::kFailed) {
+                std::cerr << "\nPerformance regression beyond " << threshold * 100 << "% against " << baselineFile << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "\nNo performance regression against " << baselineFile << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/// \file CheckerBuffers.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERBUFFERS_HXX
+#define CHECKERBUFFERS_HXX
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Checker {
+
+    /// Number of entries the Checker reads from a column before handing them on as one batch
+    constexpr std::size_t kBatchEntries = 4096;
+
+    /**
+     * @brief Per-thread free list of std::vector<T> buffers.
+     *
+     * Buffers keep their capacity when they are released, so a column read batch by batch allocates its
+     * buffers once per thread instead of once per column and batch. At most kMaxFree buffers of at most
+     * kMaxBytes each are kept; larger or surplus buffers are freed on release.
+     */
+    template <typename T>
+    class BufferPool {
+    public:
+        static constexpr std::size_t kMaxFree = 8;
+        static constexpr std::size_t kMaxBytes = 64 * 1024 * 1024;
+
+        /**
+         * @brief Returns the pool of the calling thread.
+         */
+        static BufferPool& ForThread() {
+            thread_local BufferPool pool;
+            return pool;
+        }
+
+        /**
+         * @brief Returns an empty buffer with at least the given capacity, recycled if possible.
+         */
+        std::vector<T> Acquire(std::size_t capacity) {
+            std::vector<T> buffer;
+            if (!fFree.empty()) {
+                buffer = std::move(fFree.back());
+                fFree.pop_back();
+            }
+            buffer.clear();
+            buffer.reserve(capacity);
+            return buffer;
+        }
+
+        /**
+         * @brief Hands a buffer back to the pool for reuse.
+         */
+        void Release(std::vector<T>&& buffer) {
+            if (fFree.size() < kMaxFree && buffer.capacity() * sizeof(T) <= kMaxBytes) {
+                fFree.push_back(std::move(buffer));
+            }
+        }
+
+        /// Number of buffers waiting for reuse
+        std::size_t GetNFree() const { return fFree.size(); }
+
+    private:
+        std::vector<std::vector<T>> fFree;
+    };
+
+    /**
+     * @brief A buffer borrowed from the pool of the calling thread for the lifetime of the object.
+     *
+     * Must be destroyed on the thread that created it.
+     */
+    template <typename T>
+    class PooledBuffer {
+    public:
+        explicit PooledBuffer(std::size_t capacity = kBatchEntries)
+            : fBuffer(BufferPool<T>::ForThread().Acquire(capacity)) {}
+        ~PooledBuffer() { BufferPool<T>::ForThread().Release(std::move(fBuffer)); }
+
+        PooledBuffer(const PooledBuffer&) = delete;
+        PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+        std::vector<T>& operator*() { return fBuffer; }
+        std::vector<T>* operator->() { return &fBuffer; }
+        std::vector<T>* Get() { return &fBuffer; }
+
+    private:
+        std::vector<T> fBuffer;
+    };
+
+} // namespace Checker
+
+#endif // CHECKERBUFFERS_HXX
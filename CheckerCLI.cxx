@@ -15,11 +15,19 @@
 
 #include "CheckerCLI.hxx"
 #include "Checker.hxx"
+#include "CheckerDaemon.hxx"
+#include "CheckerFrame.hxx"
+#include "CheckerWatch.hxx"
+#include "CheckerMemory.hxx"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <sstream>
 #include <TKey.h>
 #include <string>
+#include <unordered_map>
 #include <TH1.h>
 #include <TCanvas.h>
 
@@ -29,47 +37,522 @@ namespace Checker {
         fVerbose = verbose;
     }
 
-    void CheckerCLI::Compare(const CheckerConfig& config) {
-        // Instantiate Checker object with given configuration
-        Checker checker(config.fTTreeFile, config.fRNTupleFile, config.fTTreeName, config.fRNTupleName);
+    bool CheckerCLI::Compare(const CheckerConfig& config) {
+        auto& profile = MemoryProfile::Instance();
+        if (config.fMemoryReport) {
+            profile.Reset();
+            profile.SetEnabled(true);
+        }
 
         bool output = false;
         bool methodoutput = false;
+        bool passed = true;
+        {
+            // Collect the metadata of the requested checks and schedule a single pass over both files
+            ScanRequest request = config.fPolicy.empty() ? ScanRequest() : ReadCheckPolicy(config.fPolicy);
+            if (!config.fSelection.empty()) {
+                request.fSelection = config.fSelection;
+            }
+            if (config.fEngine == "dataframe") {
+                request.fEngine = ScanEngine::kDataFrame;
+            }
+            else if (config.fEngine == "native") {
+                request.fEngine = ScanEngine::kNative;
+            }
+            else if (!config.fEngine.empty()) {
+                throw std::runtime_error("Unknown engine: " + config.fEngine + " (expected native or dataframe)");
+            }
+            ScanPlan plan;
+            {
+                MemoryPhase phase("Plan");
+                plan = PlanScan({ config.fTTreeFile, config.fRNTupleFile, config.fTTreeName, config.fRNTupleName }, request);
+            }
 
-        // Compare entry counts
-        methodoutput = PrintEntryComparison(checker.CountEntries());
-        if (methodoutput) output = true;
-
-        // Compare field counts
-        methodoutput = PrintFieldComparison(checker.CountFields());
-        if (methodoutput) output = true;
-
-        // Compare field names
-        methodoutput = PrintFieldNameComparison(checker.CompareFieldNames());
-        if (methodoutput) output = true;
-        methodoutput = PrintFieldTypeComparison(checker.CompareFieldTypes());
-        if (methodoutput) output = true;
+            // Compare entry counts, field counts, names and types
+            if (request.fStructure) {
+                methodoutput = PrintEntryComparison(plan.fEntries);
+                if (methodoutput) output = true;
+                methodoutput = PrintFieldComparison(plan.fFields);
+                if (methodoutput) output = true;
+                methodoutput = PrintFieldNameComparison(plan.fFieldNames);
+                if (methodoutput) output = true;
+                methodoutput = PrintFieldTypeComparison(plan.fFieldTypes);
+                if (methodoutput) output = true;
+
+                // Near type matches only warn, as in batch mode
+                passed = plan.fEntries.first == plan.fEntries.second && plan.fFields.first == plan.fFields.second
+                    && std::all_of(plan.fFieldNames.begin(), plan.fFieldNames.end(),
+                                   [](const std::pair<std::string, std::string>& names) { return names.first == names.second; })
+                    && std::none_of(plan.fFieldTypes.begin(), plan.fFieldTypes.end(), [](const std::tuple<std::string, std::string, std::string>& types) {
+                           return MatchFieldTypes(std::get<1>(types), std::get<2>(types)) == FieldTypeMatch::kMismatch;
+                       });
+            }
 
-        // Generate histograms and gather statistics
-        auto histDataTTree = HistTTree(checker.ReadIntFromTTree(), checker.ReadFloatFromTTree(),
-            checker.ReadDoubleFromTTree(), checker.ReadBoolFromTTree());
-        auto histDataRNTuple = HistRNTuple(checker.ReadIntFromRNTuple(), checker.ReadFloatFromRNTuple(),
-            checker.ReadDoubleFromRNTuple(), checker.ReadBoolFromRNTuple());
+            // Compare the values and gather the histogram statistics, reading every column once
+            ScanResult scan;
+            {
+                MemoryPhase phase("Scan");
+                scan = request.fEngine == ScanEngine::kDataFrame ? RunFrameScan(plan, config.fThreads) : RunScan(plan);
+            }
+            methodoutput = PrintValueComparison(scan);
+            if (methodoutput) output = true;
+            passed = passed && scan.fPassed;
 
-        // Draw and print histogram statistics
-        HistogramDrawStat(histDataTTree, histDataRNTuple);
+            // Draw and print histogram statistics
+            if (request.fStatistics && request.fHistograms) {
+                DrawScanHistograms(scan);
+            }
+            if (request.fStatistics) {
+                std::vector<std::tuple<int, double, double>> histDataTTree;
+                std::vector<std::tuple<int, double, double>> histDataRNTuple;
+                for (std::size_t k = 0; k < scan.fTTreeStatistics.size(); ++k) {
+                    histDataTTree.push_back(scan.fTTreeStatistics[k].GetSummary());
+                    histDataRNTuple.push_back(scan.fRNTupleStatistics[k].GetSummary());
+                }
+                HistogramDrawStat(histDataTTree, histDataRNTuple);
+            }
+        }
 
         // If no inconsistencies were found, print a success message
         if (!output) {
             PrintStyled("\nCheck ran through successfully! No inconsistency found.", { CheckerCLI::GREEN }, true, true);
         }
+
+        if (config.fMemoryReport) {
+            profile.SetEnabled(false);
+            PrintMemoryReport();
+        }
+        return passed;
+    }
+
+    bool CheckerCLI::PrintValueComparison(const ScanResult& scan) {
+        if (!fVerbose && scan.fIssues.empty()) {
+            return false;
+        }
+
+        PrintStyled("*** Values ***", { CheckerCLI::MEDIUM_BLUE });
+        for (const auto& issue : scan.fIssues) {
+            PrintStyled(issue, { CheckerCLI::RED }, true);
+        }
+        for (const auto& warning : scan.fWarnings) {
+            PrintStyled(warning, { CheckerCLI::YELLOW }, true);
+        }
+        for (const auto& column : scan.fColumnStatistics) {
+            std::ostringstream line;
+            line << column.fColumn << ": TTree mean " << column.fTTree.fMean << " (std dev " << column.fTTree.GetStdDev()
+                 << "), RNTuple mean " << column.fRNTuple.fMean << " (std dev " << column.fRNTuple.GetStdDev() << ") over "
+                 << column.fTTree.fEntries << " / " << column.fRNTuple.fEntries << " entries";
+            PrintStyled(line.str(), { CheckerCLI::DEFAULT }, true);
+        }
+        PrintStyled("Columns compared: " + std::to_string(scan.fNCompared) + ", entries: " + std::to_string(scan.fNSelected)
+            + ", column reads: " + std::to_string(scan.fNReads), { CheckerCLI::DEFAULT }, true, true);
+        return true;
+    }
+
+    void CheckerCLI::DrawScanHistograms(const ScanResult& scan) {
+        const int colours[] = { kRed, kBlue, kGreen, kMagenta };
+        const auto draw = [&](const std::string& side, const std::array<ScanStatistics, 4>& statistics) {
+            TCanvas* canvas = new TCanvas((side + "_Combined_Canvas").c_str(), (side + " Combined Histogram").c_str(), 1200, 800);
+            canvas->Divide(2, 2);
+            for (std::size_t k = 0; k < statistics.size(); ++k) {
+                canvas->cd(k + 1);
+                if (statistics[k].fHistogram && statistics[k].fEntries > 0) {
+                    statistics[k].fHistogram->SetLineColor(colours[k]);
+                    statistics[k].fHistogram->Draw();
+                }
+            }
+            canvas->SaveAs((side + "_Combined_Histogram.png").c_str());
+        };
+        draw("TTree", scan.fTTreeStatistics);
+        draw("RNTuple", scan.fRNTupleStatistics);
+    }
+
+    void CheckerCLI::PrintMemoryReport() {
+        PrintStyled("*** Memory ***", { CheckerCLI::MEDIUM_BLUE });
+        MemoryProfile::Instance().Print(std::cout);
+        std::cout << std::endl;
+    }
+
+    bool CheckerCLI::CompareBatch(const CheckerConfig& config) {
+        std::vector<PairSpec> pairs;
+        AutoPairing pairing;
+        if (config.fAllPairs) {
+            pairing = PairByName(config.fTTreeFile, config.fRNTupleFile, config.fPairRule);
+            pairs = pairing.fPairs;
+        }
+        else {
+            pairs = ReadManifest(config.fManifest);
+        }
+
+        std::vector<std::string> files;
+        for (const auto& pair : pairs) {
+            files.push_back(pair.fTTreeFile);
+            files.push_back(pair.fRNTupleFile);
+        }
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+        auto checkpoint = OpenCheckpoint(config, files, "batch");
+
+        const auto start = std::chrono::steady_clock::now();
+        auto results = RunBatch(pairs, config.fThreads, true, checkpoint.get());
+        if (checkpoint) {
+            checkpoint->Remove(); // The run is complete
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Objects without a partner fail the run like a failed pair
+        const auto unpaired = ReportUnpaired(pairing, config.fTTreeFile, config.fRNTupleFile);
+        results.insert(results.end(), unpaired.begin(), unpaired.end());
+
+        PrintBatchReport(results, seconds);
+        return std::all_of(results.begin(), results.end(), [](const PairResult& result) { return result.fPassed; });
+    }
+
+    void CheckerCLI::PrintBatchReport(const std::vector<PairResult>& results, double seconds) {
+        int width = 20;
+        std::size_t nPassed = 0;
+        std::size_t nWarned = 0;
+
+        PrintStyled("*** Batch ***", { CheckerCLI::MEDIUM_BLUE }); // Print the section header
+
+        for (const auto& result : results) {
+            if (result.fPassed) {
+                ++nPassed;
+                if (!result.fWarnings.empty()) ++nWarned;
+                if (!fVerbose && result.fWarnings.empty()) {
+                    continue;
+                }
+            }
+
+            PrintPairResult(result);
+        }
+
+        // Final output line - counts of all pairs
+        std::cout << std::endl;
+        PrintStyled("Pairs: " + std::to_string(results.size()), { CheckerCLI::DEFAULT }, width, false);
+        PrintStyled("Passed: " + std::to_string(nPassed), { CheckerCLI::GREEN }, width, false);
+        PrintStyled("With warnings: " + std::to_string(nWarned), { CheckerCLI::DEFAULT }, width, false);
+        PrintStyled("Failed: " + std::to_string(results.size() - nPassed), { results.size() == nPassed ? CheckerCLI::DEFAULT : CheckerCLI::RED }, width, false);
+        std::cout << std::fixed << std::setprecision(2) << "(" << seconds << " s)" << std::endl;
+
+        if (results.size() == nPassed) {
+            PrintStyled("\nBatch ran through successfully! No inconsistency found.", { CheckerCLI::GREEN }, true, true);
+        }
+    }
+
+    void CheckerCLI::PrintPairResult(const PairResult& result) {
+        const auto& pair = result.fPair;
+        if (!result.fPassed) {
+            PrintStyled("   FAILED   ", { CheckerCLI::WHITE, CheckerCLI::BG_RED }, false);
+        }
+        else if (!result.fWarnings.empty()) {
+            PrintStyled("   WARNING  ", { CheckerCLI::BLACK, CheckerCLI::BG_YELLOW }, false);
+        }
+        else {
+            PrintStyled("   PASSED   ", { CheckerCLI::BLACK, CheckerCLI::BG_GREEN }, false);
+        }
+        PrintStyled(" " + pair.fTTreeFile + ":" + pair.fTTreeName + "  |  " + pair.fRNTupleFile + ":" + pair.fRNTupleName,
+                    { CheckerCLI::DEFAULT }, false);
+        std::cout << std::fixed << std::setprecision(2) << "  (" << result.fSeconds << " s)" << std::endl;
+
+        if (!result.fError.empty()) {
+            PrintStyled("      " + result.fError, { CheckerCLI::RED });
+        }
+        for (const auto& issue : result.fIssues) {
+            PrintStyled("      " + issue, { CheckerCLI::RED });
+        }
+        for (const auto& warning : result.fWarnings) {
+            PrintStyled("      " + warning, { CheckerCLI::DEFAULT });
+        }
+    }
+
+    bool CheckerCLI::CompareChain(const CheckerConfig& config) {
+        const auto ttreeFiles = ReadFileList(config.fTTreeFile);
+        const auto rntupleFiles = ReadFileList(config.fRNTupleFile);
+        std::vector<std::string> files = ttreeFiles;
+        files.insert(files.end(), rntupleFiles.begin(), rntupleFiles.end());
+        auto checkpoint = OpenCheckpoint(config, files, "chain " + config.fTTreeName + " " + config.fRNTupleName
+                                                        + " " + std::to_string(ttreeFiles.size()));
+
+        const auto result = CompareChains(ttreeFiles, rntupleFiles, config.fTTreeName, config.fRNTupleName, config.fThreads,
+                                          checkpoint.get());
+        if (checkpoint) {
+            checkpoint->Remove();
+        }
+        PrintChainReport(result, ttreeFiles.size(), rntupleFiles.size());
+        return result.fPassed;
+    }
+
+    void CheckerCLI::PrintChainReport(const ChainResult& result, std::size_t nTTreeFiles, std::size_t nRNTupleFiles) {
+        int width = 20;
+        PrintStyled("*** Chain ***", { CheckerCLI::MEDIUM_BLUE }); // Print the section header
+
+        if (fVerbose || !result.fPassed) {
+            PrintStyled(std::string(""), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled(std::string("|  Files"), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled(std::string("Entries"), { CheckerCLI::DEFAULT }, width, true);
+            PrintStyled(std::string("-------------------------------------"), { CheckerCLI::DEFAULT }, true);
+            PrintStyled(std::string("TTree"), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled("|  " + std::to_string(nTTreeFiles), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled(std::to_string(result.fTTreeEntries), { CheckerCLI::DEFAULT }, width, true);
+            PrintStyled(std::string("RNTuple"), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled("|  " + std::to_string(nRNTupleFiles), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled(std::to_string(result.fRNTupleEntries), { CheckerCLI::DEFAULT }, width, true);
+            std::cout << "\n" << result.fNSegments << " segments, " << result.fNColumns << " columns compared value by value"
+                      << std::fixed << std::setprecision(2) << " (" << result.fSeconds << " s)" << std::endl;
+        }
+
+        for (const auto& issue : result.fIssues) {
+            PrintStyled("   " + issue, { CheckerCLI::RED });
+        }
+
+        // Final output line - TRUE/FALSE
+        PrintStyled("\nThe chains have the same content: ", { CheckerCLI::DEFAULT }, false);
+        if (result.fPassed) {
+            PrintStyled("TRUE", { CheckerCLI::BLACK, CheckerCLI::BG_GREEN }, true, true);
+        }
+        else {
+            PrintStyled("FALSE", { CheckerCLI::BLACK, CheckerCLI::BG_RED }, true, true);
+        }
+    }
+
+    bool CheckerCLI::CompareVariantSet(const CheckerConfig& config) {
+        const auto files = ReadFileList(config.fRNTupleFile);
+
+        std::vector<std::string> names;
+        std::istringstream nameList(config.fRNTupleName);
+        for (std::string name; std::getline(nameList, name, ',');) {
+            names.push_back(name);
+        }
+        if (names.size() != 1 && names.size() != files.size()) {
+            throw std::runtime_error("Expected one RNTuple name or one per file, got " + std::to_string(names.size())
+                                     + " names for " + std::to_string(files.size()) + " files");
+        }
+
+        std::vector<VariantSpec> variants;
+        for (std::size_t k = 0; k < files.size(); ++k) {
+            variants.push_back({ files[k], names.size() == 1 ? names.front() : names[k] });
+        }
+
+        const auto results = CompareVariants(config.fTTreeFile, config.fTTreeName, variants);
+        PrintVariantReport(results);
+        return std::all_of(results.begin(), results.end(), [](const VariantResult& result) { return result.fPassed; });
+    }
+
+    void CheckerCLI::PrintVariantReport(const std::vector<VariantResult>& results) {
+        std::size_t nPassed = 0;
+        PrintStyled("*** Variants ***", { CheckerCLI::MEDIUM_BLUE }); // Print the section header
+
+        for (const auto& result : results) {
+            if (result.fPassed) {
+                ++nPassed;
+                if (!fVerbose && result.fWarnings.empty()) {
+                    continue;
+                }
+            }
+
+            if (!result.fPassed) {
+                PrintStyled("   FAILED   ", { CheckerCLI::WHITE, CheckerCLI::BG_RED }, false);
+            }
+            else if (!result.fWarnings.empty()) {
+                PrintStyled("   WARNING  ", { CheckerCLI::BLACK, CheckerCLI::BG_YELLOW }, false);
+            }
+            else {
+                PrintStyled("   PASSED   ", { CheckerCLI::BLACK, CheckerCLI::BG_GREEN }, false);
+            }
+            PrintStyled(" " + result.fVariant.fRNTupleFile + ":" + result.fVariant.fRNTupleName
+                        + "  (" + std::to_string(result.fNColumns) + " columns compared)", { CheckerCLI::DEFAULT });
+
+            if (!result.fError.empty()) {
+                PrintStyled("      " + result.fError, { CheckerCLI::RED });
+            }
+            for (const auto& issue : result.fIssues) {
+                PrintStyled("      " + issue, { CheckerCLI::RED });
+            }
+            for (const auto& warning : result.fWarnings) {
+                PrintStyled("      " + warning, { CheckerCLI::DEFAULT });
+            }
+        }
+
+        // Final output line - TRUE/FALSE
+        PrintStyled("\nAll " + std::to_string(results.size()) + " variants match the TTree: ", { CheckerCLI::DEFAULT }, false);
+        if (nPassed == results.size()) {
+            PrintStyled("TRUE", { CheckerCLI::BLACK, CheckerCLI::BG_GREEN }, true, true);
+        }
+        else {
+            PrintStyled("FALSE", { CheckerCLI::BLACK, CheckerCLI::BG_RED }, true, true);
+        }
+    }
+
+    bool CheckerCLI::ComparePlanned(const CheckerConfig& config) {
+        if (!config.fPolicy.empty() || !config.fSelection.empty() || !config.fEngine.empty()) {
+            throw std::runtime_error("The planned checks take no policy, selection or engine; set fail_fast in the policy to stop the scan early");
+        }
+        const CheckPlan plan = PlanChecks({ config.fTTreeFile, config.fRNTupleFile, config.fTTreeName, config.fRNTupleName });
+        if (config.fShowPlan || fVerbose) {
+            PrintPlan(plan);
+        }
+
+        const PairResult result = RunPlan(plan, config.fFailFast);
+        PrintStyled("*** Result ***", { CheckerCLI::MEDIUM_BLUE });
+        PrintPairResult(result);
+
+        // Final output line - TRUE/FALSE
+        PrintStyled("\nTTree and RNTuple have the same content: ", { CheckerCLI::DEFAULT }, false);
+        if (result.fPassed) {
+            PrintStyled("TRUE", { CheckerCLI::BLACK, CheckerCLI::BG_GREEN }, true, true);
+        }
+        else {
+            PrintStyled("FALSE", { CheckerCLI::BLACK, CheckerCLI::BG_RED }, true, true);
+        }
+        return result.fPassed;
+    }
+
+    void CheckerCLI::PrintPlan(const CheckPlan& plan) {
+        int width = 20;
+        PrintStyled("*** Plan ***", { CheckerCLI::MEDIUM_BLUE }); // Print the section header
+
+        PrintStyled(std::string("Column"), { CheckerCLI::DEFAULT }, width, false);
+        PrintStyled(std::string("|  Type"), { CheckerCLI::DEFAULT }, width, false);
+        PrintStyled(std::string("|  Compressed"), { CheckerCLI::DEFAULT }, width, false);
+        PrintStyled(std::string("|  Elements/entry"), { CheckerCLI::DEFAULT }, width, false);
+        PrintStyled(std::string("|  Est. seconds"), { CheckerCLI::DEFAULT }, width, true);
+        PrintStyled(std::string("-----------------------------------------------------------------------------------------"), { CheckerCLI::DEFAULT }, true);
+        for (const auto& check : plan.fColumns) {
+            std::ostringstream elements;
+            std::ostringstream cost;
+            elements << std::fixed << std::setprecision(1) << check.fMeanVectorSize;
+            cost << std::setprecision(3) << check.fCost;
+            PrintStyled(check.fColumn, { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled("|  " + check.fType, { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled("|  " + std::to_string(check.fCompressedBytes / 1024) + " kB", { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled("|  " + elements.str(), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled("|  " + cost.str(), { CheckerCLI::DEFAULT }, width, true);
+        }
+        std::cout << "\n" << plan.fNEntries << " entries, " << plan.fColumns.size() << " value comparisons after "
+                  << plan.fStructure.fIssues.size() << " structural issues, estimated " << std::setprecision(3) << plan.fCost << " s\n" << std::endl;
     }
 
-    void CheckerCLI::RunAll(const CheckerConfig& config) {
-        if (config.fShouldRun) {
-            // Run the comparison if the configuration flag is set
-            Compare(config);
+    bool CheckerCLI::CompareSourcePair(const CheckerConfig& config) {
+        const SourceSpec a{ DetectSourceKind(config.fFileA, config.fNameA), config.fFileA, config.fNameA };
+        const SourceSpec b{ DetectSourceKind(config.fFileB, config.fNameB), config.fFileB, config.fNameB };
+        auto checkpoint = OpenCheckpoint(config, { a.fFile, b.fFile }, "sources " + a.fName + " " + b.fName
+                                                                             + " " + std::to_string(config.fThreads)); // Threads set the ranges
+
+        const auto result = CompareSources(a, b, config.fThreads, checkpoint.get());
+        if (checkpoint) {
+            checkpoint->Remove();
         }
+        PrintSourceReport(result, a, b);
+        return result.fPassed;
+    }
+
+    void CheckerCLI::PrintSourceReport(const SourceResult& result, const SourceSpec& a, const SourceSpec& b) {
+        int width = 20;
+        auto kindName = [](const SourceSpec& spec) { return spec.fKind == SourceKind::kTTree ? std::string("TTree") : std::string("RNTuple"); };
+        PrintStyled("*** " + kindName(a) + " vs " + kindName(b) + " ***", { CheckerCLI::MEDIUM_BLUE }); // Print the section header
+
+        if (fVerbose || !result.fPassed) {
+            PrintStyled(std::string("Entries - A"), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled(std::string("|  "), { CheckerCLI::DEFAULT }, false);
+            PrintStyled(std::string("Entries - B"), { CheckerCLI::DEFAULT }, width, true);
+            PrintStyled(std::string("-------------------------------------"), { CheckerCLI::DEFAULT }, true);
+            PrintStyled(std::to_string(result.fEntriesA), { CheckerCLI::DEFAULT }, width, false);
+            PrintStyled(std::string("|  "), { CheckerCLI::DEFAULT }, false);
+            PrintStyled(std::to_string(result.fEntriesB), { CheckerCLI::DEFAULT }, width, true);
+            std::cout << "\nA: " << a.fFile << ":" << a.fName << "\nB: " << b.fFile << ":" << b.fName << "\n"
+                      << result.fNColumns << " columns compared value by value"
+                      << std::fixed << std::setprecision(2) << " (" << result.fSeconds << " s)" << std::endl;
+        }
+
+        for (const auto& issue : result.fIssues) {
+            PrintStyled("   " + issue, { CheckerCLI::RED });
+        }
+        for (const auto& warning : result.fWarnings) {
+            PrintStyled("   " + warning, { CheckerCLI::DEFAULT });
+        }
+
+        // Final output line - TRUE/FALSE
+        PrintStyled("\nBoth sides have the same content: ", { CheckerCLI::DEFAULT }, false);
+        if (result.fPassed) {
+            PrintStyled("TRUE", { CheckerCLI::BLACK, CheckerCLI::BG_GREEN }, true, true);
+        }
+        else {
+            PrintStyled("FALSE", { CheckerCLI::BLACK, CheckerCLI::BG_RED }, true, true);
+        }
+    }
+
+    void CheckerCLI::Serve(const CheckerConfig& config) {
+        Daemon daemon(config.fServeSocket, config.fThreads);
+        PrintStyled("Listening on " + config.fServeSocket + " (" + std::to_string(daemon.GetMaxJobs()) + " jobs at a time)",
+                    { CheckerCLI::MEDIUM_BLUE });
+        daemon.Serve();
+        PrintStyled("Daemon stopped.", { CheckerCLI::DEFAULT });
+    }
+
+    bool CheckerCLI::Submit(const CheckerConfig& config) {
+        std::vector<PairSpec> pairs;
+        if (!config.fManifest.empty()) {
+            pairs = ReadManifest(config.fManifest);
+        }
+        else {
+            pairs.push_back({ config.fTTreeFile, config.fRNTupleFile, config.fTTreeName, config.fRNTupleName });
+        }
+        return SubmitJobs(config.fSubmitSocket, pairs, std::cout);
+    }
+
+    void CheckerCLI::Watch(const CheckerConfig& config) {
+        Watcher watcher(config.fWatchDirectory, config.fFileRule, config.fPairRule, config.fThreads);
+        PrintStyled("Watching " + config.fWatchDirectory + " (" + std::to_string(watcher.GetMaxJobs()) + " files at a time)",
+                    { CheckerCLI::MEDIUM_BLUE });
+        watcher.Watch([this](const PairResult& result) { PrintPairResult(result); });
+    }
+
+    std::unique_ptr<Checkpoint> CheckerCLI::OpenCheckpoint(const CheckerConfig& config, const std::vector<std::string>& files,
+                                                           const std::string& options) {
+        if (config.fCheckpoint.empty()) {
+            return nullptr;
+        }
+        auto checkpoint = std::make_unique<Checkpoint>(config.fCheckpoint, Checkpoint::Fingerprint(files, options));
+        if (checkpoint->GetNRestored() > 0) {
+            PrintStyled("Resuming from " + config.fCheckpoint + ": " + std::to_string(checkpoint->GetNRestored()) + " units of work already done",
+                        { CheckerCLI::MEDIUM_BLUE });
+        }
+        return checkpoint;
+    }
+
+    bool CheckerCLI::RunAll(const CheckerConfig& config) {
+        if (!config.fShouldRun) {
+            return true;
+        }
+        // Run the comparison if the configuration flag is set
+        if (!config.fServeSocket.empty()) {
+            Serve(config);
+            return true;
+        }
+        if (!config.fSubmitSocket.empty()) {
+            return Submit(config);
+        }
+        if (!config.fWatchDirectory.empty()) {
+            Watch(config);
+            return true;
+        }
+        if (!config.fManifest.empty() || config.fAllPairs) {
+            return CompareBatch(config);
+        }
+        if (config.fChain) {
+            return CompareChain(config);
+        }
+        if (config.fVariants) {
+            return CompareVariantSet(config);
+        }
+        if (!config.fFileA.empty()) {
+            return CompareSourcePair(config);
+        }
+        if (config.fFailFast || config.fShowPlan) {
+            return ComparePlanned(config);
+        }
+        return Compare(config);
     }
 
     void CheckerCLI::PrintStyled(const std::string& text, const std::initializer_list<std::string>& styles, bool firstLineBreak, bool secondLineBreak) {
@@ -227,10 +710,9 @@ namespace Checker {
     }
 
 
-    bool CheckerCLI::PrintFieldTypeComparison(const std::vector<std::tuple<std::string, std::string, std::string>>& fieldTypes) {
-
+    std::string MapFieldType(const std::string& type) {
         // Map of accepted type (left) and what it matches with (right)
-        std::unordered_map<std::string, std::string> typeMap = {
+        static const std::unordered_map<std::string, std::string> typeMap = {
             {"Int_t", "int"},
             {"std::int32_t", "int"},
             {"Float_t", "float"},
@@ -245,47 +727,54 @@ namespace Checker {
             {"std::vector<double>", "vector<double>"},
             {"std::vector<bool>", "vector<bool>"},
             {"vector<int>", "vector<int>"},
-            {"std::vector<int>", "vector<int>"},
             {"vector<float>", "vector<float>"},
             {"vector<double>", "vector<double>"},
             {"vector<bool>", "vector<bool>"}
         };
+        auto it = typeMap.find(type);
+        return it != typeMap.end() ? it->second : "Missing";
+    }
+
+    FieldTypeMatch MatchFieldTypes(const std::string& ttreeType, const std::string& rntupleType) {
         // Map of yellow-flagged accepted type (left) and what it may go with (right)
-        std::unordered_map<std::string, std::string> yellowMap = {
-            {"Float_t", "double"},
-            {"Float_t", "double"},
+        static const std::unordered_map<std::string, std::string> yellowMap = {
             {"float", "double"},
-            {"Double_t", "float"},
             {"double", "float"},
-            {"std::vector<float>", "vector<double>"},
-            {"std::vector<double>", "vector<float>"},
             {"vector<float>", "vector<double>"},
             {"vector<double>", "vector<float>"}
         };
 
+        const std::string ttreeTypeMapped = MapFieldType(ttreeType);
+        const std::string rntupTypeMapped = MapFieldType(rntupleType);
+        if (ttreeTypeMapped == "Missing" || rntupTypeMapped == "Missing") {
+            return FieldTypeMatch::kMissing;
+        }
+        if (ttreeTypeMapped == rntupTypeMapped) {
+            return FieldTypeMatch::kExact;
+        }
+        auto it = yellowMap.find(ttreeTypeMapped);
+        if (it != yellowMap.end() && it->second == rntupTypeMapped) {
+            return FieldTypeMatch::kNear;
+        }
+        return FieldTypeMatch::kMismatch;
+    }
+
+    bool CheckerCLI::PrintFieldTypeComparison(const std::vector<std::tuple<std::string, std::string, std::string>>& fieldTypes) {
         int diffLevel = 0;
         bool missingType = false;
 
         // Initial looping through! - just to determine whether there will be discrepancies
         // - if non-verbose + nothing is found here: nothing returned
         for (const auto& tuple : fieldTypes) {
-            std::string ttreeType = std::get<1>(tuple);
-            std::string rntupType = std::get<2>(tuple);
-
-            std::string ttreeTypeMapped = typeMap.count(ttreeType) ? typeMap[ttreeType] : "Missing";
-            std::string rntupTypeMapped = typeMap.count(rntupType) ? typeMap[rntupType] : "Missing";
-
-            if (ttreeTypeMapped == "Missing" || rntupTypeMapped == "Missing") {
+            const FieldTypeMatch match = MatchFieldTypes(std::get<1>(tuple), std::get<2>(tuple));
+            if (match == FieldTypeMatch::kMissing) {
                 missingType = true;
             }
-
-            if (!missingType && ttreeTypeMapped != rntupTypeMapped) {
-                if ((yellowMap[ttreeTypeMapped] == rntupTypeMapped) || (ttreeTypeMapped == yellowMap[rntupTypeMapped])) {
-                    diffLevel = 1;
-                }
-                else {
-                    diffLevel = 2;
-                }
+            if (!missingType && match == FieldTypeMatch::kNear) {
+                diffLevel = std::max(diffLevel, 1);
+            }
+            else if (!missingType && match == FieldTypeMatch::kMismatch) {
+                diffLevel = 2;
             }
         }
 
@@ -311,9 +800,10 @@ namespace Checker {
             std::string rntupType = std::get<2>(tuple);
 
             // Using the type map, find matching data types - set "Missing" if not found"
-            std::string ttreeTypeMapped = typeMap.count(ttreeType) ? typeMap[ttreeType] : "Missing";
-            std::string rntupTypeMapped = typeMap.count(rntupType) ? typeMap[rntupType] : "Missing";
-            if (ttreeTypeMapped == "Missing" || rntupTypeMapped == "Missing") {
+            std::string ttreeTypeMapped = MapFieldType(ttreeType);
+            std::string rntupTypeMapped = MapFieldType(rntupType);
+            const FieldTypeMatch match = MatchFieldTypes(ttreeType, rntupType);
+            if (match == FieldTypeMatch::kMissing) {
                 missingType = true; // Current field has a missing type
             }
 
@@ -324,15 +814,13 @@ namespace Checker {
             PrintStyled(std::string(std::get<0>(tuple)), { CheckerCLI::DEFAULT }, width, false);
 
             // Mis-matches found -> either print yellow (near match) or big red flag
-            if (!missingType && ttreeTypeMapped != rntupTypeMapped) {
-                if ((yellowMap[ttreeTypeMapped] == rntupTypeMapped) || (ttreeTypeMapped == yellowMap[ttreeTypeMapped])) {
-                    diffLevel = 1;
-                    PrintStyled("   no exact match   ", { CheckerCLI::WHITE, CheckerCLI::BG_YELLOW }, false);
-                }
-                else {
-                    diffLevel = 2;
-                    PrintStyled("   type mismatch   ", { CheckerCLI::WHITE, CheckerCLI::BG_RED }, false);
-                }
+            if (!missingType && match == FieldTypeMatch::kNear) {
+                diffLevel = std::max(diffLevel, 1);
+                PrintStyled("   no exact match   ", { CheckerCLI::WHITE, CheckerCLI::BG_YELLOW }, false);
+            }
+            else if (!missingType && match == FieldTypeMatch::kMismatch) {
+                diffLevel = 2;
+                PrintStyled("   type mismatch   ", { CheckerCLI::WHITE, CheckerCLI::BG_RED }, false);
             }
             std::cout << std::endl;
         }
@@ -17,6 +17,14 @@
 #define CHECKERCLI_HXX
 
 #include "Checker.hxx"
+#include "CheckerBatch.hxx"
+#include "CheckerChain.hxx"
+#include "CheckerPlan.hxx"
+#include "CheckerPolicy.hxx"
+#include "CheckerScan.hxx"
+#include "CheckerSource.hxx"
+#include "CheckerVariants.hxx"
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -27,8 +35,50 @@ namespace Checker {
         std::string fTTreeName;
         std::string fRNTupleName;
         bool fShouldRun = false;
+        bool fMemoryReport = false;     // Print peak RSS and allocations per phase and column after the check
+        std::string fManifest;          // Verify all pairs listed in this file instead of the single pair above
+        unsigned fThreads = 0;          // Worker threads for the manifest; 0 uses one per hardware thread
+        bool fAllPairs = false;         // Verify every TTree of fTTreeFile against its RNTuple in fRNTupleFile
+        std::string fPairRule;          // <from>:<to> rule for fAllPairs, e.g. "tree_:rntuple_"
+        bool fChain = false;            // fTTreeFile and fRNTupleFile are file lists (see ReadFileList) compared as chains
+        bool fVariants = false;         // fRNTupleFile is a file list of RNTuple variants of the one TTree
+        std::string fFileA;             // Same-format mode: any two TTrees or RNTuples, compared with each other
+        std::string fNameA;
+        std::string fFileB;
+        std::string fNameB;
+        std::string fServeSocket;       // Run as a daemon listening on this Unix socket
+        std::string fSubmitSocket;      // Send the pair(s) to the daemon on this socket instead of checking here
+        std::string fCheckpoint;        // Record progress of batch, chain and same-format runs here and resume from it
+        bool fFailFast = false;         // Stop at the first failed check, running the cheapest checks first
+        bool fShowPlan = false;         // Print the planned checks and their estimated costs before running them
+        std::string fWatchDirectory;    // Verify new RNTuple files in this directory as they are written
+        std::string fFileRule = "ttree:rntuple"; // <from>:<to> rule mapping an RNTuple file to its TTree file
+        std::string fPolicy;            // Check policy file (see ParseCheckPolicy) selecting the checks of the single pair
+        std::string fSelection;         // Only check the entries of the single pair passing this cut (see Selection)
+        std::string fEngine;            // native or dataframe; overrides the engine of the policy for the single pair
     };
 
+    /**
+     * @brief How well a TTree leaf type and an RNTuple field type correspond.
+     */
+    enum class FieldTypeMatch {
+        kExact,     // Same type, e.g. Int_t and std::int32_t
+        kNear,      // Only float against double, or their vectors
+        kMismatch,  // Different types
+        kMissing    // At least one type is not known to the Checker
+    };
+
+    /**
+     * @brief Returns the common name of a TTree or RNTuple type, e.g. "int" for both Int_t and std::int32_t,
+     *        or "Missing" if the type is not known to the Checker.
+     */
+    std::string MapFieldType(const std::string& type);
+
+    /**
+     * @brief Classifies a TTree leaf type against an RNTuple field type.
+     */
+    FieldTypeMatch MatchFieldTypes(const std::string& ttreeType, const std::string& rntupleType);
+
     CheckerConfig ParseArgs(int argc, char* argv[]);
     void RunChecker(const CheckerConfig& config);
 
@@ -55,22 +105,169 @@ namespace Checker {
          *
          * @param config The configuration object containing file paths and other
          *               comparison parameters.
+         * @return True if the entry counts, field counts, names and types match (near type matches only warn)
+         *         and the scan passed.
          * @throws std::runtime_error if any inconsistency is detected during the
          *         comparison process, such as misaligned data vectors or file read errors.
          */
-        void Compare(const CheckerConfig& config);
+        bool Compare(const CheckerConfig& config);
+
+        /**
+         * @brief Verifies every pair of the manifest in config.fManifest, or with config.fAllPairs every TTree of
+         *        config.fTTreeFile paired by name with an RNTuple of config.fRNTupleFile, and prints one aggregate report.
+         *
+         * Trees and RNTuples left without a partner are reported as failed pairs.
+         *
+         * The pairs are checked concurrently on config.fThreads worker threads (see RunBatch). No histograms
+         * are drawn; the scalar values are compared entry by entry instead.
+         *
+         * @return True if all pairs passed.
+         * @throws std::runtime_error if the manifest or either file cannot be read.
+         */
+        bool CompareBatch(const CheckerConfig& config);
+
+        /**
+         * @brief Prints the results of a batch run.
+         *
+         * Failed pairs are always listed with their issues; passed pairs only in verbose mode. A summary line
+         * with the number of passed, warned and failed pairs closes the report.
+         *
+         * @param results The results returned by RunBatch.
+         * @param seconds Wall time of the whole batch.
+         */
+        void PrintBatchReport(const std::vector<PairResult>& results, double seconds);
+
+        /**
+         * @brief Prints one line with the verdict and the pair, followed by the error, issues and warnings.
+         */
+        void PrintPairResult(const PairResult& result);
+
+        /**
+         * @brief Compares the TTree chain in config.fTTreeFile with the RNTuple files in config.fRNTupleFile.
+         *
+         * Both are file lists as accepted by ReadFileList. The file segments are verified on config.fThreads
+         * worker threads (see CompareChains) and the result is printed as one report.
+         *
+         * @return True if the chains match.
+         * @throws std::runtime_error if a list or file cannot be read.
+         */
+        bool CompareChain(const CheckerConfig& config);
+
+        /**
+         * @brief Prints the result of a chain comparison.
+         *
+         * The entry counts, segments and compared columns are shown in verbose mode or when the chains differ,
+         * followed by every issue found and a TRUE/FALSE verdict.
+         */
+        void PrintChainReport(const ChainResult& result, std::size_t nTTreeFiles, std::size_t nRNTupleFiles);
+
+        /**
+         * @brief Compares the TTree with every RNTuple variant in config.fRNTupleFile, reading the TTree once.
+         *
+         * config.fRNTupleFile is a file list as accepted by ReadFileList. config.fRNTupleName is either one
+         * name used for all files or a comma-separated list with one name per file.
+         *
+         * @return True if all variants match the TTree.
+         * @throws std::runtime_error if the lists do not fit together or the TTree cannot be read.
+         */
+        bool CompareVariantSet(const CheckerConfig& config);
+
+        /**
+         * @brief Prints one line per variant with its verdict, followed by its issues and warnings.
+         *
+         * Passed variants without warnings are only listed in verbose mode.
+         */
+        void PrintVariantReport(const std::vector<VariantResult>& results);
+
+        /**
+         * @brief Verifies the single pair of config by a plan that runs the cheapest checks first (see PlanChecks).
+         *
+         * With config.fFailFast the run stops at the first failed check. With config.fShowPlan, or in verbose
+         * mode, the plan is printed before it is run. The plan always covers all columns on the native reader,
+         * so config.fPolicy, config.fSelection and config.fEngine must be empty.
+         *
+         * @return True if the pair passed.
+         * @throws std::runtime_error if either side cannot be opened, or if a policy, selection or engine is set.
+         */
+        bool ComparePlanned(const CheckerConfig& config);
+
+        /**
+         * @brief Prints the value comparisons of a plan in the order they are run, with their estimated costs.
+         */
+        void PrintPlan(const CheckPlan& plan);
+
+        /**
+         * @brief Compares config.fNameA in config.fFileA with config.fNameB in config.fFileB, whatever their format.
+         *
+         * Each side may be a TTree or an RNTuple, which is told from the keys of its file, so this covers
+         * RNTuple-vs-RNTuple (e.g. before and after a ROOT upgrade or re-compression) and TTree-vs-TTree checks.
+         * The value comparison runs on config.fThreads worker threads (see CompareSources).
+         *
+         * @return True if both sides have the same content.
+         * @throws std::runtime_error if either side cannot be found.
+         */
+        bool CompareSourcePair(const CheckerConfig& config);
+
+        /**
+         * @brief Prints the result of CompareSourcePair: the entries of both sides in verbose mode or on failure,
+         *        every issue and warning, and a TRUE/FALSE verdict.
+         */
+        void PrintSourceReport(const SourceResult& result, const SourceSpec& a, const SourceSpec& b);
+
+        /**
+         * @brief Runs a Daemon on config.fServeSocket until a client sends SHUTDOWN.
+         *
+         * config.fThreads bounds the number of pairs checked at the same time.
+         *
+         * @throws std::runtime_error if the socket cannot be created.
+         */
+        void Serve(const CheckerConfig& config);
+
+        /**
+         * @brief Sends the pair, or all pairs of config.fManifest, to the daemon on config.fSubmitSocket and
+         *        prints the responses as they arrive.
+         *
+         * @return True if every pair passed.
+         * @throws std::runtime_error if the daemon cannot be reached.
+         */
+        bool Submit(const CheckerConfig& config);
+
+        /**
+         * @brief Watches config.fWatchDirectory and prints the result of every pair as soon as a new RNTuple file
+         *        in it is verified (see Watcher). Runs until the process is stopped.
+         *
+         * config.fFileRule maps RNTuple files to TTree files, config.fPairRule pairs the objects inside them
+         * and config.fThreads bounds the files verified at the same time.
+         *
+         * @throws std::runtime_error if the directory cannot be watched.
+         */
+        void Watch(const CheckerConfig& config);
 
         /**
          * @brief Runs the comparison process if the configuration specifies to do so.
          *
          * This function checks the configuration to determine if the comparison
-         * process should be executed by calling `Compare()`. If the `fShouldRun`
-         * flag is set in the configuration, the comparison process is triggered.
+         * process should be executed by calling `Compare()`, `CompareBatch()` if
+         * a manifest or all pairs are requested, `CompareChain()` for file lists, or
+         * `CompareVariantSet()` for RNTuple variants, `CompareSourcePair()` for
+         * two objects of any format, or `Serve()`/`Submit()` for the daemon. If the `fShouldRun` flag is set in the configuration,
+         * the comparison process is triggered.
          *
          * @param config The configuration object containing file paths and other
          *               comparison parameters.
+         * @return False if the comparison found a difference; true otherwise.
+         */
+        bool RunAll(const CheckerConfig& config);
+
+        /**
+         * @brief Prints the memory used by each phase of the last comparison.
+         *
+         * Shows the peak RSS of the "Plan" and "Scan" phases. The native engine adds a "Scan/<column>" phase for
+         * every column it reads; the RDataFrame engine reads all columns in one event loop and adds "Frame/Book",
+         * "Frame/Run" and "Frame/Rescan" instead, with "Scan/<column>" only for the columns it rescans.
+         * Allocation counts and bytes are included in builds with CHECKER_PROFILE.
          */
-        void RunAll(const CheckerConfig& config);
+        void PrintMemoryReport();
 
         /**
          * @brief Prints styled text to the console.
@@ -147,6 +344,24 @@ namespace Checker {
          */
         bool PrintFieldTypeComparison(const std::vector<std::tuple<std::string, std::string, std::string>>& fieldTypes);
 
+        /**
+         * @brief Prints the columns whose values differ, as found by a scan.
+         *
+         * If the verbosity is set to false and no values differ, it will not print anything.
+         *
+         * @param scan The result of the scan.
+         * @return True if values differ, a column could not be read, or verbosity is enabled; otherwise, false.
+         */
+        bool PrintValueComparison(const ScanResult& scan);
+
+        /**
+         * @brief Draws the histograms filled by a scan, one canvas per dataset with one pad per type,
+         *        and saves them as TTree_Combined_Histogram.png and RNTuple_Combined_Histogram.png.
+         *
+         * @param scan The result of a scan with statistics.
+         */
+        void DrawScanHistograms(const ScanResult& scan);
+
         /**
          * @brief Prints the contents of different vectors from the TTree dataset.
          *
@@ -271,6 +486,12 @@ namespace Checker {
         static constexpr const char* DEFAULT = "\033[39m";
 
     private:
+        /**
+         * @brief Opens config.fCheckpoint for a run over the given files, or returns nullptr without one.
+         */
+        std::unique_ptr<Checkpoint> OpenCheckpoint(const CheckerConfig& config, const std::vector<std::string>& files,
+                                                   const std::string& options);
+
         bool fVerbose = false;
     };
 } // namespace Checker
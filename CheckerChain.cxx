@@ -0,0 +1,255 @@
+/// \file CheckerChain.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerChain.hxx"
+#include "Checker.hxx"
+#include "CheckerCLI.hxx"
+#include "CheckerFilePool.hxx"
+#include "CheckerSource.hxx"
+
+#include <TROOT.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <glob.h>
+
+namespace Checker {
+
+    namespace {
+
+        struct ChainColumn {
+            std::string fName;
+            std::string fType; // "int", "float", "double" or "bool", as returned by MapFieldType
+        };
+
+        void AppendExpanded(const std::string& path, std::vector<std::string>& files) {
+            if (path.find('*') == std::string::npos) {
+                files.push_back(path);
+                return;
+            }
+            glob_t matches;
+            if (glob(path.c_str(), 0, nullptr, &matches) == 0) {
+                files.insert(files.end(), matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+            }
+            globfree(&matches);
+        }
+
+        // Returns false if the segment could not be read to the end
+        bool CompareSegment(const ChainSegment& segment, const std::vector<ChainColumn>& columns,
+                            const std::string& ttreePath, const std::string& rntuplePath,
+                            const std::string& ttreeName, const std::string& rntupleName, std::vector<std::string>& issues) {
+            try {
+                // Each worker thread gets its own TFile from the pool, and with it its own TTree
+                TTreeSource ttree(ttreePath, ttreeName);
+                RNTupleSource rntuple(rntuplePath, rntupleName);
+
+                for (const auto& column : columns) {
+                    const long long mismatch = FindFirstMismatch(column.fType, ttree, segment.fTTreeEntry, rntuple, segment.fRNTupleEntry,
+                                                                 column.fName, segment.fNEntries);
+                    if (mismatch >= 0) {
+                        issues.push_back(column.fName + " differs at entry " + std::to_string(segment.fFirstEntry + mismatch)
+                                         + " (" + ttreePath + " entry " + std::to_string(segment.fTTreeEntry + mismatch)
+                                         + ", " + rntuplePath + " entry " + std::to_string(segment.fRNTupleEntry + mismatch) + ")");
+                    }
+                }
+                return true;
+            }
+            catch (const std::exception& e) {
+                issues.push_back(std::string("Segment starting at entry ") + std::to_string(segment.fFirstEntry) + ": " + e.what());
+                return false;
+            }
+        }
+
+    } // namespace
+
+    std::vector<std::string> ReadFileList(const std::string& list) {
+        std::vector<std::string> files;
+        if (!list.empty() && list[0] == '@') {
+            std::ifstream listFile(list.substr(1));
+            if (!listFile) {
+                throw std::runtime_error("Cannot open file list: " + list.substr(1));
+            }
+            std::string line;
+            while (std::getline(listFile, line)) {
+                std::istringstream path(line.substr(0, line.find('#')));
+                std::string entry;
+                if (path >> entry) {
+                    AppendExpanded(entry, files);
+                }
+            }
+        }
+        else {
+            std::istringstream entries(list);
+            std::string entry;
+            while (std::getline(entries, entry, ',')) {
+                if (!entry.empty()) {
+                    AppendExpanded(entry, files);
+                }
+            }
+        }
+
+        if (files.empty()) {
+            throw std::runtime_error("No files in list: " + list);
+        }
+        return files;
+    }
+
+    std::vector<ChainSegment> MapChainEntries(const std::vector<long long>& ttreeEntries, const std::vector<long long>& rntupleEntries) {
+        std::vector<ChainSegment> segments;
+        std::size_t t = 0;
+        std::size_t r = 0;
+        long long ttreeEntry = 0;   // Next local entry in TTree file t
+        long long rntupleEntry = 0; // Next local entry in RNTuple file r
+        long long global = 0;
+
+        while (t < ttreeEntries.size() && r < rntupleEntries.size()) {
+            const long long n = std::min(ttreeEntries[t] - ttreeEntry, rntupleEntries[r] - rntupleEntry);
+            if (n > 0) {
+                segments.push_back({ t, r, global, n, ttreeEntry, rntupleEntry });
+                global += n;
+                ttreeEntry += n;
+                rntupleEntry += n;
+            }
+            // Step past every file that is used up; empty files are skipped here as well
+            if (ttreeEntry >= ttreeEntries[t]) {
+                ++t;
+                ttreeEntry = 0;
+            }
+            if (rntupleEntry >= rntupleEntries[r]) {
+                ++r;
+                rntupleEntry = 0;
+            }
+        }
+        return segments;
+    }
+
+    ChainResult CompareChains(const std::vector<std::string>& ttreeFiles, const std::vector<std::string>& rntupleFiles,
+                              const std::string& ttreeName, const std::string& rntupleName, unsigned nThreads,
+                              Checkpoint* checkpoint) {
+        ChainResult result;
+        const auto start = std::chrono::steady_clock::now();
+        auto finish = [&]() {
+            result.fPassed = result.fIssues.empty();
+            result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        };
+
+        if (ttreeFiles.empty() || rntupleFiles.empty()) {
+            throw std::runtime_error("Both chains need at least one file");
+        }
+
+        // Entry counts from metadata only: the TTree headers and the RNTuple descriptors
+        std::vector<long long> ttreeEntries;
+        std::vector<long long> rntupleEntries;
+        for (const auto& path : ttreeFiles) {
+            auto file = FilePool::Instance().GetFile(path);
+            TTree* tree = file ? file->Get<TTree>(ttreeName.c_str()) : nullptr;
+            if (!tree) {
+                throw std::runtime_error("Cannot find TTree: " + ttreeName + " in file: " + path);
+            }
+            ttreeEntries.push_back(tree->GetEntries());
+            result.fTTreeEntries += ttreeEntries.back();
+        }
+        for (const auto& path : rntupleFiles) {
+            rntupleEntries.push_back(FilePool::Instance().GetDescriptor(path, rntupleName)->GetNEntries());
+            result.fRNTupleEntries += rntupleEntries.back();
+        }
+        if (result.fTTreeEntries != result.fRNTupleEntries) {
+            result.fIssues.push_back("Entry count differs: " + std::to_string(result.fTTreeEntries) + " (TTree chain) vs "
+                                     + std::to_string(result.fRNTupleEntries) + " (RNTuple files)");
+        }
+
+        // The schema is taken from the first file of each side
+        std::vector<ChainColumn> columns;
+        {
+            Checker checker(ttreeFiles.front(), rntupleFiles.front(), ttreeName, rntupleName);
+            for (const auto& types : checker.CompareFieldTypes()) {
+                const std::string& name = std::get<0>(types);
+                const std::string& ttreeType = std::get<1>(types);
+                const std::string& rntupleType = std::get<2>(types);
+                if (ttreeType == "No match") {
+                    result.fIssues.push_back("Field only in RNTuple: " + name);
+                    continue;
+                }
+                if (rntupleType == "No match") {
+                    result.fIssues.push_back("Field only in TTree: " + name);
+                    continue;
+                }
+                const FieldTypeMatch match = MatchFieldTypes(ttreeType, rntupleType);
+                const std::string type = MapFieldType(ttreeType);
+                if (match == FieldTypeMatch::kMismatch) {
+                    result.fIssues.push_back("Type mismatch for " + name + ": " + ttreeType + " vs " + rntupleType);
+                }
+                else if (match == FieldTypeMatch::kExact && type.find("vector") == std::string::npos) {
+                    columns.push_back({ name, type });
+                }
+            }
+        }
+        if (!result.fIssues.empty()) {
+            return finish(); // Values only line up once the chains agree in length and structure
+        }
+        result.fNColumns = columns.size();
+
+        const auto segments = MapChainEntries(ttreeEntries, rntupleEntries);
+        result.fNSegments = segments.size();
+
+        if (nThreads == 0) {
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        nThreads = std::max<unsigned>(1, std::min<std::size_t>(nThreads, segments.size()));
+        if (nThreads > 1) {
+            ROOT::EnableThreadSafety();
+        }
+
+        std::vector<std::vector<std::string>> segmentIssues(segments.size());
+        std::atomic<std::size_t> nextSegment{ 0 };
+        auto worker = [&]() {
+            for (std::size_t s = nextSegment++; s < segments.size(); s = nextSegment++) {
+                const std::string key = "segment\t" + std::to_string(segments[s].fFirstEntry) + "\t" + std::to_string(segments[s].fNEntries);
+                if (checkpoint && checkpoint->Find(key, segmentIssues[s])) {
+                    continue;
+                }
+                const bool complete = CompareSegment(segments[s], columns, ttreeFiles[segments[s].fTTreeFile],
+                                                     rntupleFiles[segments[s].fRNTupleFile], ttreeName, rntupleName, segmentIssues[s]);
+                if (checkpoint && complete) {
+                    checkpoint->Record(key, segmentIssues[s]); // Read errors are not kept; the segment is tried again
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < nThreads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker(); // The calling thread works as well
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        // Report in entry order, whichever thread finished first
+        for (auto& issues : segmentIssues) {
+            result.fIssues.insert(result.fIssues.end(), issues.begin(), issues.end());
+        }
+        return finish();
+    }
+
+} // namespace Checker
@@ -0,0 +1,90 @@
+/// \file CheckerChain.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERCHAIN_HXX
+#define CHECKERCHAIN_HXX
+
+#include "CheckerCheckpoint.hxx"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief A range of global entries that lies within one TTree file and one RNTuple file.
+     */
+    struct ChainSegment {
+        std::size_t fTTreeFile = 0;     // Index into the TTree file list
+        std::size_t fRNTupleFile = 0;   // Index into the RNTuple file list
+        long long fFirstEntry = 0;      // Global entry number of the first entry
+        long long fNEntries = 0;
+        long long fTTreeEntry = 0;      // Local entry number of the first entry in the TTree file
+        long long fRNTupleEntry = 0;    // Local entry number of the first entry in the RNTuple file
+    };
+
+    /**
+     * @brief Outcome of comparing a chain of TTree files with a sequence of RNTuple files.
+     */
+    struct ChainResult {
+        bool fPassed = false;
+        long long fTTreeEntries = 0;
+        long long fRNTupleEntries = 0;
+        std::size_t fNSegments = 0;
+        std::size_t fNColumns = 0;          // Scalar columns compared value by value
+        std::vector<std::string> fIssues;
+        double fSeconds = 0;
+    };
+
+    /**
+     * @brief Expands a file list given on the command line.
+     *
+     * The list is either comma-separated, or `@<file>` naming a text file with one path per line (`#` starts a
+     * comment). Entries containing `*` are expanded with glob(3), in sorted order.
+     *
+     * @throws std::runtime_error if a list file cannot be read or the list is empty.
+     */
+    std::vector<std::string> ReadFileList(const std::string& list);
+
+    /**
+     * @brief Splits the global entry range of two chains at every file boundary of either side.
+     *
+     * Each entry of the result lies in exactly one file on both sides; entries beyond the end of the shorter
+     * chain are not covered.
+     *
+     * @param ttreeEntries Number of entries in each TTree file, in chain order.
+     * @param rntupleEntries Number of entries in each RNTuple file, in chain order.
+     */
+    std::vector<ChainSegment> MapChainEntries(const std::vector<long long>& ttreeEntries, const std::vector<long long>& rntupleEntries);
+
+    /**
+     * @brief Compares a chain of TTree files entry by entry with a sequence of RNTuple files.
+     *
+     * The file boundaries of the two sides need not line up. After checking that the first files of both sides
+     * have the same fields and types, every scalar column is compared value by value. The segments of
+     * MapChainEntries are handed to nThreads workers, each with its own TTree and RNTupleReader per file.
+     *
+     * @param nThreads Number of worker threads; 0 uses one per hardware thread.
+     * @param checkpoint If set, segments recorded in it are not compared again and every compared segment is
+     *                   recorded with its differences.
+     */
+    ChainResult CompareChains(const std::vector<std::string>& ttreeFiles, const std::vector<std::string>& rntupleFiles,
+                              const std::string& ttreeName, const std::string& rntupleName, unsigned nThreads = 0,
+                              Checkpoint* checkpoint = nullptr);
+
+} // namespace Checker
+
+#endif // CHECKERCHAIN_HXX
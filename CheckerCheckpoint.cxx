@@ -0,0 +1,172 @@
+/// \file CheckerCheckpoint.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerCheckpoint.hxx"
+#include "CheckerFilePool.hxx"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Checker {
+
+    namespace {
+
+        const char* const kHeader = "RNTupleTTreeChecker checkpoint";
+
+        // Fields are separated by tabs and records by newlines, so both are escaped inside a field
+        std::string Escape(const std::string& text) {
+            std::string escaped;
+            for (char c : text) {
+                if (c == '\\') escaped += "\\\\";
+                else if (c == '\t') escaped += "\\t";
+                else if (c == '\n') escaped += "\\n";
+                else escaped += c;
+            }
+            return escaped;
+        }
+
+        std::vector<std::string> SplitLine(const std::string& line) {
+            std::vector<std::string> fields(1);
+            for (std::size_t i = 0; i < line.size(); ++i) {
+                if (line[i] == '\t') {
+                    fields.emplace_back();
+                }
+                else if (line[i] == '\\' && i + 1 < line.size()) {
+                    const char next = line[++i];
+                    fields.back() += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+                }
+                else {
+                    fields.back() += line[i];
+                }
+            }
+            return fields;
+        }
+
+    } // namespace
+
+    Checkpoint::Checkpoint(const std::string& path, const std::string& fingerprint, double flushSeconds)
+        : fPath(path), fFingerprint(fingerprint), fFlushSeconds(flushSeconds), fLastFlush(std::chrono::steady_clock::now()) {
+        std::ifstream file(path);
+        if (!file) {
+            return; // A fresh run
+        }
+
+        std::string line;
+        if (!std::getline(file, line)) {
+            return;
+        }
+        const auto header = SplitLine(line);
+        if (header.size() != 2 || header[0] != kHeader) {
+            throw std::runtime_error("Not a checkpoint file: " + path);
+        }
+        if (header[1] != fingerprint) {
+            std::cerr << "Checkpoint " << path << " belongs to other inputs or files changed since; starting over" << std::endl;
+            return;
+        }
+
+        while (std::getline(file, line)) {
+            auto fields = SplitLine(line);
+            const std::string key = fields.front();
+            fields.erase(fields.begin());
+            fRecords[key] = std::move(fields);
+        }
+        fNRestored = fRecords.size();
+    }
+
+    Checkpoint::~Checkpoint() {
+        try {
+            Flush();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cannot write checkpoint: " << e.what() << std::endl;
+        }
+    }
+
+    std::string Checkpoint::Fingerprint(const std::vector<std::string>& files, const std::string& options) {
+        std::ostringstream fingerprint;
+        fingerprint << options;
+        for (const auto& file : files) {
+            const auto stamp = FilePool::Stamp(file);
+            fingerprint << ' ' << file << '@' << stamp.first << ':' << stamp.second;
+        }
+        return fingerprint.str();
+    }
+
+    bool Checkpoint::Find(const std::string& key, std::vector<std::string>& fields) const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        auto it = fRecords.find(key);
+        if (it == fRecords.end()) {
+            return false;
+        }
+        fields = it->second;
+        return true;
+    }
+
+    void Checkpoint::Record(const std::string& key, const std::vector<std::string>& fields) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fRecords[key] = fields;
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - fLastFlush).count() < fFlushSeconds) {
+            return;
+        }
+        try {
+            WriteLocked();
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl; // Keep checking; the next write may succeed
+        }
+    }
+
+    void Checkpoint::Flush() {
+        std::lock_guard<std::mutex> lock(fMutex);
+        WriteLocked();
+    }
+
+    void Checkpoint::Remove() {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fRemoved = true;
+        std::remove(fPath.c_str());
+    }
+
+    void Checkpoint::WriteLocked() {
+        fLastFlush = std::chrono::steady_clock::now();
+        if (fRemoved) {
+            return;
+        }
+
+        // Write aside and rename, so that a crash during the write leaves the previous checkpoint intact
+        const std::string temporary = fPath + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << Escape(kHeader) << '\t' << Escape(fFingerprint) << '\n';
+            for (const auto& record : fRecords) {
+                file << Escape(record.first);
+                for (const auto& field : record.second) {
+                    file << '\t' << Escape(field);
+                }
+                file << '\n';
+            }
+            if (!file.flush()) {
+                throw std::runtime_error("Cannot write checkpoint: " + temporary);
+            }
+        }
+        if (std::rename(temporary.c_str(), fPath.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace checkpoint: " + fPath);
+        }
+    }
+
+} // namespace Checker
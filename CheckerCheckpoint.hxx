@@ -0,0 +1,103 @@
+/// \file CheckerCheckpoint.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERCHECKPOINT_HXX
+#define CHECKERCHECKPOINT_HXX
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Progress of a long verification, kept on disk so that an interrupted run can resume.
+     *
+     * The kernels record every finished unit of work, e.g. a pair of a batch, a segment of a chain or a column
+     * range of a source comparison, under a key together with its outcome. The checkpoint file is rewritten
+     * (to a temporary file that is then renamed over it) at most every flushSeconds and when the checkpoint is
+     * destroyed, so a killed run loses at most that much work.
+     *
+     * A run resumes from an existing file only if its fingerprint matches, i.e. if the same inputs are checked
+     * in the same way and no input file changed since; otherwise the old progress is discarded.
+     */
+    class Checkpoint {
+    public:
+        /**
+         * @param path Checkpoint file, read if it exists.
+         * @param fingerprint Identifies the run, see Fingerprint().
+         * @param flushSeconds Minimum time between two writes of the file by Record().
+         * @throws std::runtime_error if the file exists but cannot be read.
+         */
+        Checkpoint(const std::string& path, const std::string& fingerprint, double flushSeconds = 30);
+        ~Checkpoint();
+
+        Checkpoint(const Checkpoint&) = delete;
+        Checkpoint& operator=(const Checkpoint&) = delete;
+
+        /**
+         * @brief Returns the fingerprint of a run over the given files, including their modification times and
+         *        sizes, and a description of what is checked.
+         */
+        static std::string Fingerprint(const std::vector<std::string>& files, const std::string& options);
+
+        /**
+         * @brief Looks up a finished unit of work. Safe to call from several threads.
+         *
+         * @return True and the recorded fields if the unit was finished before.
+         */
+        bool Find(const std::string& key, std::vector<std::string>& fields) const;
+
+        /**
+         * @brief Records a finished unit of work and writes the file if flushSeconds have passed since the last
+         *        write. Safe to call from several threads; a failed write is reported on stderr.
+         */
+        void Record(const std::string& key, const std::vector<std::string>& fields);
+
+        /**
+         * @brief Writes the file now.
+         *
+         * @throws std::runtime_error if the file cannot be written.
+         */
+        void Flush();
+
+        /**
+         * @brief Deletes the file once the run is complete; nothing is written afterwards.
+         */
+        void Remove();
+
+        /// Number of units of work restored from the file
+        std::size_t GetNRestored() const { return fNRestored; }
+
+    private:
+        void WriteLocked();
+
+        std::string fPath;
+        std::string fFingerprint;
+        double fFlushSeconds;
+        bool fRemoved = false;
+        std::size_t fNRestored = 0;
+        std::chrono::steady_clock::time_point fLastFlush;
+
+        mutable std::mutex fMutex;
+        std::map<std::string, std::vector<std::string>> fRecords;
+    };
+
+} // namespace Checker
+
+#endif // CHECKERCHECKPOINT_HXX
@@ -0,0 +1,47 @@
+/// \file CheckerComparators.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerComparators.hxx"
+
+#include <fnmatch.h>
+
+namespace Checker {
+
+    ComparatorRegistry& ComparatorRegistry::Instance() {
+        static ComparatorRegistry registry;
+        return registry;
+    }
+
+    void ComparatorRegistry::Register(std::shared_ptr<const CustomComparator> comparator) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fComparators.push_back(std::move(comparator));
+    }
+
+    std::shared_ptr<const CustomComparator> ComparatorRegistry::Find(const std::string& typeName) const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        for (auto it = fComparators.rbegin(); it != fComparators.rend(); ++it) {
+            if (fnmatch((*it)->fTypePattern.c_str(), typeName.c_str(), 0) == 0) {
+                return *it;
+            }
+        }
+        return nullptr;
+    }
+
+    void ComparatorRegistry::Clear() {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fComparators.clear();
+    }
+
+} // namespace Checker
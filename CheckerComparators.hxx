@@ -0,0 +1,158 @@
+/// \file CheckerComparators.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERCOMPARATORS_HXX
+#define CHECKERCOMPARATORS_HXX
+
+#include "CheckerBuffers.hxx"
+#include "CheckerScan.hxx"
+#include "CheckerSource.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief How the scan compares, hashes and counts the values of a column type the Checker does not know.
+     *
+     * Each function gets a whole batch of up to kBatchEntries values of one column, never a single entry.
+     */
+    template <typename T>
+    struct TypeComparator {
+        // Offset of the first entry at which two batches of the same size differ, or -1
+        std::function<long long(const std::vector<T>&, const std::vector<T>&)> fCompare;
+        // Hash of a value; without fCompare, two values are equal if their hashes are
+        std::function<std::uint64_t(const T&)> fHash;
+        // Adds a batch of values to the statistics of their column; optional
+        std::function<void(const std::vector<T>&, ScanStatistics&)> fAccumulate;
+    };
+
+    /**
+     * @brief A TypeComparator with its type erased, as the scan calls it.
+     */
+    struct CustomComparator {
+        std::string fTypePattern;
+        // Reads entries [first, first + n) of a column from both sources, adds them to the statistics that are set,
+        // and returns the offset of the first difference, or -1
+        std::function<long long(ColumnSource&, ColumnSource&, const std::string&, long long, long long, ScanStatistics*, ScanStatistics*)> fCompare;
+        // Reads entries [first, first + n) of a column from one source into its statistics; empty without fAccumulate
+        std::function<void(ColumnSource&, const std::string&, long long, long long, ScanStatistics&)> fAccumulate;
+    };
+
+    /**
+     * @brief Process-wide list of the custom comparators, searched by stored type name.
+     */
+    class ComparatorRegistry {
+    public:
+        static ComparatorRegistry& Instance();
+
+        void Register(std::shared_ptr<const CustomComparator> comparator);
+
+        /**
+         * @brief Returns the comparator registered last whose pattern matches a stored type name, e.g. "MyHit",
+         *        or nullptr.
+         */
+        std::shared_ptr<const CustomComparator> Find(const std::string& typeName) const;
+
+        void Clear();
+
+    private:
+        mutable std::mutex fMutex;
+        std::vector<std::shared_ptr<const CustomComparator>> fComparators;
+    };
+
+    namespace Detail {
+        template <typename T, typename = void>
+        struct HasEqual : std::false_type {};
+        template <typename T>
+        struct HasEqual<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>> : std::true_type {};
+    } // namespace Detail
+
+    /**
+     * @brief Replaces the content of values with entries [first, first + n) of a column whose stored type is T.
+     */
+    template <typename T>
+    void ReadObjects(ColumnSource& source, const std::string& column, long long first, long long n, std::vector<T>& values) {
+        values.clear();
+        source.ReadObjects(column, first, n, [&](const void* object) { values.push_back(*static_cast<const T*>(object)); });
+    }
+
+    /**
+     * @brief Registers how the scan compares the columns whose stored type matches typePattern, a type name or
+     *        shell pattern, in both files. The columns are read as T.
+     *
+     * Only types the Checker has no comparison of its own for are looked up; both files then need a type that
+     * matches the same registration. Without fCompare, values are compared by fHash, or else by operator==.
+     * Columns with an fAccumulate get statistics of their own in ScanResult::fColumnStatistics.
+     *
+     * @throws std::runtime_error if neither fCompare nor fHash is set and T has no operator==.
+     */
+    template <typename T>
+    void RegisterComparator(const std::string& typePattern, TypeComparator<T> comparator = TypeComparator<T>()) {
+        if (!comparator.fCompare && comparator.fHash) {
+            comparator.fCompare = [hash = comparator.fHash](const std::vector<T>& a, const std::vector<T>& b) -> long long {
+                for (std::size_t k = 0; k < a.size(); ++k) {
+                    if (hash(a[k]) != hash(b[k])) return static_cast<long long>(k);
+                }
+                return -1;
+            };
+        }
+        if constexpr (Detail::HasEqual<T>::value) {
+            if (!comparator.fCompare) {
+                comparator.fCompare = [](const std::vector<T>& a, const std::vector<T>& b) -> long long {
+                    const auto diff = std::mismatch(a.begin(), a.end(), b.begin(), b.end());
+                    return diff.first == a.end() && diff.second == b.end() ? -1 : diff.first - a.begin();
+                };
+            }
+        }
+        if (!comparator.fCompare) {
+            throw std::runtime_error("Comparator for " + typePattern + " needs fCompare or fHash: the type has no operator==");
+        }
+
+        auto erased = std::make_shared<CustomComparator>();
+        erased->fTypePattern = typePattern;
+        erased->fCompare = [comparator](ColumnSource& a, ColumnSource& b, const std::string& column, long long first, long long n,
+                                        ScanStatistics* statisticsA, ScanStatistics* statisticsB) {
+            PooledBuffer<T> valuesA;
+            PooledBuffer<T> valuesB;
+            ReadObjects(a, column, first, n, *valuesA);
+            ReadObjects(b, column, first, n, *valuesB);
+            if (comparator.fAccumulate && statisticsA) comparator.fAccumulate(*valuesA, *statisticsA);
+            if (comparator.fAccumulate && statisticsB) comparator.fAccumulate(*valuesB, *statisticsB);
+            return comparator.fCompare(*valuesA, *valuesB);
+        };
+        if (comparator.fAccumulate) {
+            erased->fAccumulate = [accumulate = comparator.fAccumulate](ColumnSource& source, const std::string& column, long long first,
+                                                                        long long n, ScanStatistics& statistics) {
+                PooledBuffer<T> values;
+                ReadObjects(source, column, first, n, *values);
+                accumulate(*values, statistics);
+            };
+        }
+        ComparatorRegistry::Instance().Register(std::move(erased));
+    }
+
+} // namespace Checker
+
+#endif // CHECKERCOMPARATORS_HXX
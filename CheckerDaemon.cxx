@@ -0,0 +1,320 @@
+/// \file CheckerDaemon.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerDaemon.hxx"
+
+#include <TROOT.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Checker {
+
+    namespace {
+
+        // Results kept before the cache is dropped and filled again
+        constexpr std::size_t kMaxCached = 1 << 16;
+
+        sockaddr_un MakeAddress(const std::string& socketPath) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (socketPath.size() >= sizeof(address.sun_path)) {
+                throw std::runtime_error("Socket path too long: " + socketPath);
+            }
+            std::strcpy(address.sun_path, socketPath.c_str());
+            return address;
+        }
+
+        bool WriteAll(int fd, const std::string& data) {
+            for (std::size_t written = 0; written < data.size();) {
+                const ssize_t n = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                written += n;
+            }
+            return true;
+        }
+
+        // Calls fn for every complete line read from fd, and for a last line without newline at the end
+        template <typename Fn>
+        void ForEachLine(int fd, Fn&& fn) {
+            std::string buffer;
+            char chunk[4096];
+            while (true) {
+                const ssize_t n = read(fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    break;
+                }
+                buffer.append(chunk, n);
+                for (std::size_t pos = buffer.find('\n'); pos != std::string::npos; pos = buffer.find('\n')) {
+                    std::string line = buffer.substr(0, pos);
+                    buffer.erase(0, pos + 1);
+                    if (!line.empty() && line.back() == '\r') {
+                        line.pop_back();
+                    }
+                    if (!fn(line)) {
+                        return;
+                    }
+                }
+            }
+            if (!buffer.empty()) {
+                fn(buffer);
+            }
+        }
+
+        std::string FormatResult(const PairResult& result, bool cached) {
+            std::vector<std::string> messages;
+            if (!result.fError.empty()) messages.push_back(result.fError);
+            messages.insert(messages.end(), result.fIssues.begin(), result.fIssues.end());
+            messages.insert(messages.end(), result.fWarnings.begin(), result.fWarnings.end());
+
+            std::ostringstream response;
+            response << (!result.fError.empty() ? "ERROR" : result.fPassed ? "PASS" : "FAIL") << '\t'
+                     << result.fPair.fTTreeFile << '\t' << result.fPair.fRNTupleFile << '\t'
+                     << result.fPair.fTTreeName << '\t' << result.fPair.fRNTupleName << '\t'
+                     << std::fixed << std::setprecision(3) << result.fSeconds << '\t' << (cached ? 1 : 0) << '\t';
+            for (std::size_t i = 0; i < messages.size(); ++i) {
+                response << (i ? "; " : "") << messages[i];
+            }
+            return response.str();
+        }
+
+    } // namespace
+
+    Daemon::Daemon(const std::string& socketPath, unsigned maxJobs)
+        : fSocketPath(socketPath), fMaxJobs(maxJobs ? maxJobs : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    Daemon::~Daemon() {
+        Stop();
+        for (auto& connection : fConnections) {
+            if (connection.second.joinable()) {
+                connection.second.join();
+            }
+        }
+    }
+
+    void Daemon::Serve() {
+        ROOT::EnableThreadSafety();
+
+        const sockaddr_un address = MakeAddress(fSocketPath);
+        const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+        }
+        unlink(fSocketPath.c_str());
+        if (bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 64) != 0) {
+            const std::string error = std::strerror(errno);
+            close(listenFd);
+            throw std::runtime_error("Cannot listen on socket: " + fSocketPath + ": " + error);
+        }
+        fListenFd = listenFd;
+
+        while (!fStop) {
+            const int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR && !fStop) {
+                    continue;
+                }
+                break; // Stop() shut the socket down
+            }
+
+            // Threads of connections that have closed are joined here, so that a long-running daemon does not keep them
+            std::vector<std::thread> finished;
+            {
+                std::lock_guard<std::mutex> lock(fConnectionMutex);
+                for (const std::size_t connection : fFinishedConnections) {
+                    auto it = fConnections.find(connection);
+                    finished.push_back(std::move(it->second));
+                    fConnections.erase(it);
+                }
+                fFinishedConnections.clear();
+                fConnectionFds.insert(fd);
+                const std::size_t connection = fNConnections++;
+                fConnections.emplace(connection, std::thread(&Daemon::ServeConnection, this, fd, connection));
+            }
+            for (auto& thread : finished) {
+                thread.join();
+            }
+        }
+
+        // Wake connections blocked in read, then wait for them
+        std::map<std::size_t, std::thread> connections;
+        {
+            std::lock_guard<std::mutex> lock(fConnectionMutex);
+            for (int fd : fConnectionFds) {
+                shutdown(fd, SHUT_RDWR);
+            }
+            connections.swap(fConnections);
+        }
+        for (auto& connection : connections) {
+            connection.second.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(fConnectionMutex);
+            fFinishedConnections.clear(); // Connections that finished while being joined above
+        }
+
+        fListenFd = -1;
+        close(listenFd);
+        unlink(fSocketPath.c_str());
+    }
+
+    void Daemon::Stop() {
+        fStop = true;
+        const int listenFd = fListenFd;
+        if (listenFd >= 0) {
+            shutdown(listenFd, SHUT_RDWR); // Makes accept() in Serve() return
+        }
+    }
+
+    void Daemon::ServeConnection(int fd, std::size_t connection) {
+        ForEachLine(fd, [&](const std::string& line) {
+            if (line.find_first_not_of(" \t") == std::string::npos) {
+                return true;
+            }
+            return WriteAll(fd, HandleRequest(line) + "\n") && !fStop;
+        });
+
+        std::lock_guard<std::mutex> lock(fConnectionMutex);
+        fConnectionFds.erase(fd);
+        close(fd);
+        fFinishedConnections.push_back(connection);
+    }
+
+    std::string Daemon::HandleRequest(const std::string& request) {
+        std::istringstream columns(request);
+        std::vector<std::string> fields;
+        for (std::string field; columns >> field;) {
+            fields.push_back(field);
+        }
+
+        if (fields.size() == 1 && fields[0] == "PING") {
+            return "OK\tPONG";
+        }
+        if (fields.size() == 1 && fields[0] == "STATS") {
+            std::lock_guard<std::mutex> lock(fCacheMutex);
+            return "OK\trequests=" + std::to_string(fNRequests) + " cache_hits=" + std::to_string(fNCacheHits)
+                   + " cached=" + std::to_string(fCache.size()) + " files_open=" + std::to_string(FilePool::Instance().GetNFiles());
+        }
+        if (fields.size() == 1 && fields[0] == "SHUTDOWN") {
+            Stop();
+            return "OK\tBYE";
+        }
+        if (fields.size() != 4) {
+            return "ERROR\texpected <ttreeFile> <rntupleFile> <ttreeName> <rntupleName>, PING, STATS or SHUTDOWN";
+        }
+
+        bool cached = false;
+        const PairResult result = CheckCached({ fields[0], fields[1], fields[2], fields[3] }, cached);
+        return FormatResult(result, cached);
+    }
+
+    std::size_t Daemon::GetNCached() const {
+        std::lock_guard<std::mutex> lock(fCacheMutex);
+        return fCache.size();
+    }
+
+    PairResult Daemon::CheckCached(const PairSpec& pair, bool& cached) {
+        const auto ttreeStamp = FilePool::Stamp(pair.fTTreeFile);
+        const auto rntupleStamp = FilePool::Stamp(pair.fRNTupleFile);
+        const CacheKey key{ pair.fTTreeFile, pair.fRNTupleFile, pair.fTTreeName, pair.fRNTupleName, ttreeStamp, rntupleStamp };
+        {
+            std::lock_guard<std::mutex> lock(fCacheMutex);
+            ++fNRequests;
+            auto it = fCache.find(key);
+            if (it != fCache.end()) {
+                ++fNCacheHits;
+                cached = true;
+                return it->second;
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(fJobMutex);
+            fJobDone.wait(lock, [&]() { return fRunningJobs < fMaxJobs; });
+            ++fRunningJobs;
+        }
+        PairResult result = CheckPair(pair);
+        {
+            std::lock_guard<std::mutex> lock(fJobMutex);
+            --fRunningJobs;
+        }
+        fJobDone.notify_one();
+
+        // Errors are not cached (the file may still be being written), nor are files without a stamp
+        const FilePool::FileStamp none{ 0, 0 };
+        if (result.fError.empty() && ttreeStamp != none && rntupleStamp != none) {
+            std::lock_guard<std::mutex> lock(fCacheMutex);
+            if (fCache.size() >= kMaxCached) {
+                fCache.clear();
+            }
+            fCache[key] = result;
+        }
+        cached = false;
+        return result;
+    }
+
+    bool SubmitJobs(const std::string& socketPath, const std::vector<PairSpec>& pairs, std::ostream& out) {
+        const sockaddr_un address = MakeAddress(socketPath);
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            const std::string error = std::strerror(errno);
+            if (fd >= 0) close(fd);
+            throw std::runtime_error("Cannot connect to daemon at " + socketPath + ": " + error);
+        }
+
+        // The requests are written by a thread of their own while the responses are read here, in the same order.
+        // Writing them all before reading would fill both socket buffers on a long manifest and block both ends.
+        std::string requests;
+        for (const auto& pair : pairs) {
+            requests += pair.fTTreeFile + " " + pair.fRNTupleFile + " " + pair.fTTreeName + " " + pair.fRNTupleName + "\n";
+        }
+        bool sent = false;
+        std::thread writer([&]() {
+            sent = WriteAll(fd, requests);
+            shutdown(fd, SHUT_WR);
+        });
+
+        std::size_t nResponses = 0;
+        std::size_t nPassed = 0;
+        ForEachLine(fd, [&](const std::string& line) {
+            out << line << std::endl;
+            ++nResponses;
+            if (line.compare(0, 5, "PASS\t") == 0) ++nPassed;
+            return true;
+        });
+        writer.join();
+        close(fd);
+        if (!sent) {
+            throw std::runtime_error("Cannot send jobs to daemon at " + socketPath);
+        }
+        return nResponses == pairs.size() && nPassed == pairs.size();
+    }
+
+} // namespace Checker
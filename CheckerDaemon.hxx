@@ -0,0 +1,122 @@
+/// \file CheckerDaemon.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERDAEMON_HXX
+#define CHECKERDAEMON_HXX
+
+#include "CheckerBatch.hxx"
+#include "CheckerFilePool.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Resident verification server listening on a Unix domain socket.
+     *
+     * Clients send one request per line and get one response line per request, in order, as soon as it is
+     * done. A request is either a pair, in manifest syntax (`<ttreeFile> <rntupleFile> <ttreeName> <rntupleName>`),
+     * or one of the commands `PING`, `STATS` and `SHUTDOWN`. A pair is answered with tab-separated fields:
+     *
+     *     PASS|FAIL|ERROR <ttreeFile> <rntupleFile> <ttreeName> <rntupleName> <seconds> <cached 0|1> <messages>
+     *
+     * where the messages are the issues, warnings or error of the pair joined by "; ".
+     *
+     * The ROOT libraries, the FilePool and the results stay loaded between requests. Results are cached by pair
+     * and by the modification time and size of both files, so a repeated check of unchanged files is answered
+     * without reading them. Each connection is served by its own thread, which is joined once the connection has
+     * closed and the next one is accepted; at most GetMaxJobs() pairs are checked at the same time.
+     */
+    class Daemon {
+    public:
+        /**
+         * @param socketPath Path of the socket file; an existing file at that path is replaced.
+         * @param maxJobs Pairs checked at the same time over all connections; 0 uses one per hardware thread.
+         */
+        explicit Daemon(const std::string& socketPath, unsigned maxJobs = 0);
+        ~Daemon();
+
+        Daemon(const Daemon&) = delete;
+        Daemon& operator=(const Daemon&) = delete;
+
+        /**
+         * @brief Accepts and serves connections until Stop() is called or a client sends SHUTDOWN.
+         *
+         * @throws std::runtime_error if the socket cannot be created.
+         */
+        void Serve();
+
+        /**
+         * @brief Makes Serve() return after closing all connections. Safe to call from any thread.
+         */
+        void Stop();
+
+        /**
+         * @brief Answers one request line, as Serve() does for every line of a connection.
+         */
+        std::string HandleRequest(const std::string& request);
+
+        unsigned GetMaxJobs() const { return fMaxJobs; }
+        /// Number of pair results currently cached
+        std::size_t GetNCached() const;
+
+    private:
+        using CacheKey = std::tuple<std::string, std::string, std::string, std::string, FilePool::FileStamp, FilePool::FileStamp>;
+
+        void ServeConnection(int fd, std::size_t connection);
+        PairResult CheckCached(const PairSpec& pair, bool& cached);
+
+        std::string fSocketPath;
+        unsigned fMaxJobs;
+        std::atomic<int> fListenFd{ -1 };
+        std::atomic<bool> fStop{ false };
+
+        std::mutex fConnectionMutex;
+        std::set<int> fConnectionFds;
+        std::map<std::size_t, std::thread> fConnections; // By connection number
+        std::vector<std::size_t> fFinishedConnections;  // Served to the end, to be joined by Serve()
+        std::size_t fNConnections = 0;
+
+        std::mutex fJobMutex;
+        std::condition_variable fJobDone;
+        unsigned fRunningJobs = 0;
+
+        mutable std::mutex fCacheMutex;
+        std::map<CacheKey, PairResult> fCache;
+        std::size_t fNRequests = 0;
+        std::size_t fNCacheHits = 0;
+    };
+
+    /**
+     * @brief Sends the pairs to a running Daemon and writes each response line to out as it arrives.
+     *
+     * @return True if every pair passed.
+     * @throws std::runtime_error if the daemon cannot be reached.
+     */
+    bool SubmitJobs(const std::string& socketPath, const std::vector<PairSpec>& pairs, std::ostream& out);
+
+} // namespace Checker
+
+#endif // CHECKERDAEMON_HXX
@@ -0,0 +1,393 @@
+/// \file CheckerExpression.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerExpression.hxx"
+#include "CheckerBuffers.hxx"
+#include "CheckerSource.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace Checker {
+
+    namespace {
+
+        // The loop of one operation over a batch; a and b are arrays unless null, in which case their constants are used
+        template <typename F>
+        void Loop(const double* a, double aConstant, const double* b, double bConstant, double* out, std::size_t n, F f) {
+            if (a && b) {
+                for (std::size_t k = 0; k < n; ++k) out[k] = f(a[k], b[k]);
+            }
+            else if (a) {
+                for (std::size_t k = 0; k < n; ++k) out[k] = f(a[k], bConstant);
+            }
+            else if (b) {
+                for (std::size_t k = 0; k < n; ++k) out[k] = f(aConstant, b[k]);
+            }
+            else {
+                std::fill(out, out + n, f(aConstant, bConstant));
+            }
+        }
+
+        template <typename T>
+        void ReadAs(ColumnSource& source, const std::string& column, long long first, long long n, std::vector<double>& values) {
+            PooledBuffer<T> read;
+            source.Read(column, first, n, *read);
+            values.assign(read->begin(), read->end());
+        }
+
+        std::string FormatConstant(double value) {
+            std::ostringstream text;
+            text.precision(17);
+            text << value;
+            return value < 0 ? "(" + text.str() + ")" : text.str();
+        }
+
+    } // namespace
+
+    /**
+     * @brief Recursive descent parser emitting the postfix program of an Expression.
+     *
+     *     sum     := product (('+' | '-') product)*
+     *     product := unary (('*' | '/') unary)*
+     *     unary   := ('-' | '+') unary | primary
+     *     primary := number | function '(' sum (',' sum)? ')' | column | '(' sum ')'
+     */
+    class ExpressionParser {
+    public:
+        using OpCode = Expression::OpCode;
+
+        static const std::vector<std::pair<std::string, OpCode>>& GetFunctions() {
+            static const std::vector<std::pair<std::string, OpCode>> functions = {
+                { "sqrt", OpCode::kSqrt }, { "fabs", OpCode::kFabs }, { "exp", OpCode::kExp }, { "log", OpCode::kLog },
+                { "sin", OpCode::kSin }, { "cos", OpCode::kCos }, { "tan", OpCode::kTan }, { "pow", OpCode::kPow },
+                { "atan2", OpCode::kAtan2 }, { "hypot", OpCode::kHypot } };
+            return functions;
+        }
+
+        explicit ExpressionParser(Expression& expression) : fExpression(expression) {}
+
+        void Parse() {
+            Tokenize();
+            if (fTokens.empty()) {
+                Fail("empty expression");
+            }
+            ParseSum();
+            if (fPosition < fTokens.size()) {
+                Fail("unexpected '" + fTokens[fPosition] + "'");
+            }
+
+            // Stack depth of the program, for the registers of Evaluate
+            std::size_t depth = 0;
+            for (const auto& instruction : fExpression.fProgram) {
+                depth = depth + 1 - Expression::GetArity(instruction.fCode);
+                fExpression.fDepth = std::max(fExpression.fDepth, depth);
+            }
+        }
+
+    private:
+        Expression& fExpression;
+        std::vector<std::string> fTokens;
+        std::size_t fPosition = 0;
+
+        [[noreturn]] void Fail(const std::string& message) const {
+            throw std::runtime_error("Malformed expression '" + fExpression.fText + "': " + message);
+        }
+
+        const std::string& Peek() const {
+            static const std::string end;
+            return fPosition < fTokens.size() ? fTokens[fPosition] : end;
+        }
+
+        void Expect(const std::string& token) {
+            if (Peek() != token) {
+                Fail("expected '" + token + "'" + (Peek().empty() ? " at the end" : ", got '" + Peek() + "'"));
+            }
+            ++fPosition;
+        }
+
+        void Tokenize() {
+            const std::string& text = fExpression.fText;
+            std::size_t i = 0;
+            while (i < text.size()) {
+                const unsigned char c = text[i];
+                if (std::isspace(c)) {
+                    ++i;
+                }
+                else if (std::isdigit(c) || (c == '.' && i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1])))) {
+                    std::size_t length = 0;
+                    std::stod(text.substr(i), &length);
+                    fTokens.push_back(text.substr(i, length));
+                    i += length;
+                }
+                else if (std::isalpha(c) || c == '_') {
+                    const std::size_t start = i;
+                    while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) {
+                        ++i;
+                    }
+                    fTokens.push_back(text.substr(start, i - start));
+                }
+                else if (std::string("+-*/(),").find(c) != std::string::npos) {
+                    fTokens.push_back(std::string(1, c));
+                    ++i;
+                }
+                else {
+                    Fail(std::string("unexpected character '") + text[i] + "'");
+                }
+            }
+        }
+
+        // Appends an operation, folding it if all its operands are constants
+        void Emit(OpCode code) {
+            auto& program = fExpression.fProgram;
+            const std::size_t arity = Expression::GetArity(code);
+            const bool constant = program.size() >= arity
+                                  && std::all_of(program.end() - arity, program.end(),
+                                                 [](const Expression::Instruction& instruction) { return instruction.fCode == OpCode::kConstant; });
+            if (!constant) {
+                program.push_back({ code, 0, 0 });
+                return;
+            }
+            const double a = program[program.size() - arity].fConstant;
+            const double b = arity == 2 ? program.back().fConstant : 0;
+            double folded = 0;
+            Expression::Run(code, nullptr, a, nullptr, b, &folded, 1);
+            program.resize(program.size() - arity);
+            program.push_back({ OpCode::kConstant, 0, folded });
+        }
+
+        void ParseSum() {
+            ParseProduct();
+            while (Peek() == "+" || Peek() == "-") {
+                const OpCode code = fTokens[fPosition++] == "+" ? OpCode::kAdd : OpCode::kSubtract;
+                ParseProduct();
+                Emit(code);
+            }
+        }
+
+        void ParseProduct() {
+            ParseUnary();
+            while (Peek() == "*" || Peek() == "/") {
+                const OpCode code = fTokens[fPosition++] == "*" ? OpCode::kMultiply : OpCode::kDivide;
+                ParseUnary();
+                Emit(code);
+            }
+        }
+
+        void ParseUnary() {
+            if (Peek() == "-") {
+                ++fPosition;
+                ParseUnary();
+                Emit(OpCode::kNegate);
+            }
+            else if (Peek() == "+") {
+                ++fPosition;
+                ParseUnary();
+            }
+            else {
+                ParsePrimary();
+            }
+        }
+
+        void ParsePrimary() {
+            const std::string token = Peek();
+            if (token.empty()) {
+                Fail("unexpected end");
+            }
+            ++fPosition;
+            const unsigned char c = token[0];
+            if (token == "(") {
+                ParseSum();
+                Expect(")");
+            }
+            else if (std::isdigit(c) || c == '.') {
+                fExpression.fProgram.push_back({ OpCode::kConstant, 0, std::stod(token) });
+            }
+            else if (std::isalpha(c) || c == '_') {
+                if (Peek() == "(") {
+                    ParseCall(token);
+                    return;
+                }
+                auto& columns = fExpression.fColumns;
+                const std::size_t index = std::find(columns.begin(), columns.end(), token) - columns.begin();
+                if (index == columns.size()) {
+                    columns.push_back(token);
+                }
+                fExpression.fProgram.push_back({ OpCode::kColumn, index, 0 });
+            }
+            else {
+                Fail("expected a column, number or '(', got '" + token + "'");
+            }
+        }
+
+        void ParseCall(const std::string& name) {
+            const auto& functions = GetFunctions();
+            auto it = std::find_if(functions.begin(), functions.end(), [&](const auto& function) { return function.first == name; });
+            if (it == functions.end()) {
+                Fail("unknown function " + name);
+            }
+            Expect("(");
+            ParseSum();
+            if (Expression::GetArity(it->second) == 2) {
+                Expect(",");
+                ParseSum();
+            }
+            Expect(")");
+            Emit(it->second);
+        }
+    };
+
+    Expression::Expression(const std::string& text) : fText(text) {
+        ExpressionParser(*this).Parse();
+    }
+
+    std::size_t Expression::GetArity(OpCode code) {
+        switch (code) {
+        case OpCode::kColumn:
+        case OpCode::kConstant:
+            return 0;
+        case OpCode::kAdd:
+        case OpCode::kSubtract:
+        case OpCode::kMultiply:
+        case OpCode::kDivide:
+        case OpCode::kPow:
+        case OpCode::kAtan2:
+        case OpCode::kHypot:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+
+    void Expression::Run(OpCode code, const double* a, double aConstant, const double* b, double bConstant, double* out, std::size_t n) {
+        // One loop per operation, with the operation inlined so that the compiler can vectorize it
+        switch (code) {
+        case OpCode::kAdd: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return x + y; }); break;
+        case OpCode::kSubtract: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return x - y; }); break;
+        case OpCode::kMultiply: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return x * y; }); break;
+        case OpCode::kDivide: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return x / y; }); break;
+        case OpCode::kNegate: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return -x; }); break;
+        case OpCode::kSqrt: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::sqrt(x); }); break;
+        case OpCode::kFabs: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::fabs(x); }); break;
+        case OpCode::kExp: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::exp(x); }); break;
+        case OpCode::kLog: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::log(x); }); break;
+        case OpCode::kSin: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::sin(x); }); break;
+        case OpCode::kCos: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::cos(x); }); break;
+        case OpCode::kTan: Loop(a, aConstant, b, bConstant, out, n, [](double x, double) { return std::tan(x); }); break;
+        case OpCode::kPow: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return std::pow(x, y); }); break;
+        case OpCode::kAtan2: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return std::atan2(x, y); }); break;
+        case OpCode::kHypot: Loop(a, aConstant, b, bConstant, out, n, [](double x, double y) { return std::hypot(x, y); }); break;
+        case OpCode::kColumn:
+        case OpCode::kConstant:
+            break;
+        }
+    }
+
+    std::string Expression::ToCpp() const {
+        std::vector<std::string> stack;
+        for (const auto& instruction : fProgram) {
+            const std::size_t arity = GetArity(instruction.fCode);
+            std::string b = arity == 2 ? stack.back() : "";
+            if (arity == 2) stack.pop_back();
+            std::string a = arity > 0 ? stack.back() : "";
+            if (arity > 0) stack.pop_back();
+
+            switch (instruction.fCode) {
+            case OpCode::kColumn: stack.push_back("double(" + fColumns[instruction.fColumn] + ")"); break;
+            case OpCode::kConstant: stack.push_back(FormatConstant(instruction.fConstant)); break;
+            case OpCode::kAdd: stack.push_back("(" + a + " + " + b + ")"); break;
+            case OpCode::kSubtract: stack.push_back("(" + a + " - " + b + ")"); break;
+            case OpCode::kMultiply: stack.push_back("(" + a + " * " + b + ")"); break;
+            case OpCode::kDivide: stack.push_back("(" + a + " / " + b + ")"); break;
+            case OpCode::kNegate: stack.push_back("(-" + a + ")"); break;
+            default: {
+                const auto& functions = ExpressionParser::GetFunctions();
+                auto it = std::find_if(functions.begin(), functions.end(), [&](const auto& function) { return function.second == instruction.fCode; });
+                stack.push_back("std::" + it->first + "(" + a + (arity == 2 ? ", " + b : "") + ")");
+            }
+            }
+        }
+        return stack.empty() ? "" : stack.back();
+    }
+
+    std::size_t Expression::Evaluate(ColumnSource& source, const std::vector<std::string>& types, long long first, long long n,
+                                     std::vector<double>& values) const {
+        if (types.size() != fColumns.size()) {
+            throw std::runtime_error("Expression '" + fText + "' needs the type of each of its columns");
+        }
+        auto& pool = BufferPool<double>::ForThread();
+        const std::size_t size = static_cast<std::size_t>(std::max(0LL, n));
+
+        // Every column once, converted to double
+        std::vector<std::vector<double>> columns;
+        for (std::size_t c = 0; c < fColumns.size(); ++c) {
+            columns.push_back(pool.Acquire(size));
+            const std::string& type = types[c];
+            if (type == "int") ReadAs<int>(source, fColumns[c], first, n, columns.back());
+            else if (type == "float") ReadAs<float>(source, fColumns[c], first, n, columns.back());
+            else if (type == "double") ReadAs<double>(source, fColumns[c], first, n, columns.back());
+            else if (type == "bool") ReadAs<bool>(source, fColumns[c], first, n, columns.back());
+            else throw std::runtime_error("Expression column must be an int, float, double or bool column: " + fColumns[c] + " is " + type);
+        }
+
+        // One register per stack position; an operation writes to the register of its first operand
+        std::vector<std::vector<double>> registers;
+        for (std::size_t r = 0; r < fDepth; ++r) {
+            registers.push_back(pool.Acquire(size));
+            registers.back().resize(size);
+        }
+        struct Operand {
+            const double* fData; // Null for a constant
+            double fConstant;
+        };
+        std::vector<Operand> stack;
+        stack.reserve(fDepth);
+        for (const auto& instruction : fProgram) {
+            if (instruction.fCode == OpCode::kColumn) {
+                stack.push_back({ columns[instruction.fColumn].data(), 0 });
+                continue;
+            }
+            if (instruction.fCode == OpCode::kConstant) {
+                stack.push_back({ nullptr, instruction.fConstant });
+                continue;
+            }
+            Operand b{ nullptr, 0 };
+            if (GetArity(instruction.fCode) == 2) {
+                b = stack.back();
+                stack.pop_back();
+            }
+            const Operand a = stack.back();
+            stack.pop_back();
+            double* out = registers[stack.size()].data();
+            Run(instruction.fCode, a.fData, a.fConstant, b.fData, b.fConstant, out, size);
+            stack.push_back({ out, 0 });
+        }
+
+        if (stack.back().fData) {
+            values.assign(stack.back().fData, stack.back().fData + size);
+        }
+        else {
+            values.assign(size, stack.back().fConstant);
+        }
+        for (auto& buffer : columns) pool.Release(std::move(buffer));
+        for (auto& buffer : registers) pool.Release(std::move(buffer));
+        return columns.size();
+    }
+
+} // namespace Checker
@@ -0,0 +1,95 @@
+/// \file CheckerExpression.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKEREXPRESSION_HXX
+#define CHECKEREXPRESSION_HXX
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    class ColumnSource;
+    class ExpressionParser;
+
+    /**
+     * @brief An arithmetic expression of scalar columns, compiled once into a program of batch operations.
+     *
+     *     sqrt(px*px + py*py)
+     *
+     * The operators are +, -, * and / and the functions sqrt, fabs, exp, log, sin, cos, tan, pow, atan2 and
+     * hypot; all arithmetic is done in double. Every operation of the program runs over a whole batch of
+     * entries before the next one starts, so that each is a simple loop over arrays, and operations on
+     * constants only are folded when the expression is compiled.
+     */
+    class Expression {
+    public:
+        Expression() = default;
+
+        /**
+         * @throws std::runtime_error if the expression is malformed or calls an unknown function.
+         */
+        explicit Expression(const std::string& text);
+
+        const std::string& GetText() const { return fText; }
+
+        /**
+         * @brief Returns the columns the expression reads, each once, in the order they first appear.
+         */
+        const std::vector<std::string>& GetColumns() const { return fColumns; }
+
+        /**
+         * @brief Returns the compiled expression as C++, with the columns converted to double, e.g. for
+         *        RDataFrame::Define.
+         */
+        std::string ToCpp() const;
+
+        /**
+         * @brief Sets values[k] to the expression at entry first + k, for entries [first, first + n).
+         *
+         * @param types Common type (see MapFieldType) of each column of GetColumns in the source; int, float,
+         *              double or bool.
+         * @return The number of columns read.
+         */
+        std::size_t Evaluate(ColumnSource& source, const std::vector<std::string>& types, long long first, long long n,
+                             std::vector<double>& values) const;
+
+    private:
+        friend class ExpressionParser;
+
+        enum class OpCode { kColumn, kConstant, kAdd, kSubtract, kMultiply, kDivide, kNegate, kSqrt, kFabs, kExp, kLog,
+                            kSin, kCos, kTan, kPow, kAtan2, kHypot };
+
+        struct Instruction {
+            OpCode fCode = OpCode::kConstant;
+            std::size_t fColumn = 0; // Index into fColumns, for kColumn
+            double fConstant = 0;    // For kConstant
+        };
+
+        static std::size_t GetArity(OpCode code);
+
+        // out[k] = code(a[k], b[k]) for k < n; a null array stands for its constant, and b is unused by unary operations
+        static void Run(OpCode code, const double* a, double aConstant, const double* b, double bConstant, double* out, std::size_t n);
+
+        std::string fText;
+        std::vector<std::string> fColumns;
+        std::vector<Instruction> fProgram; // Postfix
+        std::size_t fDepth = 0;            // Largest number of operands on the stack
+    };
+
+} // namespace Checker
+
+#endif // CHECKEREXPRESSION_HXX
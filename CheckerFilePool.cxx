@@ -0,0 +1,191 @@
+/// \file CheckerFilePool.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerFilePool.hxx"
+
+#include <ROOT/RNTuple.hxx>
+#include <ROOT/RPageStorageFile.hxx>
+
+#include <stdexcept>
+#include <vector>
+#include <sys/stat.h>
+
+namespace Checker {
+
+    FilePool& FilePool::Instance() {
+        static FilePool* pool = new FilePool();
+        return *pool;
+    }
+
+    FilePool::FileStamp FilePool::Stamp(const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            return { 0, 0 };
+        }
+        return { static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec,
+                 static_cast<long long>(info.st_size) };
+    }
+
+    std::shared_ptr<TFile> FilePool::GetFile(const std::string& path) {
+        const FileStamp stamp = Stamp(path);
+        std::vector<std::unique_ptr<TFile>> closed; // Destroyed after the lock is released
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            std::unique_ptr<TFile> file;
+            for (auto it = fFiles.begin(); it != fFiles.end();) {
+                if (it->fPath != path) {
+                    ++it;
+                } else if (it->fStamp != stamp) {
+                    // The file changed on disk since it was opened
+                    closed.push_back(std::move(it->fFile));
+                    it = fFiles.erase(it);
+                } else if (!file) {
+                    file = std::move(it->fFile);
+                    it = fFiles.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (file) {
+                ++fNLent;
+                return Lend(path, stamp, std::move(file));
+            }
+        }
+
+        // Open outside the lock, so that other threads are not held up by the I/O
+        std::unique_ptr<TFile> file(TFile::Open(path.c_str()));
+        if (!file || file->IsZombie()) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(fMutex);
+        ++fNOpened;
+        ++fNLent;
+        return Lend(path, stamp, std::move(file));
+    }
+
+    std::shared_ptr<TFile> FilePool::Lend(const std::string& path, const FileStamp& stamp, std::unique_ptr<TFile> file) {
+        // Called with fMutex held. The pool is never destroyed, so the deleter may refer to it
+        return std::shared_ptr<TFile>(file.release(), [this, path, stamp, generation = fGeneration](TFile* released) {
+            Release(path, stamp, generation, std::unique_ptr<TFile>(released));
+        });
+    }
+
+    void FilePool::Release(const std::string& path, const FileStamp& stamp, std::size_t generation, std::unique_ptr<TFile> file) {
+        std::vector<std::unique_ptr<TFile>> closed; // Destroyed after the lock is released
+        std::lock_guard<std::mutex> lock(fMutex);
+        --fNLent;
+        if (fMaxFiles == 0 || generation != fGeneration) {
+            closed.push_back(std::move(file));
+            return;
+        }
+        fFiles.push_front({ path, stamp, std::move(file) });
+        EvictFiles(closed);
+    }
+
+    template <typename T, typename Create>
+    std::shared_ptr<const T> FilePool::GetMetadata(std::map<RNTupleKey, CachedMetadata<T>>& cache, const RNTupleKey& key, Create&& create) {
+        const FileStamp stamp = Stamp(key.first);
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            auto it = cache.find(key);
+            if (it != cache.end() && it->second.fStamp == stamp) {
+                return it->second.fObject;
+            }
+        }
+
+        std::shared_ptr<const T> object = create();
+
+        std::lock_guard<std::mutex> lock(fMutex);
+        auto& entry = cache[key];
+        // Another thread may have read the same RNTuple in the meantime; keep the first up-to-date one
+        if (!entry.fObject || entry.fStamp != stamp) {
+            entry = { object, stamp };
+        }
+        return entry.fObject;
+    }
+
+    std::shared_ptr<const ROOT::Experimental::RNTupleDescriptor> FilePool::GetDescriptor(const std::string& path, const std::string& rntupleName) {
+        return GetMetadata(fDescriptors, { path, rntupleName }, [&]() -> std::shared_ptr<const ROOT::Experimental::RNTupleDescriptor> {
+            // Only the anchor, header and footer are read; no pages are loaded
+            auto pageSource = ROOT::Experimental::Internal::RPageSource::Create(rntupleName, path);
+            pageSource->Attach();
+            auto descriptor = pageSource->GetSharedDescriptorGuard()->Clone();
+            if (!descriptor) {
+                throw std::runtime_error("Cannot read descriptor of RNTuple: " + rntupleName + " in file: " + path);
+            }
+            return descriptor;
+        });
+    }
+
+    std::shared_ptr<const ROOT::Experimental::RNTupleInspector> FilePool::GetInspector(const std::string& path, const std::string& rntupleName) {
+        return GetMetadata(fInspectors, { path, rntupleName }, [&]() -> std::shared_ptr<const ROOT::Experimental::RNTupleInspector> {
+            return ROOT::Experimental::RNTupleInspector::Create(rntupleName, path);
+        });
+    }
+
+    void FilePool::SetMaxFiles(std::size_t maxFiles) {
+        std::vector<std::unique_ptr<TFile>> closed;
+        std::lock_guard<std::mutex> lock(fMutex);
+        fMaxFiles = maxFiles;
+        EvictFiles(closed);
+    }
+
+    std::size_t FilePool::GetMaxFiles() const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        return fMaxFiles;
+    }
+
+    std::size_t FilePool::GetNFiles() const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        return fFiles.size() + fNLent;
+    }
+
+    std::size_t FilePool::GetNOpened() const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        return fNOpened;
+    }
+
+    void FilePool::Clear() {
+        std::list<CachedFile> closed;
+        std::lock_guard<std::mutex> lock(fMutex);
+        closed.swap(fFiles);
+        ++fGeneration;
+        fDescriptors.clear();
+        fInspectors.clear();
+    }
+
+    void FilePool::EvictFiles(std::vector<std::unique_ptr<TFile>>& closed) {
+        // Called with fMutex held; the evicted files are handed to the caller to be closed outside the lock
+        while (fFiles.size() > fMaxFiles) {
+            closed.push_back(std::move(fFiles.back().fFile));
+            fFiles.pop_back();
+        }
+    }
+
+    std::unique_ptr<ROOT::Experimental::RNTupleReader> OpenRNTupleReader(TFile& file, const std::string& rntupleName,
+                                                                         std::unique_ptr<ROOT::Experimental::RNTupleModel> model) {
+        // The anchor is owned by the caller of Get; the reader keeps its own copy
+        std::unique_ptr<ROOT::Experimental::RNTuple> anchor(file.Get<ROOT::Experimental::RNTuple>(rntupleName.c_str()));
+        if (!anchor) {
+            throw std::runtime_error("Cannot find RNTuple: " + rntupleName + " in file: " + file.GetName());
+        }
+        if (model) {
+            return ROOT::Experimental::RNTupleReader::Open(std::move(model), *anchor);
+        }
+        return ROOT::Experimental::RNTupleReader::Open(*anchor);
+    }
+
+} // namespace Checker
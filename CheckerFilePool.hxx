@@ -0,0 +1,162 @@
+/// \file CheckerFilePool.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERFILEPOOL_HXX
+#define CHECKERFILEPOOL_HXX
+
+#include <ROOT/RNTupleDescriptor.hxx>
+#include <ROOT/RNTupleInspector.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <TFile.h>
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Process-wide cache of open ROOT files, RNTuple descriptors and RNTuple inspectors, keyed by path.
+     *
+     * Checking many trees of the same file opens the file once and parses each RNTuple header and footer
+     * once, however many Checker instances are created.
+     *
+     * A TFile and the trees read from it are not safe to use from several places at once, so GetFile lends
+     * each open file to one holder at a time. Once released, the file goes back to the pool and the next
+     * holder of the same path reuses it, on whichever thread; only concurrent holders open a file again.
+     * Descriptors and inspectors are read-only after creation and are shared between all threads.
+     *
+     * Every cache hit compares the modification time and size of the file with those seen when it was opened,
+     * so a file rewritten in place (e.g. by the generator) is opened and parsed again.
+     *
+     * The pool keeps at most GetMaxFiles() released files open and closes the least recently released one
+     * when another comes back. Files still held by a Checker stay open until it releases them.
+     */
+    class FilePool {
+    public:
+        /**
+         * @brief Returns the pool of the process.
+         *
+         * The pool is never destroyed, so that files still cached at exit are closed by ROOT's own cleanup.
+         */
+        static FilePool& Instance();
+
+        /**
+         * @brief Returns an open file at the given path for the sole use of the caller, reusing a released one
+         *        if there is one and opening the file otherwise.
+         *
+         * The file goes back to the pool when the last copy of the returned pointer is destroyed.
+         *
+         * @return The file, or nullptr if it cannot be opened. Failures are not cached.
+         */
+        std::shared_ptr<TFile> GetFile(const std::string& path);
+
+        /**
+         * @brief Returns the descriptor of an RNTuple, reading only its header and footer on first use.
+         *
+         * @throws std::runtime_error (or a ROOT::Experimental::RException) if the RNTuple cannot be read.
+         */
+        std::shared_ptr<const ROOT::Experimental::RNTupleDescriptor> GetDescriptor(const std::string& path, const std::string& rntupleName);
+
+        /**
+         * @brief Returns the inspector of an RNTuple, creating it on first use.
+         *
+         * @throws ROOT::Experimental::RException if the RNTuple cannot be read.
+         */
+        std::shared_ptr<const ROOT::Experimental::RNTupleInspector> GetInspector(const std::string& path, const std::string& rntupleName);
+
+        /**
+         * @brief Sets how many released files the pool keeps open; 0 disables file caching.
+         */
+        void SetMaxFiles(std::size_t maxFiles);
+        std::size_t GetMaxFiles() const;
+
+        /// Number of files currently open through the pool, held or released
+        std::size_t GetNFiles() const;
+        /// Number of TFile::Open calls made by the pool so far
+        std::size_t GetNOpened() const;
+
+        /// Modification time in ns and size of a file; zero if it is not a local file
+        using FileStamp = std::pair<long long, long long>;
+
+        /**
+         * @brief Returns the stamp the pool compares to tell whether a file changed on disk.
+         */
+        static FileStamp Stamp(const std::string& path);
+
+        /**
+         * @brief Drops all cached files, descriptors and inspectors.
+         *
+         * Objects still held by a Checker stay valid until it releases them; files are then closed instead of
+         * going back to the pool.
+         */
+        void Clear();
+
+    private:
+        FilePool() = default;
+
+        using RNTupleKey = std::pair<std::string, std::string>;
+
+        struct CachedFile {
+            std::string fPath;
+            FileStamp fStamp;
+            std::unique_ptr<TFile> fFile;
+        };
+        template <typename T>
+        struct CachedMetadata {
+            std::shared_ptr<const T> fObject;
+            FileStamp fStamp;
+        };
+
+        // Hands a file out, so that destroying the last copy of the pointer calls Release
+        std::shared_ptr<TFile> Lend(const std::string& path, const FileStamp& stamp, std::unique_ptr<TFile> file);
+        void Release(const std::string& path, const FileStamp& stamp, std::size_t generation, std::unique_ptr<TFile> file);
+        void EvictFiles(std::vector<std::unique_ptr<TFile>>& closed);
+
+        // Looks the RNTuple up in cache and calls create() outside the lock if it is missing or out of date
+        template <typename T, typename Create>
+        std::shared_ptr<const T> GetMetadata(std::map<RNTupleKey, CachedMetadata<T>>& cache, const RNTupleKey& key, Create&& create);
+
+        mutable std::mutex fMutex;
+        std::size_t fMaxFiles = 64;
+        std::size_t fNOpened = 0;
+        std::size_t fNLent = 0;
+        std::size_t fGeneration = 0; // Counts the calls to Clear, so that files lent before one are not taken back
+        std::list<CachedFile> fFiles; // Released files, most recently released first
+        std::map<RNTupleKey, CachedMetadata<ROOT::Experimental::RNTupleDescriptor>> fDescriptors;
+        std::map<RNTupleKey, CachedMetadata<ROOT::Experimental::RNTupleInspector>> fInspectors;
+    };
+
+    /**
+     * @brief Opens a reader of an RNTuple from its anchor in an already open file, e.g. one lent by the FilePool,
+     *        instead of opening the file again by path.
+     *
+     * The reader reads through the file, so the caller must keep the file open for as long as the reader.
+     *
+     * @param model If given, the reader reads only the fields of this model.
+     * @throws std::runtime_error if the file does not contain the RNTuple.
+     */
+    std::unique_ptr<ROOT::Experimental::RNTupleReader> OpenRNTupleReader(TFile& file, const std::string& rntupleName,
+                                                                         std::unique_ptr<ROOT::Experimental::RNTupleModel> model = nullptr);
+
+} // namespace Checker
+
+#endif // CHECKERFILEPOOL_HXX
@@ -0,0 +1,302 @@
+/// \file CheckerFrame.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerFrame.hxx"
+#include "CheckerMemory.hxx"
+
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RDFHelpers.hxx>
+#include <ROOT/RNTupleDS.hxx>
+#include <TInterpreter.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
+namespace Checker {
+
+    namespace {
+
+        // Order of the statistics in ScanResult
+        const std::array<std::string, 4> kStatisticTypes = { "int", "float", "double", "bool" };
+
+        // The checksum of a column is the sum of Checksum(entry, Value(value)) over its entries. Declared to the
+        // interpreter, since the columns are defined from strings and may be of any scalar or vector type.
+        const char* kChecksumCode = R"(
+            #include <ROOT/RVec.hxx>
+            #include <cstring>
+            #include <vector>
+            namespace CheckerFrame {
+                inline ULong64_t Mix(ULong64_t x) {
+                    x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+                    x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+                    return x ^ (x >> 33);
+                }
+                template <typename T> ULong64_t Value(const T& value) {
+                    double d = static_cast<double>(value);
+                    if (d == 0) d = 0; // -0.0 equals 0.0
+                    ULong64_t bits;
+                    std::memcpy(&bits, &d, sizeof(bits));
+                    return bits;
+                }
+                template <typename T> ULong64_t Value(const std::vector<T>& values) {
+                    ULong64_t h = Mix(values.size());
+                    for (const auto& value : values) h = Mix(h ^ Value(value));
+                    return h;
+                }
+                template <typename T> ULong64_t Value(const ROOT::RVec<T>& values) {
+                    ULong64_t h = Mix(values.size());
+                    for (const auto& value : values) h = Mix(h ^ Value(value));
+                    return h;
+                }
+                inline ULong64_t Checksum(ULong64_t entry, ULong64_t value) { return Mix(Mix(entry) ^ value); }
+            }
+        )";
+
+        void DeclareChecksums() {
+            static std::once_flag declared;
+            std::call_once(declared, [] {
+                if (!gInterpreter->Declare(kChecksumCode)) {
+                    throw std::runtime_error("Cannot declare the checksum functions to the interpreter");
+                }
+            });
+        }
+
+        // The results booked on the graph of one file
+        struct FrameSide {
+            ROOT::RDF::RResultPtr<ULong64_t> fCount;
+            std::vector<ROOT::RDF::RResultPtr<ULong64_t>> fChecksums; // Of the plan columns; empty for those not compared
+            std::array<std::size_t, 4> fNStatistics{};                // Columns counted in the statistics of each type
+            std::array<ROOT::RDF::RResultPtr<double>, 4> fMeans;
+            std::array<ROOT::RDF::RResultPtr<double>, 4> fStdDevs;
+            std::array<ROOT::RDF::RResultPtr<TH1D>, 4> fHistograms;
+            std::vector<ROOT::RDF::RResultPtr<ULong64_t>> fDerivedChecksums;
+        };
+
+        ROOT::RDF::RResultPtr<ULong64_t> BookChecksum(ROOT::RDF::RNode& node, const std::string& column) {
+            const std::string name = "checker_checksum_" + column;
+            node = node.Define(name, "CheckerFrame::Checksum(rdfentry_, CheckerFrame::Value(" + column + "))");
+            const auto add = [](ULong64_t a, ULong64_t b) { return a + b; };
+            return node.Aggregate(add, add, name, ULong64_t(0));
+        }
+
+        FrameSide Book(ROOT::RDF::RNode node, const ScanPlan& plan, const std::string& side) {
+            const bool ttree = side == "TTree";
+            FrameSide booked;
+            if (!plan.fRequest.fSelection.empty()) {
+                node = node.Filter(plan.fRequest.fSelection);
+            }
+            for (const auto& derived : plan.fDerived) {
+                node = node.Define(derived.fName, derived.fExpression.ToCpp());
+            }
+            booked.fCount = node.Count();
+
+            // All values of a type in one collection per entry, so that one mean, deviation and histogram cover all its columns
+            std::array<std::string, 4> values;
+            for (const auto& column : plan.fColumns) {
+                const std::string& type = ttree ? column.fTTreeType : column.fRNTupleType;
+                auto it = std::find(kStatisticTypes.begin(), kStatisticTypes.end(), type);
+                if (!column.fStatistics || it == kStatisticTypes.end()) {
+                    continue;
+                }
+                const std::size_t k = it - kStatisticTypes.begin();
+                values[k] += (values[k].empty() ? "double(" : ", double(") + column.fName + ")";
+                ++booked.fNStatistics[k];
+            }
+            for (std::size_t k = 0; k < kStatisticTypes.size(); ++k) {
+                if (booked.fNStatistics[k] == 0) {
+                    continue;
+                }
+                const std::string name = "checker_" + kStatisticTypes[k] + "_values";
+                node = node.Define(name, "ROOT::RVecD{" + values[k] + "}");
+                booked.fMeans[k] = node.Mean(name);
+                booked.fStdDevs[k] = node.StdDev(name);
+                if (plan.fRequest.fHistograms) {
+                    std::string title = kStatisticTypes[k];
+                    title[0] = std::toupper(title[0]);
+                    const std::string histogram = side + "_" + title + "_Hist";
+                    title = side + " " + title + " Histogram;Value;Entries";
+                    // Equal axis limits let RDataFrame choose them from the first values, as RunScan does
+                    const bool isBool = kStatisticTypes[k] == "bool";
+                    booked.fHistograms[k] = node.Histo1D({ histogram.c_str(), title.c_str(), isBool ? 2 : 100, 0., isBool ? 2. : 0. }, name);
+                }
+            }
+
+            for (const auto& column : plan.fColumns) {
+                const bool checksum = column.fCompare && !column.fComparator;
+                booked.fChecksums.push_back(checksum ? BookChecksum(node, column.fName) : ROOT::RDF::RResultPtr<ULong64_t>());
+            }
+            for (const auto& derived : plan.fDerived) {
+                booked.fDerivedChecksums.push_back(BookChecksum(node, derived.fName));
+            }
+            return booked;
+        }
+
+        // Enables ROOT's implicit multi-threading while at least one scope is alive, unless the caller already had
+        // it enabled, and disables it again when the last scope ends; RunFrameScan may run on several threads at once
+        class ImplicitMTScope {
+        public:
+            explicit ImplicitMTScope(unsigned nThreads) : fActive(nThreads != 1) {
+                if (!fActive) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(Mutex());
+                if (Users() == 0) {
+                    Owned() = !ROOT::IsImplicitMTEnabled();
+                    if (Owned()) {
+                        ROOT::EnableImplicitMT(nThreads);
+                    }
+                }
+                ++Users();
+            }
+            ~ImplicitMTScope() {
+                if (!fActive) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(Mutex());
+                if (--Users() == 0 && Owned()) {
+                    ROOT::DisableImplicitMT();
+                    Owned() = false;
+                }
+            }
+
+            ImplicitMTScope(const ImplicitMTScope&) = delete;
+            ImplicitMTScope& operator=(const ImplicitMTScope&) = delete;
+
+        private:
+            static std::mutex& Mutex() { static std::mutex mutex; return mutex; }
+            static unsigned& Users() { static unsigned users = 0; return users; }
+            static bool& Owned() { static bool owned = false; return owned; }
+
+            bool fActive;
+        };
+
+        void CollectStatistics(FrameSide& booked, std::array<ScanStatistics, 4>& statistics) {
+            const long long nEntries = *booked.fCount;
+            for (std::size_t k = 0; k < statistics.size(); ++k) {
+                if (booked.fNStatistics[k] == 0 || nEntries == 0) {
+                    continue;
+                }
+                ScanStatistics& result = statistics[k];
+                result.fEntries = nEntries * static_cast<long long>(booked.fNStatistics[k]);
+                result.fMean = *booked.fMeans[k];
+                const double deviation = *booked.fStdDevs[k]; // Of the sample, with n - 1
+                result.fSumSquares = deviation * deviation * (result.fEntries - 1);
+                if (booked.fHistograms[k]) {
+                    result.fHistogram.reset(static_cast<TH1*>(booked.fHistograms[k]->Clone()));
+                    result.fHistogram->SetDirectory(nullptr);
+                }
+            }
+        }
+
+    } // namespace
+
+    ScanResult RunFrameScan(const ScanPlan& plan, unsigned nThreads) {
+        ScanResult result;
+        const auto start = std::chrono::steady_clock::now();
+        const auto finish = [&]() {
+            result.fPassed = result.fIssues.empty();
+            result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        };
+
+        if (plan.fRequest.fValues && plan.fEntries.first != plan.fEntries.second) {
+            result.fWarnings.push_back("Values not compared: the entry counts differ");
+        }
+        if (plan.fRequest.fFailFast != FailFast::kNever) {
+            result.fWarnings.push_back("The fail-fast rule does not apply to the RDataFrame engine");
+        }
+        ImplicitMTScope implicitMT(nThreads);
+
+        // Both graphs are booked before either event loop starts, and the two loops run at the same time
+        FrameSide ttree;
+        FrameSide rntuple;
+        try {
+            DeclareChecksums();
+            ROOT::RDataFrame ttreeFrame(plan.fPair.fTTreeName, plan.fPair.fTTreeFile);
+            auto rntupleFrame = ROOT::RDF::Experimental::FromRNTuple(plan.fPair.fRNTupleName, plan.fPair.fRNTupleFile);
+            {
+                MemoryPhase phase("Frame/Book");
+                ttree = Book(ttreeFrame, plan, "TTree");
+                rntuple = Book(rntupleFrame, plan, "RNTuple");
+            }
+            MemoryPhase phase("Frame/Run");
+            ROOT::RDF::RunGraphs({ ttree.fCount, rntuple.fCount });
+        }
+        catch (const std::exception& e) {
+            result.fIssues.push_back("Cannot run the RDataFrame event loops: " + std::string(e.what()));
+            return finish();
+        }
+        result.fNSelected = *ttree.fCount;
+        // Each column once from each file, over all entries; custom columns are only read by the rescan
+        result.fNReads = 2 * std::count_if(plan.fColumns.begin(), plan.fColumns.end(), [](const ScanColumn& column) { return !column.fComparator; });
+
+        if (plan.fRequest.fStatistics) {
+            CollectStatistics(ttree, result.fTTreeStatistics);
+            CollectStatistics(rntuple, result.fRNTupleStatistics);
+        }
+
+        // Columns and derived quantities whose checksums differ are located by the native scan, with their tolerances
+        ScanPlan rescan = plan;
+        rescan.fColumns.clear();
+        rescan.fDerived.clear();
+        rescan.fRequest.fStatistics = false;
+        rescan.fRequest.fHistograms = false;
+        rescan.fRequest.fFailFast = FailFast::kNever;
+        bool differs = false;
+        for (std::size_t c = 0; c < plan.fColumns.size(); ++c) {
+            ScanColumn column = plan.fColumns[c];
+            if (column.fComparator) {
+                // The interpreter knows nothing of the registered comparators: custom columns are always left to the rescan
+                differs = true;
+                rescan.fColumns.push_back(column);
+                continue;
+            }
+            const bool compared = column.fCompare;
+            column.fCompare = compared && *ttree.fChecksums[c] != *rntuple.fChecksums[c];
+            column.fStatistics = false;
+            if (compared && !column.fCompare) {
+                ++result.fNCompared;
+            }
+            differs = differs || column.fCompare;
+            if (column.fCompare || column.fKey) {
+                rescan.fColumns.push_back(column); // Key columns are read to describe the differences
+            }
+        }
+        for (std::size_t d = 0; d < plan.fDerived.size(); ++d) {
+            if (*ttree.fDerivedChecksums[d] != *rntuple.fDerivedChecksums[d]) {
+                rescan.fDerived.push_back(plan.fDerived[d]);
+                differs = true;
+            }
+            else {
+                ++result.fNCompared;
+            }
+        }
+        if (differs) {
+            MemoryPhase phase("Frame/Rescan");
+            ScanResult again = RunScan(rescan);
+            result.fNCompared += again.fNCompared;
+            result.fNReads += again.fNReads;
+            result.fIssues.insert(result.fIssues.end(), again.fIssues.begin(), again.fIssues.end());
+            result.fWarnings.insert(result.fWarnings.end(), again.fWarnings.begin(), again.fWarnings.end());
+            result.fColumnStatistics = std::move(again.fColumnStatistics);
+        }
+        return finish();
+    }
+
+} // namespace Checker
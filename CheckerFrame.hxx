@@ -0,0 +1,48 @@
+/// \file CheckerFrame.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERFRAME_HXX
+#define CHECKERFRAME_HXX
+
+#include "CheckerScan.hxx"
+
+namespace Checker {
+
+    /**
+     * @brief Runs the payload checks of a scan plan as RDataFrame graphs: one event loop per file, both run
+     *        at the same time on ROOT's implicit multi-threading.
+     *
+     * All results are booked lazily before either loop starts:
+     * - the entry count after the selection,
+     * - the mean, standard deviation and histogram of all int, float, double and bool values counted in the
+     *   statistics, per type,
+     * - an order-independent checksum of every compared column: the sum over the entries of a hash of the entry
+     *   number and the value, so it does not depend on the order in which the threads see the entries,
+     * - the checksum of every derived quantity of the plan, defined from Expression::ToCpp.
+     *
+     * Columns and derived quantities whose checksums differ are then scanned again by RunScan, restricted to
+     * them and the key columns, which reports the first differing entry and applies the tolerances. Columns of
+     * custom types (see RegisterComparator) are always left to that scan. Each file is filtered by its own
+     * values of the selection; the fail-fast rule does not apply, both loops always run to the end.
+     *
+     * @param nThreads Threads of the implicit multi-threading, 0 for one per hardware thread and 1 for none.
+     *                 It is enabled only while the scan runs, and left as it is if the caller has enabled it.
+     * @throws std::runtime_error if either side cannot be opened.
+     */
+    ScanResult RunFrameScan(const ScanPlan& plan, unsigned nThreads = 0);
+
+} // namespace Checker
+
+#endif // CHECKERFRAME_HXX
@@ -0,0 +1,120 @@
+/// \file CheckerGen.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerGenerator.hxx"
+
+#include <TError.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Checker;
+
+namespace {
+    void PrintUsage(const char* argv0) {
+        std::cerr << "Usage: " << argv0 << " -t <ttreeFile> -r <rntupleFile> -tn <ttreeName> -rn <rntupleName>\n"
+                  << "    [-n <entries>] [-c <columns>] [--types <i,f,d,b,vi,vf,vd,vb,s,af,vvf>] [--names <a,b,...>]\n"
+                  << "    [--vector-length <n>] [--compression <settings>] [--cluster-size <bytes>] [--split-level <n>]\n"
+                  << "    [--seed <n>] [--sequential] [--mismatch <spec>]... [--files <n>] [--trees <n>] [--threads <n>] [--update]\n"
+                  << "Mismatch specs (optionally followed by @<tree index>):\n"
+                  << "    value:<column>:<entry>  skip:<entry>  drop:<column>  rename:<column>:<name>  retype:<column>:<type>\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    gErrorIgnoreLevel = kError;
+
+    GeneratorConfig config;
+    std::string ttreeFile, rntupleFile, ttreeName, rntupleName;
+    int nFiles = 1;
+    int nTrees = 1;
+    unsigned nThreads = std::max(2u, std::thread::hardware_concurrency());
+    bool update = false;
+
+    // Loop through the command-line arguments to parse options and their values
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--sequential") {
+            config.fSequential = true;
+            continue;
+        }
+        if (arg == "--update") {
+            update = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "-t") ttreeFile = value;
+            else if (arg == "-r") rntupleFile = value;
+            else if (arg == "-tn") ttreeName = value;
+            else if (arg == "-rn") rntupleName = value;
+            else if (arg == "-n" || arg == "--entries") config.fEntries = std::stoll(value);
+            else if (arg == "-c" || arg == "--columns") config.fColumns = std::stoi(value);
+            else if (arg == "--types") config.fTypes = ParseColumnTypes(value);
+            else if (arg == "--vector-length") config.fVectorLength = std::stoul(value);
+            else if (arg == "--compression") config.fCompression = std::stoi(value);
+            else if (arg == "--cluster-size") config.fClusterSize = std::stoul(value);
+            else if (arg == "--split-level") config.fSplitLevel = std::stoi(value);
+            else if (arg == "--seed") config.fSeed = std::stoull(value);
+            else if (arg == "--mismatch") config.fMismatches.push_back(ParseMismatch(value));
+            else if (arg == "--files") nFiles = std::stoi(value);
+            else if (arg == "--trees") nTrees = std::stoi(value);
+            else if (arg == "--threads") nThreads = std::stoul(value);
+            else if (arg == "--names") {
+                std::stringstream stream(value);
+                std::string name;
+                while (std::getline(stream, name, ',')) {
+                    config.fNames.push_back(name);
+                }
+            }
+            else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Invalid value for " << arg << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (ttreeFile.empty() || rntupleFile.empty() || ttreeName.empty() || rntupleName.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // Time the creation of all files
+    auto start = std::chrono::steady_clock::now();
+    try {
+        GeneratePairs(config, ttreeFile, rntupleFile, ttreeName, rntupleName, nFiles, nTrees, update, nThreads);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Generation failed: " << e.what() << std::endl;
+        return 1;
+    }
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Wrote " << nFiles << " file pair(s) with " << nTrees << " tree(s) of " << config.fEntries
+              << " entries each in " << diff.count() << " seconds" << std::endl;
+    return 0;
+}
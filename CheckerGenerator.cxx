@@ -0,0 +1,498 @@
+/// \file CheckerGenerator.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerGenerator.hxx"
+#include <ROOT/RNTuple.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+
+#include <TFile.h>
+#include <TROOT.h>
+#include <TTree.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Checker {
+
+    namespace {
+        template <typename T> struct TypeTag { using type = T; };
+        template <typename T> struct IsStdVector : std::false_type {};
+        template <typename T> struct IsStdVector<std::vector<T>> : std::true_type {};
+        template <typename T> struct IsStdArray : std::false_type {};
+        template <typename T, std::size_t N> struct IsStdArray<std::array<T, N>> : std::true_type {};
+
+        // Calls f with a TypeTag of the C++ type that represents the given column type
+        template <typename F>
+        void VisitGenType(GenColumnType type, F&& f) {
+            switch (type) {
+                case GenColumnType::kInt: f(TypeTag<int>{}); break;
+                case GenColumnType::kFloat: f(TypeTag<float>{}); break;
+                case GenColumnType::kDouble: f(TypeTag<double>{}); break;
+                case GenColumnType::kBool: f(TypeTag<bool>{}); break;
+                case GenColumnType::kIntVector: f(TypeTag<std::vector<int>>{}); break;
+                case GenColumnType::kFloatVector: f(TypeTag<std::vector<float>>{}); break;
+                case GenColumnType::kDoubleVector: f(TypeTag<std::vector<double>>{}); break;
+                case GenColumnType::kBoolVector: f(TypeTag<std::vector<bool>>{}); break;
+                case GenColumnType::kString: f(TypeTag<std::string>{}); break;
+                case GenColumnType::kFloatArray: f(TypeTag<std::array<float, kGenArrayLength>>{}); break;
+                case GenColumnType::kNestedFloatVector: f(TypeTag<std::vector<std::vector<float>>>{}); break;
+            }
+        }
+
+        // SplitMix64 - cheap, stateless and identical for both formats, so values never need to be stored
+        std::uint64_t Mix(std::uint64_t seed, std::uint64_t entry, std::uint64_t column, std::uint64_t element) {
+            std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (entry + 1) + 0xBF58476D1CE4E5B9ull * (column + 1) + 0x94D049BB133111EBull * element;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        template <typename T>
+        T GenScalar(const GeneratorConfig& config, long long entry, int column, std::uint64_t element) {
+            if (config.fSequential) {
+                // The values createMT/createMR used to write: i, i * 0.1, i * 1.5 and i % 2 == 0, plus the element index
+                if constexpr (std::is_same_v<T, int>) return static_cast<int>(entry + element);
+                else if constexpr (std::is_same_v<T, float>) return entry * 0.1f + element;
+                else if constexpr (std::is_same_v<T, double>) return entry * 1.5 + element;
+                else return entry % 2 == 0;
+            }
+            const std::uint64_t h = Mix(config.fSeed, entry, column, element);
+            if constexpr (std::is_same_v<T, int>) return static_cast<int>(h % 100000);
+            else if constexpr (std::is_same_v<T, float>) return static_cast<float>(h % 1000000) * 0.001f;
+            else if constexpr (std::is_same_v<T, double>) return static_cast<double>(h >> 11) * 0x1.0p-53 * 1000.0;
+            else return (h & 1) != 0;
+        }
+
+        // Vector lengths vary uniformly in [0, 2 * fVectorLength] so the mean is fVectorLength
+        std::size_t GenLength(const GeneratorConfig& config, long long entry, int column, std::uint64_t element) {
+            if (config.fSequential || config.fVectorLength == 0) {
+                return config.fVectorLength;
+            }
+            return Mix(config.fSeed ^ 0xABCDEFull, entry, column, element) % (2 * config.fVectorLength + 1);
+        }
+
+        template <typename T>
+        void GenInto(const GeneratorConfig& config, long long entry, int column, T& out) {
+            if constexpr (std::is_arithmetic_v<T>) {
+                out = GenScalar<T>(config, entry, column, 0);
+            }
+            else if constexpr (std::is_same_v<T, std::string>) {
+                out = "entry_" + std::to_string(entry) + "_" + std::to_string(GenScalar<int>(config, entry, column, 0));
+            }
+            else if constexpr (IsStdArray<T>::value) {
+                for (std::size_t k = 0; k < out.size(); ++k) {
+                    out[k] = GenScalar<typename T::value_type>(config, entry, column, k);
+                }
+            }
+            else {
+                using Item = typename T::value_type;
+                out.resize(GenLength(config, entry, column, 0));
+                for (std::size_t k = 0; k < out.size(); ++k) {
+                    if constexpr (IsStdVector<Item>::value) {
+                        out[k].resize(GenLength(config, entry, column, k + 1));
+                        for (std::size_t j = 0; j < out[k].size(); ++j) {
+                            out[k][j] = GenScalar<typename Item::value_type>(config, entry, column, (k + 1) * 1024 + j);
+                        }
+                    }
+                    else {
+                        out[k] = GenScalar<Item>(config, entry, column, k);
+                    }
+                }
+            }
+        }
+
+        // Changes a value so that it no longer matches what the TTree holds
+        template <typename T>
+        void Perturb(T& value) {
+            if constexpr (std::is_same_v<T, bool>) value = !value;
+            else if constexpr (std::is_arithmetic_v<T>) value = value + 1;
+            else if constexpr (std::is_same_v<T, std::string>) value += "*";
+            else if constexpr (IsStdArray<T>::value) value[0] += 1;
+            else if constexpr (std::is_same_v<T, std::vector<bool>>) {
+                if (value.empty()) value.push_back(true);
+                else value[0] = !value[0];
+            }
+            else {
+                if (value.empty()) value.resize(1);
+                else Perturb(value[0]);
+            }
+        }
+
+        // Retyping is supported between the fundamental scalars and between vectors of fundamental types
+        template <typename Target, typename Source>
+        constexpr bool IsRetypable() {
+            if constexpr (std::is_same_v<Target, Source>) return true;
+            else if constexpr (std::is_arithmetic_v<Target> && std::is_arithmetic_v<Source>) return true;
+            else if constexpr (IsStdVector<Target>::value && IsStdVector<Source>::value) {
+                return std::is_arithmetic_v<typename Target::value_type> && std::is_arithmetic_v<typename Source::value_type>;
+            }
+            else return false;
+        }
+
+        template <typename Target, typename Source>
+        void ConvertInto(const Source& source, Target& target) {
+            if constexpr (std::is_same_v<Target, Source>) {
+                target = source;
+            }
+            else if constexpr (std::is_arithmetic_v<Target> && std::is_arithmetic_v<Source>) {
+                target = static_cast<Target>(source);
+            }
+            else if constexpr (IsRetypable<Target, Source>()) {
+                target.resize(source.size());
+                for (std::size_t k = 0; k < source.size(); ++k) {
+                    target[k] = static_cast<typename Target::value_type>(source[k]);
+                }
+            }
+        }
+
+        template <typename T>
+        const char* LeafCode() {
+            if constexpr (std::is_same_v<T, int>) return "I";
+            else if constexpr (std::is_same_v<T, float>) return "F";
+            else if constexpr (std::is_same_v<T, double>) return "D";
+            else return "O";
+        }
+
+        using Filler = std::function<void(long long)>;
+
+        // Creates the branch of one column and returns the function that sets its value for an entry
+        Filler MakeTTreeFiller(TTree& tree, const GeneratorConfig& config, int column) {
+            const std::string name = GenColumnName(config, column);
+            Filler filler;
+            VisitGenType(GenColumnTypeAt(config, column), [&](auto tag) {
+                using T = typename decltype(tag)::type;
+                auto value = std::make_shared<T>();
+                if constexpr (std::is_arithmetic_v<T>) {
+                    tree.Branch(name.c_str(), value.get(), (name + "/" + LeafCode<T>()).c_str());
+                }
+                else if constexpr (IsStdArray<T>::value) {
+                    tree.Branch(name.c_str(), value->data(), (name + "[" + std::to_string(kGenArrayLength) + "]/F").c_str());
+                }
+                else {
+                    tree.Branch(name.c_str(), value.get(), 32000, config.fSplitLevel);
+                }
+                filler = [value, &config, column](long long entry) { GenInto(config, entry, column, *value); };
+            });
+            return filler;
+        }
+
+        // Same for the RNTuple side: the value is generated as the source type and converted to the written type
+        Filler MakeRNTupleFiller(ROOT::Experimental::RNTupleModel& model, const GeneratorConfig& config, int column,
+            const std::string& name, GenColumnType targetType, std::vector<long long> valueEntries) {
+            Filler filler;
+            VisitGenType(targetType, [&](auto targetTag) {
+                using Target = typename decltype(targetTag)::type;
+                VisitGenType(GenColumnTypeAt(config, column), [&](auto sourceTag) {
+                    using Source = typename decltype(sourceTag)::type;
+                    if constexpr (!IsRetypable<Target, Source>()) {
+                        throw std::invalid_argument("Cannot retype column " + GenColumnName(config, column));
+                    }
+                    else {
+                        auto value = model.MakeField<Target>(name);
+                        filler = [value, &config, column, valueEntries, source = Source()](long long entry) mutable {
+                            GenInto(config, entry, column, source);
+                            ConvertInto(source, *value);
+                            if (std::find(valueEntries.begin(), valueEntries.end(), entry) != valueEntries.end()) {
+                                Perturb(*value);
+                            }
+                        };
+                    }
+                });
+            });
+            return filler;
+        }
+
+        // Column of a mismatch, given either by index or by name
+        int ResolveColumn(const GeneratorConfig& config, const std::string& column) {
+            if (!column.empty() && std::all_of(column.begin(), column.end(), ::isdigit)) {
+                const int index = std::stoi(column);
+                if (index < config.fColumns) return index;
+            }
+            for (int c = 0; c < config.fColumns; ++c) {
+                if (GenColumnName(config, c) == column) return c;
+            }
+            throw std::invalid_argument("Mismatch refers to unknown column: " + column);
+        }
+
+        std::unique_ptr<TFile> OpenOutput(const std::string& fileName, bool update) {
+            if (!update) {
+                std::remove(fileName.c_str());
+            }
+            auto file = std::unique_ptr<TFile>(TFile::Open(fileName.c_str(), update ? "UPDATE" : "RECREATE"));
+            if (!file || file->IsZombie()) {
+                throw std::runtime_error("Cannot create file: " + fileName);
+            }
+            return file;
+        }
+
+        std::string IndexedFileName(const std::string& fileName, int index, int count) {
+            if (count <= 1) return fileName;
+            const auto dot = fileName.rfind('.');
+            const std::string suffix = "_" + std::to_string(index);
+            return dot == std::string::npos ? fileName + suffix : fileName.substr(0, dot) + suffix + fileName.substr(dot);
+        }
+
+        std::string IndexedName(const std::string& name, int index, int count) {
+            return count <= 1 ? name : name + "_" + std::to_string(index);
+        }
+    }
+
+    std::vector<GenColumnType> ParseColumnTypes(const std::string& spec) {
+        std::vector<GenColumnType> types;
+        std::stringstream stream(spec);
+        std::string item;
+
+        while (std::getline(stream, item, ',')) {
+            if (item == "i" || item == "int") types.push_back(GenColumnType::kInt);
+            else if (item == "f" || item == "float") types.push_back(GenColumnType::kFloat);
+            else if (item == "d" || item == "double") types.push_back(GenColumnType::kDouble);
+            else if (item == "b" || item == "bool") types.push_back(GenColumnType::kBool);
+            else if (item == "vi" || item == "vector<int>") types.push_back(GenColumnType::kIntVector);
+            else if (item == "vf" || item == "vector<float>") types.push_back(GenColumnType::kFloatVector);
+            else if (item == "vd" || item == "vector<double>") types.push_back(GenColumnType::kDoubleVector);
+            else if (item == "vb" || item == "vector<bool>") types.push_back(GenColumnType::kBoolVector);
+            else if (item == "s" || item == "string") types.push_back(GenColumnType::kString);
+            else if (item == "af" || item == "float[" + std::to_string(kGenArrayLength) + "]") types.push_back(GenColumnType::kFloatArray);
+            else if (item == "vvf" || item == "vector<vector<float>>") types.push_back(GenColumnType::kNestedFloatVector);
+            else throw std::invalid_argument("Unknown column type: " + item);
+        }
+        if (types.empty()) {
+            throw std::invalid_argument("Empty column type list");
+        }
+        return types;
+    }
+
+    MismatchSpec ParseMismatch(const std::string& spec) {
+        MismatchSpec mismatch;
+        std::string body = spec;
+
+        // Optional tree index after '@'
+        const auto at = body.find('@');
+        if (at != std::string::npos) {
+            mismatch.fTree = std::stoi(body.substr(at + 1));
+            body = body.substr(0, at);
+        }
+
+        std::vector<std::string> parts;
+        std::stringstream stream(body);
+        std::string item;
+        while (std::getline(stream, item, ':')) {
+            parts.push_back(item);
+        }
+        if (parts.empty()) {
+            throw std::invalid_argument("Empty mismatch specification");
+        }
+
+        const std::string& kind = parts[0];
+        if (kind == "value" && parts.size() == 3) {
+            mismatch.fKind = MismatchSpec::kValue;
+            mismatch.fColumn = parts[1];
+            mismatch.fEntry = std::stoll(parts[2]);
+        }
+        else if (kind == "skip" && parts.size() == 2) {
+            mismatch.fKind = MismatchSpec::kSkipEntry;
+            mismatch.fEntry = std::stoll(parts[1]);
+        }
+        else if (kind == "drop" && parts.size() == 2) {
+            mismatch.fKind = MismatchSpec::kDropColumn;
+            mismatch.fColumn = parts[1];
+        }
+        else if (kind == "rename" && parts.size() == 3) {
+            mismatch.fKind = MismatchSpec::kRenameColumn;
+            mismatch.fColumn = parts[1];
+            mismatch.fArgument = parts[2];
+        }
+        else if (kind == "retype" && parts.size() == 3) {
+            mismatch.fKind = MismatchSpec::kRetypeColumn;
+            mismatch.fColumn = parts[1];
+            mismatch.fArgument = parts[2];
+            ParseColumnTypes(mismatch.fArgument); // Validate the type early
+        }
+        else {
+            throw std::invalid_argument("Malformed mismatch specification: " + spec);
+        }
+        return mismatch;
+    }
+
+    GenColumnType GenColumnTypeAt(const GeneratorConfig& config, int column) {
+        return config.fTypes[column % config.fTypes.size()];
+    }
+
+    std::string GenColumnName(const GeneratorConfig& config, int column) {
+        if (column < static_cast<int>(config.fNames.size())) {
+            return config.fNames[column];
+        }
+        static const char* prefixes[] = { "int", "float", "double", "bool", "vint", "vfloat", "vdouble", "vbool",
+            "string", "afloat", "vvfloat" };
+        return std::string(prefixes[static_cast<int>(GenColumnTypeAt(config, column))]) + "_" + std::to_string(column);
+    }
+
+    void GenerateTTree(const GeneratorConfig& config, const std::string& fileName, const std::string& treeName, bool update) {
+        auto file = OpenOutput(fileName, update);
+        file->SetCompressionSettings(config.fCompression);
+
+        auto* tree = new TTree(treeName.c_str(), treeName.c_str());
+        tree->SetAutoFlush(-static_cast<Long64_t>(config.fClusterSize)); // negative = cluster size in bytes
+
+        std::vector<Filler> fillers;
+        fillers.reserve(config.fColumns);
+        for (int c = 0; c < config.fColumns; ++c) {
+            fillers.push_back(MakeTTreeFiller(*tree, config, c));
+        }
+
+        for (long long i = 0; i < config.fEntries; ++i) {
+            for (const auto& filler : fillers) {
+                filler(i);
+            }
+            tree->Fill();
+        }
+
+        tree->Write();
+        file->Close();
+    }
+
+    void GenerateRNTuple(const GeneratorConfig& config, const std::string& fileName, const std::string& rntupleName,
+        bool update, int treeIndex) {
+
+        // Collect the mismatches that apply to this RNTuple, per column
+        std::set<long long> skippedEntries;
+        std::vector<bool> dropped(config.fColumns, false);
+        std::vector<std::string> names(config.fColumns);
+        std::vector<GenColumnType> types(config.fColumns);
+        std::vector<std::vector<long long>> valueEntries(config.fColumns);
+        for (int c = 0; c < config.fColumns; ++c) {
+            names[c] = GenColumnName(config, c);
+            types[c] = GenColumnTypeAt(config, c);
+        }
+        for (const auto& mismatch : config.fMismatches) {
+            if (mismatch.fTree != -1 && mismatch.fTree != treeIndex) {
+                continue;
+            }
+            if (mismatch.fKind == MismatchSpec::kSkipEntry) {
+                skippedEntries.insert(mismatch.fEntry);
+                continue;
+            }
+            const int c = ResolveColumn(config, mismatch.fColumn);
+            switch (mismatch.fKind) {
+                case MismatchSpec::kValue: valueEntries[c].push_back(mismatch.fEntry); break;
+                case MismatchSpec::kDropColumn: dropped[c] = true; break;
+                case MismatchSpec::kRenameColumn: names[c] = mismatch.fArgument; break;
+                case MismatchSpec::kRetypeColumn: types[c] = ParseColumnTypes(mismatch.fArgument)[0]; break;
+                default: break;
+            }
+        }
+
+        auto file = OpenOutput(fileName, update);
+        auto model = ROOT::Experimental::RNTupleModel::Create();
+
+        std::vector<Filler> fillers;
+        fillers.reserve(config.fColumns);
+        for (int c = 0; c < config.fColumns; ++c) {
+            if (!dropped[c]) {
+                fillers.push_back(MakeRNTupleFiller(*model, config, c, names[c], types[c], valueEntries[c]));
+            }
+        }
+
+        ROOT::Experimental::RNTupleWriteOptions options;
+        options.SetCompression(config.fCompression);
+        options.SetApproxZippedClusterSize(config.fClusterSize);
+
+        {
+            // The writer has to be destroyed before the file is closed, so that the last cluster is committed
+            auto writer = ROOT::Experimental::RNTupleWriter::Append(std::move(model), rntupleName, *file, options);
+            for (long long i = 0; i < config.fEntries; ++i) {
+                if (skippedEntries.count(i)) {
+                    continue;
+                }
+                for (const auto& filler : fillers) {
+                    filler(i);
+                }
+                writer->Fill();
+            }
+        }
+
+        file->Close();
+    }
+
+    void GeneratePairs(const GeneratorConfig& config, const std::string& ttreeFile, const std::string& rntupleFile,
+        const std::string& ttreeName, const std::string& rntupleName, int nFiles, int nTrees, bool update, unsigned nThreads) {
+
+        // One task per output file; the trees within a file are written one after the other
+        std::vector<std::function<void()>> tasks;
+        for (int f = 0; f < nFiles; ++f) {
+            const std::string ttreePath = IndexedFileName(ttreeFile, f, nFiles);
+            const std::string rntuplePath = IndexedFileName(rntupleFile, f, nFiles);
+            tasks.emplace_back([&config, ttreePath, ttreeName, nTrees, update] {
+                for (int t = 0; t < nTrees; ++t) {
+                    GenerateTTree(config, ttreePath, IndexedName(ttreeName, t, nTrees), update || t > 0);
+                }
+            });
+            tasks.emplace_back([&config, rntuplePath, rntupleName, nTrees, update] {
+                for (int t = 0; t < nTrees; ++t) {
+                    GenerateRNTuple(config, rntuplePath, IndexedName(rntupleName, t, nTrees), update || t > 0, t);
+                }
+            });
+        }
+
+        nThreads = std::max(1u, std::min<unsigned>(nThreads, tasks.size()));
+        if (nThreads > 1) {
+            ROOT::EnableThreadSafety();
+        }
+
+        std::atomic<std::size_t> next{ 0 };
+        std::exception_ptr firstError;
+        std::mutex errorMutex;
+        auto worker = [&] {
+            for (std::size_t i = next++; i < tasks.size(); i = next++) {
+                try {
+                    tasks[i]();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!firstError) firstError = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < nThreads; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+    }
+
+} // namespace Checker
@@ -0,0 +1,167 @@
+/// \file CheckerGenerator.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERGENERATOR_HXX
+#define CHECKERGENERATOR_HXX
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Column types the synthetic dataset generator can write.
+     *
+     * Besides the types the Checker reads (scalars and vectors of int, float, double and bool) the generator
+     * can write strings, fixed-size float arrays and nested float vectors for stress inputs.
+     */
+    enum class GenColumnType {
+        kInt,
+        kFloat,
+        kDouble,
+        kBool,
+        kIntVector,
+        kFloatVector,
+        kDoubleVector,
+        kBoolVector,
+        kString,                // std::string
+        kFloatArray,            // float[kGenArrayLength], std::array<float, kGenArrayLength> in the RNTuple
+        kNestedFloatVector      // std::vector<std::vector<float>>
+    };
+
+    /// Length of the fixed-size array columns
+    constexpr std::size_t kGenArrayLength = 4;
+
+    /**
+     * @brief A difference injected into the RNTuple side of a generated pair.
+     *
+     * The TTree is always written as configured; the RNTuple is modified so that the Checker has something
+     * to find at a known position.
+     */
+    struct MismatchSpec {
+        enum EKind {
+            kValue,             // Change the value of fColumn at fEntry
+            kSkipEntry,         // Do not write fEntry
+            kDropColumn,        // Do not write fColumn at all
+            kRenameColumn,      // Write fColumn under the name fArgument
+            kRetypeColumn       // Write fColumn with the type fArgument (scalars and fundamental vectors only)
+        };
+        EKind fKind = kValue;
+        std::string fColumn;    // Column name or index, empty for kSkipEntry
+        long long fEntry = -1;  // Entry for kValue and kSkipEntry
+        std::string fArgument;  // New name for kRenameColumn, new type for kRetypeColumn
+        int fTree = -1;         // Index of the tree the mismatch applies to, -1 for all of them
+    };
+
+    /**
+     * @brief Parameters of a generated TTree/RNTuple pair.
+     *
+     * The columns are laid out by cycling through fTypes until fColumns columns exist, so {kInt, kFloat} with
+     * four columns gives int, float, int, float. Both formats are filled with exactly the same values unless
+     * mismatches are injected.
+     */
+    struct GeneratorConfig {
+        long long fEntries = 10;                        // Number of entries to write
+        int fColumns = 4;                               // Number of columns (branches/fields)
+        std::vector<GenColumnType> fTypes = {
+            GenColumnType::kInt, GenColumnType::kFloat, GenColumnType::kDouble, GenColumnType::kBool };
+        std::vector<std::string> fNames;                // Optional column names, overriding the generated ones
+        std::size_t fVectorLength = 3;                  // Mean number of elements per entry for vector columns
+        int fCompression = 505;                         // ROOT compression settings (algorithm * 100 + level)
+        std::size_t fClusterSize = 50 * 1000 * 1000;    // Approximate compressed cluster size in bytes
+        int fSplitLevel = 99;                           // Split level of the TTree object branches
+        std::uint64_t fSeed = 42;                       // Seed of the value generator
+        bool fSequential = false;                       // Values derived from the entry number, as in the old macros
+        std::vector<MismatchSpec> fMismatches;          // Differences injected into the RNTuple side
+    };
+
+    /**
+     * @brief Parses a comma separated type list such as "i,f,d,b,vi,vf,vd,vb,s,af,vvf".
+     *
+     * @param spec The type list; the long names "int", "float", "double", "bool", "string", "vector<...>",
+     *             "float[4]" and "vector<vector<float>>" are accepted too.
+     * @return The parsed column types.
+     * @throws std::invalid_argument if an element of the list is not a known type.
+     */
+    std::vector<GenColumnType> ParseColumnTypes(const std::string& spec);
+
+    /**
+     * @brief Parses a mismatch specification.
+     *
+     * Accepted forms, each optionally followed by "@<tree index>":
+     * - value:<column>:<entry>
+     * - skip:<entry>
+     * - drop:<column>
+     * - rename:<column>:<new name>
+     * - retype:<column>:<type>
+     *
+     * @param spec The specification string.
+     * @return The parsed mismatch.
+     * @throws std::invalid_argument if the specification is malformed.
+     */
+    MismatchSpec ParseMismatch(const std::string& spec);
+
+    /**
+     * @brief Returns the name of the i-th generated column, e.g. "int_0" or "vfloat_3".
+     */
+    std::string GenColumnName(const GeneratorConfig& config, int column);
+
+    /**
+     * @brief Returns the type of the i-th generated column.
+     */
+    GenColumnType GenColumnTypeAt(const GeneratorConfig& config, int column);
+
+    /**
+     * @brief Writes a TTree with the configured layout.
+     *
+     * @param config The dataset parameters.
+     * @param fileName Path of the ROOT file to write into.
+     * @param treeName Name of the TTree within the file.
+     * @param update If true, the TTree is added to an existing file instead of recreating it.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    void GenerateTTree(const GeneratorConfig& config, const std::string& fileName, const std::string& treeName, bool update = false);
+
+    /**
+     * @brief Writes an RNTuple with the configured layout and the mismatches of the given tree index.
+     *
+     * @param config The dataset parameters.
+     * @param fileName Path of the ROOT file to write into.
+     * @param rntupleName Name of the RNTuple within the file.
+     * @param update If true, the RNTuple is added to an existing file instead of recreating it.
+     * @param treeIndex Index used to select the mismatches that apply to this RNTuple.
+     * @throws std::runtime_error if the file cannot be opened.
+     * @throws std::invalid_argument if a mismatch refers to an unknown column or an unsupported retyping.
+     */
+    void GenerateRNTuple(const GeneratorConfig& config, const std::string& fileName, const std::string& rntupleName,
+        bool update = false, int treeIndex = 0);
+
+    /**
+     * @brief Writes nFiles TTree/RNTuple file pairs with nTrees trees each, in parallel.
+     *
+     * Every output file is one task; the tasks are spread over nThreads threads. With more than one file,
+     * "_<file index>" is inserted before the file extension; with more than one tree, "_<tree index>" is
+     * appended to the TTree and RNTuple names.
+     *
+     * @throws The first exception raised by any of the tasks.
+     */
+    void GeneratePairs(const GeneratorConfig& config, const std::string& ttreeFile, const std::string& rntupleFile,
+        const std::string& ttreeName, const std::string& rntupleName, int nFiles = 1, int nTrees = 1,
+        bool update = false, unsigned nThreads = 2);
+
+} // namespace Checker
+
+#endif // CHECKERGENERATOR_HXX
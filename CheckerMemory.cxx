@@ -0,0 +1,181 @@
+/// \file CheckerMemory.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerMemory.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sys/resource.h>
+
+#ifdef CHECKER_PROFILE
+namespace {
+    std::atomic<std::size_t> gAllocations{ 0 };
+    std::atomic<std::size_t> gAllocatedBytes{ 0 };
+
+    void* CountedAlloc(std::size_t size) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+        gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        void* ptr = std::malloc(size > 0 ? size : 1);
+        if (!ptr) throw std::bad_alloc();
+        return ptr;
+    }
+}
+
+// Counting replacements of the global allocation functions. The over-aligned variants are left to the
+// standard library, which pairs them with its own deallocation functions.
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+#endif
+
+namespace {
+    // Nesting depth of the MemoryPhase scopes of the current thread
+    thread_local int gPhaseDepth = 0;
+}
+
+namespace Checker {
+
+    std::size_t AllocationCount() {
+#ifdef CHECKER_PROFILE
+        return gAllocations.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    std::size_t AllocatedBytes() {
+#ifdef CHECKER_PROFILE
+        return gAllocatedBytes.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    void ResetPeakRSS() {
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        if (clearRefs) clearRefs << "5";
+    }
+
+    double PeakRSSMB() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) {
+                return std::stod(line.substr(6)) / 1024.0;
+            }
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+    }
+
+    MemoryProfile& MemoryProfile::Instance() {
+        static MemoryProfile profile;
+        return profile;
+    }
+
+    bool MemoryProfile::CountsAllocations() {
+#ifdef CHECKER_PROFILE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void MemoryProfile::Record(const std::string& phase, const MemoryStats& stats) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        MemoryStats& total = fPhases[phase];
+        total.fAllocations += stats.fAllocations;
+        total.fBytes += stats.fBytes;
+        total.fPeakRSSMB = std::max(total.fPeakRSSMB, stats.fPeakRSSMB);
+        total.fCalls += stats.fCalls;
+    }
+
+    std::map<std::string, MemoryStats> MemoryProfile::GetPhases() const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        return fPhases;
+    }
+
+    void MemoryProfile::Print(std::ostream& os) const {
+        const auto phases = GetPhases();
+        const bool counted = CountsAllocations();
+
+        os << std::left << std::setw(48) << "Phase"
+           << std::right << std::setw(8) << "Calls";
+        if (counted) os << std::setw(14) << "Allocs" << std::setw(14) << "Alloc [MB]";
+        os << std::setw(12) << "Peak [MB]" << std::endl;
+        os << std::string(counted ? 96 : 68, '-') << std::endl;
+
+        for (const auto& [name, stats] : phases) {
+            os << std::left << std::setw(48) << name
+               << std::right << std::setw(8) << stats.fCalls;
+            if (counted) {
+                os << std::setw(14) << stats.fAllocations
+                   << std::setw(14) << std::fixed << std::setprecision(2) << stats.fBytes / (1024.0 * 1024.0);
+            }
+            if (stats.fPeakRSSMB > 0) os << std::setw(12) << std::fixed << std::setprecision(1) << stats.fPeakRSSMB << std::endl;
+            else os << std::setw(12) << "-" << std::endl; // Nested phase
+        }
+        if (!counted) {
+            os << "(allocation counts require a build with CHECKER_PROFILE)" << std::endl;
+        }
+    }
+
+    void MemoryProfile::Reset() {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fPhases.clear();
+    }
+
+    MemoryPhase::MemoryPhase(std::string_view name, std::string_view column) {
+        if (!MemoryProfile::Instance().IsEnabled()) return;
+        fName = name;
+        if (!column.empty()) {
+            fName += '/';
+            fName += column;
+        }
+        fActive = true;
+        if (gPhaseDepth++ == 0) ResetPeakRSS();
+        fStartAllocations = AllocationCount();
+        fStartBytes = AllocatedBytes();
+    }
+
+    MemoryPhase::~MemoryPhase() {
+        if (!fActive) return;
+        MemoryStats stats;
+        stats.fAllocations = AllocationCount() - fStartAllocations;
+        stats.fBytes = AllocatedBytes() - fStartBytes;
+        stats.fCalls = 1;
+        if (--gPhaseDepth == 0) {
+            stats.fPeakRSSMB = PeakRSSMB(); // Reads /proc/self/status, so only once per top-level phase
+        }
+        MemoryProfile::Instance().Record(fName, stats);
+    }
+
+} // namespace Checker
@@ -0,0 +1,128 @@
+/// \file CheckerMemory.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERMEMORY_HXX
+#define CHECKERMEMORY_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace Checker {
+
+    /**
+     * @brief Memory used by one phase of a check.
+     *
+     * Allocation counts and bytes are only collected in builds with CHECKER_PROFILE defined (Debug builds and
+     * -DCHECKER_PROFILE=ON), where the global operator new is replaced by a counting hook. The peak RSS is
+     * available in every build.
+     */
+    struct MemoryStats {
+        std::size_t fAllocations = 0;   // Number of operator new calls
+        std::size_t fBytes = 0;         // Bytes requested from operator new
+        double fPeakRSSMB = 0;          // Peak resident set size up to the end of the phase, in MB; 0 for nested phases
+        std::size_t fCalls = 0;         // How often the phase ran
+    };
+
+    /**
+     * @brief Process-wide collection of per-phase memory statistics.
+     *
+     * Phases are recorded by MemoryPhase scopes while the profile is enabled. Column phases are named
+     * "<function>/<column>", e.g. "Scan/value" in the scan or "ReadIntFromTTree/value" in the Read* functions.
+     */
+    class MemoryProfile {
+    public:
+        static MemoryProfile& Instance();
+
+        /**
+         * @brief Enables or disables recording; disabled MemoryPhase scopes cost one flag check.
+         */
+        void SetEnabled(bool enabled) { fEnabled = enabled; }
+        bool IsEnabled() const { return fEnabled; }
+
+        /**
+         * @brief True if this build counts allocations (CHECKER_PROFILE).
+         */
+        static bool CountsAllocations();
+
+        /**
+         * @brief Adds the statistics of one run of a phase.
+         */
+        void Record(const std::string& phase, const MemoryStats& stats);
+
+        /**
+         * @brief Returns a copy of the statistics recorded so far, keyed by phase name.
+         */
+        std::map<std::string, MemoryStats> GetPhases() const;
+
+        /**
+         * @brief Prints a table of all phases.
+         */
+        void Print(std::ostream& os) const;
+
+        void Reset();
+
+    private:
+        MemoryProfile() = default;
+
+        std::atomic<bool> fEnabled{ false };
+        mutable std::mutex fMutex;
+        std::map<std::string, MemoryStats> fPhases;
+    };
+
+    /**
+     * @brief RAII scope that records the allocations and the peak RSS of the code it encloses.
+     *
+     * The high-water mark of the RSS is reset when an outermost phase starts and read when it ends, so each
+     * top-level phase reports its own peak. Nested phases, e.g. the columns of a scan, report their allocations
+     * only, as reading the mark for every column would cost more than the column itself.
+     * Allocations are counted process-wide, including ROOT's worker threads.
+     */
+    class MemoryPhase {
+    public:
+        /**
+         * @brief Starts the phase `name`, or "<name>/<column>" if a column is given. The name is only built
+         *        while the profile is enabled.
+         */
+        explicit MemoryPhase(std::string_view name, std::string_view column = {});
+        ~MemoryPhase();
+
+        MemoryPhase(const MemoryPhase&) = delete;
+        MemoryPhase& operator=(const MemoryPhase&) = delete;
+
+    private:
+        std::string fName;
+        bool fActive = false;
+        std::size_t fStartAllocations = 0;
+        std::size_t fStartBytes = 0;
+    };
+
+    /// Number of operator new calls since the start of the process (0 without CHECKER_PROFILE)
+    std::size_t AllocationCount();
+    /// Bytes requested from operator new since the start of the process (0 without CHECKER_PROFILE)
+    std::size_t AllocatedBytes();
+
+    /// Resets the kernel's high-water mark of the resident set size (Linux)
+    void ResetPeakRSS();
+    /// Peak resident set size since the last reset, in MB; falls back to the process lifetime peak
+    double PeakRSSMB();
+
+} // namespace Checker
+
+#endif // CHECKERMEMORY_HXX
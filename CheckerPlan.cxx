@@ -0,0 +1,141 @@
+/// \file CheckerPlan.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerPlan.hxx"
+#include "Checker.hxx"
+#include "CheckerFilePool.hxx"
+#include "CheckerSource.hxx"
+
+#include <TBranch.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace Checker {
+
+    namespace {
+
+        // Rough throughputs of a single thread, used to weigh the byte counts against each other
+        constexpr double kReadBytesPerSecond = 200e6;
+        constexpr double kDecodeBytesPerSecond = 1e9;
+        constexpr double kSecondsPerEntry = 50e-9;
+
+        // Bytes of one element of a common type, as returned by MapFieldType, or of its vector elements
+        std::size_t ElementSize(const std::string& type) {
+            if (type.find("double") != std::string::npos) return 8;
+            if (type.find("bool") != std::string::npos) return 1;
+            return 4;
+        }
+
+    } // namespace
+
+    double EstimateColumnCost(long long nEntries, long long compressedBytes, long long uncompressedBytes) {
+        return compressedBytes / kReadBytesPerSecond + uncompressedBytes / kDecodeBytesPerSecond + 2 * nEntries * kSecondsPerEntry;
+    }
+
+    CheckPlan PlanChecks(const PairSpec& pair) {
+        CheckPlan plan;
+        plan.fPair = pair;
+        plan.fStructure.fPair = pair;
+
+        Checker checker(pair.fTTreeFile, pair.fRNTupleFile, pair.fTTreeName, pair.fRNTupleName);
+        const auto columns = CheckStructure(checker, plan.fStructure);
+        plan.fNEntries = checker.CountEntries().first;
+
+        auto file = FilePool::Instance().GetFile(pair.fTTreeFile);
+        TTree* tree = file ? file->Get<TTree>(pair.fTTreeName.c_str()) : nullptr;
+        if (!tree) {
+            throw std::runtime_error("Cannot find TTree: " + pair.fTTreeName + " in file: " + pair.fTTreeFile);
+        }
+        const auto inspector = FilePool::Instance().GetInspector(pair.fRNTupleFile, pair.fRNTupleName);
+
+        for (const auto& column : columns) {
+            ColumnCheck check;
+            check.fColumn = column.first;
+            check.fType = column.second;
+
+            long long rntupleUncompressed = 0;
+            if (TBranch* branch = tree->GetBranch(column.first.c_str())) {
+                check.fCompressedBytes += branch->GetZipBytes("*");
+                check.fUncompressedBytes += branch->GetTotBytes("*");
+            }
+            try {
+                const auto& field = inspector->GetFieldTreeInspector(column.first);
+                check.fCompressedBytes += field.GetCompressedSize();
+                rntupleUncompressed = field.GetUncompressedSize();
+                check.fUncompressedBytes += rntupleUncompressed;
+            }
+            catch (const std::exception&) {
+                // No size information for this field; it is planned by its entries only
+            }
+
+            if (check.fType.find("vector") != std::string::npos && plan.fNEntries > 0) {
+                const long long elementBytes = std::max(0LL, rntupleUncompressed - 8 * plan.fNEntries); // Less one offset per entry
+                check.fMeanVectorSize = static_cast<double>(elementBytes) / ElementSize(check.fType) / plan.fNEntries;
+            }
+            check.fCost = EstimateColumnCost(plan.fNEntries, check.fCompressedBytes, check.fUncompressedBytes);
+            plan.fCost += check.fCost;
+            plan.fColumns.push_back(check);
+        }
+
+        std::stable_sort(plan.fColumns.begin(), plan.fColumns.end(),
+                         [](const ColumnCheck& a, const ColumnCheck& b) { return a.fCost < b.fCost; });
+        return plan;
+    }
+
+    PairResult RunPlan(const CheckPlan& plan, bool failFast) {
+        PairResult result = plan.fStructure;
+        const auto start = std::chrono::steady_clock::now();
+
+        // Values are only compared once the structure matches, otherwise the columns do not line up
+        std::size_t nRun = 0;
+        const bool structureMatches = result.fIssues.empty();
+        if (structureMatches) {
+            try {
+                TTreeSource ttree(plan.fPair.fTTreeFile, plan.fPair.fTTreeName);
+                RNTupleSource rntuple(plan.fPair.fRNTupleFile, plan.fPair.fRNTupleName);
+                for (const auto& check : plan.fColumns) {
+                    if (failFast && !result.fIssues.empty()) {
+                        break;
+                    }
+                    ++nRun;
+                    try {
+                        const long long mismatch = FindFirstMismatch(check.fType, ttree, 0, rntuple, 0, check.fColumn, plan.fNEntries);
+                        if (mismatch >= 0) {
+                            result.fIssues.push_back(check.fColumn + " differs at entry " + std::to_string(mismatch));
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        result.fIssues.push_back("Cannot compare " + check.fColumn + ": " + e.what());
+                    }
+                }
+            }
+            catch (const std::exception& e) {
+                result.fError = e.what();
+            }
+        }
+        if (nRun < plan.fColumns.size()) {
+            result.fWarnings.push_back(std::to_string(plan.fColumns.size() - nRun) + " of " + std::to_string(plan.fColumns.size())
+                                       + (structureMatches ? " value comparisons not run after the first failure"
+                                                           : " value comparisons not run: the structure differs"));
+        }
+
+        result.fPassed = result.fError.empty() && result.fIssues.empty();
+        result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+} // namespace Checker
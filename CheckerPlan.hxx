@@ -0,0 +1,82 @@
+/// \file CheckerPlan.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERPLAN_HXX
+#define CHECKERPLAN_HXX
+
+#include "CheckerBatch.hxx"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief The value comparison of one column, with its cost estimated from metadata.
+     */
+    struct ColumnCheck {
+        std::string fColumn;
+        std::string fType;                // Common type as returned by MapFieldType, e.g. "float" or "vector<int>"
+        long long fCompressedBytes = 0;   // On disk, both sides
+        long long fUncompressedBytes = 0; // After decompression, both sides
+        double fMeanVectorSize = 1;       // Elements per entry, estimated from the RNTuple; 1 for scalar columns
+        double fCost = 0;                 // Estimated seconds
+    };
+
+    /**
+     * @brief Order in which the checks of one pair are run.
+     */
+    struct CheckPlan {
+        PairSpec fPair;
+        long long fNEntries = 0;
+        PairResult fStructure;             // Entry counts, field names and types, checked from metadata while planning
+        std::vector<ColumnCheck> fColumns; // Value comparisons, cheapest first
+        double fCost = 0;                  // Estimated seconds of all value comparisons
+    };
+
+    /**
+     * @brief Estimates the cost of comparing a single column.
+     *
+     * The model charges the compressed bytes of both sides for reading, the uncompressed bytes for decompressing
+     * and comparing, and a fixed overhead per entry and side.
+     */
+    double EstimateColumnCost(long long nEntries, long long compressedBytes, long long uncompressedBytes);
+
+    /**
+     * @brief Plans the checks of a pair without reading any payload.
+     *
+     * The structural checks (entry counts, field names and types) only need metadata and catch most broken
+     * conversions, so they are done right away. Every column whose type matches exactly is then planned for a
+     * value comparison, with its cost taken from the byte counts of the TTree branch and the RNTuple field, and
+     * the comparisons are ordered from cheapest to most expensive. Vector columns are costed by their size, so
+     * long vectors come last; their mean size is derived from the uncompressed size of the RNTuple field, less
+     * its offsets.
+     *
+     * @throws std::runtime_error if either side cannot be opened.
+     */
+    CheckPlan PlanChecks(const PairSpec& pair);
+
+    /**
+     * @brief Runs the value comparisons of a plan in order, after its structural checks.
+     *
+     * The values are only compared if the structure matches. With failFast the run stops at the first check
+     * that fails, and the checks not run are listed in a warning.
+     */
+    PairResult RunPlan(const CheckPlan& plan, bool failFast = false);
+
+} // namespace Checker
+
+#endif // CHECKERPLAN_HXX
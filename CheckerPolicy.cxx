@@ -0,0 +1,204 @@
+/// \file CheckerPolicy.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerPolicy.hxx"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace Checker {
+
+    namespace {
+
+        std::string Trim(const std::string& text) {
+            const std::size_t first = text.find_first_not_of(" \t\r");
+            if (first == std::string::npos) {
+                return "";
+            }
+            const std::size_t last = text.find_last_not_of(" \t\r");
+            return text.substr(first, last - first + 1);
+        }
+
+        std::string Unquote(const std::string& text) {
+            const std::string trimmed = Trim(text);
+            if (trimmed.size() >= 2 && (trimmed.front() == '"' || trimmed.front() == '\'') && trimmed.back() == trimmed.front()) {
+                return trimmed.substr(1, trimmed.size() - 2);
+            }
+            return trimmed;
+        }
+
+        // The line up to a # that is not inside quotes
+        std::string StripComment(const std::string& line) {
+            char quote = 0;
+            for (std::size_t i = 0; i < line.size(); ++i) {
+                if (quote) {
+                    if (line[i] == quote) quote = 0;
+                }
+                else if (line[i] == '"' || line[i] == '\'') {
+                    quote = line[i];
+                }
+                else if (line[i] == '#') {
+                    return line.substr(0, i);
+                }
+            }
+            return line;
+        }
+
+        // A parse error at one line of the input
+        class PolicyError : public std::runtime_error {
+        public:
+            PolicyError(const std::string& source, int lineNo, const std::string& message)
+                : std::runtime_error(source + ":" + std::to_string(lineNo) + ": " + message) {}
+        };
+
+        bool ParseBool(const std::string& value, const std::string& source, int lineNo) {
+            const std::string text = Unquote(value);
+            if (text == "true") return true;
+            if (text == "false") return false;
+            throw PolicyError(source, lineNo, "expected true or false, got '" + text + "'");
+        }
+
+        double ParseNumber(const std::string& value, const std::string& source, int lineNo) {
+            const std::string text = Unquote(value);
+            std::size_t end = 0;
+            double number = 0;
+            try {
+                number = std::stod(text, &end);
+            }
+            catch (const std::exception&) {
+                end = 0;
+            }
+            if (text.empty() || end != text.size() || number < 0) {
+                throw PolicyError(source, lineNo, "expected a non-negative number, got '" + text + "'");
+            }
+            return number;
+        }
+
+        std::vector<std::string> ParseList(const std::string& value) {
+            std::string text = Trim(value);
+            if (!text.empty() && text.front() == '[' && text.back() == ']') {
+                text = text.substr(1, text.size() - 2);
+            }
+            std::vector<std::string> items;
+            std::size_t start = 0;
+            while (start <= text.size()) {
+                const std::size_t comma = std::min(text.find(',', start), text.size());
+                const std::string item = Unquote(text.substr(start, comma - start));
+                if (!item.empty()) {
+                    items.push_back(item);
+                }
+                start = comma + 1;
+            }
+            return items;
+        }
+
+        ColumnTolerance& FindTolerance(ScanRequest& request, const std::string& pattern) {
+            auto it = std::find_if(request.fTolerances.begin(), request.fTolerances.end(),
+                                   [&](const ColumnTolerance& tolerance) { return tolerance.fPattern == pattern; });
+            if (it != request.fTolerances.end()) {
+                return *it;
+            }
+            request.fTolerances.push_back({ pattern, 0, 0 });
+            return request.fTolerances.back();
+        }
+
+    } // namespace
+
+    ScanRequest ParseCheckPolicy(std::istream& in, const std::string& source) {
+        ScanRequest request;
+        std::string section;
+        std::string line;
+        for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+            line = Trim(StripComment(line));
+            if (line.empty()) {
+                continue;
+            }
+
+            if (line.front() == '[') {
+                if (line.back() != ']') {
+                    throw PolicyError(source, lineNo, "malformed section header: " + line);
+                }
+                section = Trim(line.substr(1, line.size() - 2));
+                if (section != "checks" && section != "columns" && section != "tolerance" && section != "relative_tolerance"
+                    && section != "derived") {
+                    throw PolicyError(source, lineNo, "unknown section [" + section + "]");
+                }
+                continue;
+            }
+
+            const std::size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                throw PolicyError(source, lineNo, "expected <key> = <value>");
+            }
+            const std::string key = Unquote(line.substr(0, equals));
+            const std::string value = Trim(line.substr(equals + 1));
+            if (key.empty() || value.empty()) {
+                throw PolicyError(source, lineNo, "expected <key> = <value>");
+            }
+
+            if (section == "checks") {
+                if (key == "structure") request.fStructure = ParseBool(value, source, lineNo);
+                else if (key == "values") request.fValues = ParseBool(value, source, lineNo);
+                else if (key == "statistics") request.fStatistics = ParseBool(value, source, lineNo);
+                else if (key == "histograms") request.fHistograms = ParseBool(value, source, lineNo);
+                else if (key == "selection") request.fSelection = Unquote(value);
+                else if (key == "engine") {
+                    const std::string engine = Unquote(value);
+                    if (engine == "native") request.fEngine = ScanEngine::kNative;
+                    else if (engine == "dataframe") request.fEngine = ScanEngine::kDataFrame;
+                    else throw PolicyError(source, lineNo, "engine must be native or dataframe, got '" + engine + "'");
+                }
+                else if (key == "fail_fast") {
+                    const std::string rule = Unquote(value);
+                    if (rule == "never" || rule == "false") request.fFailFast = FailFast::kNever;
+                    else if (rule == "any" || rule == "true") request.fFailFast = FailFast::kAnyIssue;
+                    else if (rule == "keys") request.fFailFast = FailFast::kKeyColumns;
+                    else throw PolicyError(source, lineNo, "fail_fast must be never, any or keys, got '" + rule + "'");
+                }
+                else throw PolicyError(source, lineNo, "unknown key '" + key + "' in [checks]");
+            }
+            else if (section == "columns") {
+                if (key == "compare") request.fColumns = ParseList(value);
+                else if (key == "ignore") request.fIgnore = ParseList(value);
+                else if (key == "keys") request.fKeyColumns = ParseList(value);
+                else throw PolicyError(source, lineNo, "unknown key '" + key + "' in [columns]");
+            }
+            else if (section == "tolerance") {
+                FindTolerance(request, key).fAbsolute = ParseNumber(value, source, lineNo);
+            }
+            else if (section == "relative_tolerance") {
+                FindTolerance(request, key).fRelative = ParseNumber(value, source, lineNo);
+            }
+            else if (section == "derived") {
+                request.fDerived.push_back({ key, Unquote(value) });
+            }
+            else {
+                throw PolicyError(source, lineNo, "key '" + key + "' outside of a section");
+            }
+        }
+        return request;
+    }
+
+    ScanRequest ReadCheckPolicy(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open check policy: " + path);
+        }
+        return ParseCheckPolicy(in, path);
+    }
+
+} // namespace Checker
@@ -0,0 +1,72 @@
+/// \file CheckerPolicy.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERPOLICY_HXX
+#define CHECKERPOLICY_HXX
+
+#include "CheckerScan.hxx"
+
+#include <istream>
+#include <string>
+
+namespace Checker {
+
+    /**
+     * @brief Parses a check policy: which checks a scan runs and how each column is treated.
+     *
+     * The syntax is a small subset of TOML: `[section]` headers, `key = value` lines and `#` comments. Values
+     * are booleans, numbers, strings (quoted or bare) and lists, written `[a, "b"]` or `a, b`. Keys may be quoted,
+     * which is needed for patterns such as `"jet_*"`.
+     *
+     *     [checks]
+     *     structure = true          # Entry counts, field names and types
+     *     values = true             # Entry by entry comparison
+     *     statistics = true         # Entries, mean and standard deviation per type
+     *     histograms = false        # One histogram per type, drawn by the CLI
+     *     fail_fast = keys          # never, any or keys
+     *     selection = "nJet > 2"    # Only entries passing this cut (see Selection)
+     *     engine = dataframe        # native (RunScan) or dataframe (RunFrameScan)
+     *
+     *     [columns]
+     *     compare = ["px", "py", "jet_*"]
+     *     ignore = ["jet_debug"]
+     *     keys = ["run", "event"]
+     *
+     *     [tolerance]               # Absolute
+     *     px = 1e-6
+     *
+     *     [relative_tolerance]
+     *     "jet_*" = 1e-5
+     *
+     *     [derived]                 # Quantities compared like columns
+     *     pt = "sqrt(px*px + py*py)"
+     *
+     * Sections and keys that are left out keep the defaults of ScanRequest.
+     *
+     * @param source Name of the input, for error messages.
+     * @throws std::runtime_error with the source and line number on any unknown section, key or malformed value.
+     */
+    ScanRequest ParseCheckPolicy(std::istream& in, const std::string& source);
+
+    /**
+     * @brief Reads a check policy from a file (see ParseCheckPolicy).
+     *
+     * @throws std::runtime_error if the file cannot be opened or is malformed.
+     */
+    ScanRequest ReadCheckPolicy(const std::string& path);
+
+} // namespace Checker
+
+#endif // CHECKERPOLICY_HXX
@@ -0,0 +1,592 @@
+/// \file CheckerScan.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerScan.hxx"
+#include "Checker.hxx"
+#include "CheckerBuffers.hxx"
+#include "CheckerCLI.hxx"
+#include "CheckerComparators.hxx"
+#include "CheckerFilePool.hxx"
+#include "CheckerMemory.hxx"
+#include "CheckerSource.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <fnmatch.h>
+#include <sstream>
+
+namespace Checker {
+
+    namespace {
+
+        // Order of the statistics in ScanResult
+        const std::array<std::string, 4> kStatisticTypes = { "int", "float", "double", "bool" };
+
+        // Statistics of a common type, or nullptr for vector and unknown types
+        ScanStatistics* FindStatistics(std::array<ScanStatistics, 4>& statistics, const std::string& type) {
+            auto it = std::find(kStatisticTypes.begin(), kStatisticTypes.end(), type);
+            return it != kStatisticTypes.end() ? &statistics[it - kStatisticTypes.begin()] : nullptr;
+        }
+
+        std::shared_ptr<TH1> MakeHistogram(const std::string& side, const std::string& type) {
+            std::string title = type;
+            title[0] = std::toupper(title[0]);
+            const std::string name = side + "_" + title + "_Hist";
+            title = side + " " + title + " Histogram;Value;Entries";
+
+            // Bools have two fixed bins; the other axes are set from the first values and grow to fit the later ones
+            std::shared_ptr<TH1> histogram;
+            if (type == "bool") {
+                histogram = std::make_shared<TH1I>(name.c_str(), title.c_str(), 2, 0, 2);
+            }
+            else {
+                histogram = std::make_shared<TH1D>(name.c_str(), title.c_str(), 100, 0, 0);
+                histogram->SetCanExtend(TH1::kAllAxes);
+            }
+            histogram->SetDirectory(nullptr);
+            return histogram;
+        }
+
+        bool MatchesAny(const std::vector<std::string>& patterns, const std::string& name) {
+            return std::any_of(patterns.begin(), patterns.end(),
+                               [&](const std::string& pattern) { return fnmatch(pattern.c_str(), name.c_str(), 0) == 0; });
+        }
+
+        // Entries of the range that exist in a file with nEntries entries
+        long long ClipRange(const ScanRange& range, long long nEntries) {
+            return std::max(0LL, std::min(range.fFirst + range.fNEntries, nEntries) - range.fFirst);
+        }
+
+        // Where the batches of one file go besides the statistics
+        struct BatchSink {
+            ScanVisitor* fVisitor = nullptr;
+            ScanSide fSide = ScanSide::kTTree;
+
+            template <typename T>
+            void operator()(const std::string& name, long long first, const std::vector<T>& values) const {
+                if (fVisitor) {
+                    fVisitor->OnBatch(fSide, name, first, values);
+                }
+            }
+        };
+
+        template <typename T>
+        void ReadScalar(ColumnSource& source, const std::string& column, long long first, long long n, std::vector<T>& values,
+                        ScanStatistics* statistics, const BatchSink& sink) {
+            source.Read(column, first, n, values);
+            sink(column, first, values);
+            if (statistics) {
+                for (const auto value : values) {
+                    statistics->Fill(static_cast<double>(value));
+                }
+            }
+        }
+
+        // Reads a column of one file that is not compared, only for its statistics
+        std::size_t ReadForStatistics(ColumnSource& source, const std::string& column, const std::string& type, long long first,
+                                      long long n, ScanStatistics* statistics, const BatchSink& sink) {
+            if (!statistics || n <= 0) {
+                return 0;
+            }
+            if (type == "int") ReadScalar(source, column, first, n, *PooledBuffer<int>(), statistics, sink);
+            else if (type == "float") ReadScalar(source, column, first, n, *PooledBuffer<float>(), statistics, sink);
+            else if (type == "double") ReadScalar(source, column, first, n, *PooledBuffer<double>(), statistics, sink);
+            else if (type == "bool") ReadScalar(source, column, first, n, *PooledBuffer<bool>(), statistics, sink);
+            return 1;
+        }
+
+        // Reads a custom column of one file that is not compared, only for the statistics of its comparator
+        std::size_t AccumulateCustom(const CustomComparator& comparator, ColumnSource& source, const std::string& column, long long first,
+                                     long long n, ScanStatistics* statistics) {
+            if (!statistics || !comparator.fAccumulate || n <= 0) {
+                return 0;
+            }
+            comparator.fAccumulate(source, column, first, n, *statistics);
+            return 1;
+        }
+
+        // Offset of the first pair of values that differ by more than the tolerance, or -1
+        template <typename T>
+        long long FindDifference(const std::vector<T>& ttreeValues, const std::vector<T>& rntupleValues, double absolute, double relative) {
+            auto diff = absolute == 0 && relative == 0
+                            ? std::mismatch(ttreeValues.begin(), ttreeValues.end(), rntupleValues.begin(), rntupleValues.end())
+                            : std::mismatch(ttreeValues.begin(), ttreeValues.end(), rntupleValues.begin(), rntupleValues.end(),
+                                            [&](T a, T b) {
+                                                const double x = a;
+                                                const double y = b;
+                                                return x == y || std::abs(x - y) <= absolute + relative * std::max(std::abs(x), std::abs(y));
+                                            });
+            if (diff.first != ttreeValues.end() || diff.second != rntupleValues.end()) {
+                return diff.first - ttreeValues.begin();
+            }
+            return -1;
+        }
+
+        // Reads a compared scalar column of both files, feeds the statistics and returns the offset of the first difference
+        template <typename T>
+        long long CompareScalar(ColumnSource& ttree, ColumnSource& rntuple, const ScanColumn& column, const ScanRange& range,
+                                ScanStatistics* ttreeStatistics, ScanStatistics* rntupleStatistics, ScanVisitor* visitor) {
+            PooledBuffer<T> ttreeValues;
+            PooledBuffer<T> rntupleValues;
+            ReadScalar(ttree, column.fName, range.fFirst, range.fNEntries, *ttreeValues, ttreeStatistics, { visitor, ScanSide::kTTree });
+            ReadScalar(rntuple, column.fName, range.fFirst, range.fNEntries, *rntupleValues, rntupleStatistics, { visitor, ScanSide::kRNTuple });
+
+            return FindDifference(*ttreeValues, *rntupleValues, column.fAbsoluteTolerance, column.fRelativeTolerance);
+        }
+
+        // Computes a derived quantity in both files and returns the offset of the first difference
+        long long CompareDerived(ColumnSource& ttree, ColumnSource& rntuple, const ScanDerived& derived, const ScanRange& range,
+                                 ScanVisitor* visitor) {
+            PooledBuffer<double> ttreeValues;
+            PooledBuffer<double> rntupleValues;
+            derived.fExpression.Evaluate(ttree, derived.fTTreeTypes, range.fFirst, range.fNEntries, *ttreeValues);
+            derived.fExpression.Evaluate(rntuple, derived.fRNTupleTypes, range.fFirst, range.fNEntries, *rntupleValues);
+            if (visitor) {
+                visitor->OnBatch(ScanSide::kTTree, derived.fName, range.fFirst, *ttreeValues);
+                visitor->OnBatch(ScanSide::kRNTuple, derived.fName, range.fFirst, *rntupleValues);
+            }
+            return FindDifference(*ttreeValues, *rntupleValues, derived.fAbsoluteTolerance, derived.fRelativeTolerance);
+        }
+
+        // " (run=1, event=42)": the key columns of the plan at one entry of a file
+        std::string DescribeKeys(ColumnSource& source, const ScanPlan& plan, long long entry) {
+            std::ostringstream keys;
+            for (const auto& column : plan.fColumns) {
+                if (!column.fKey) {
+                    continue;
+                }
+                keys << (keys.tellp() > 0 ? ", " : " (") << column.fName << "=";
+                const std::string& type = column.fTTreeType;
+                if (type == "int") { PooledBuffer<int> value; source.Read(column.fName, entry, 1, *value); keys << value->at(0); }
+                else if (type == "float") { PooledBuffer<float> value; source.Read(column.fName, entry, 1, *value); keys << value->at(0); }
+                else if (type == "double") { PooledBuffer<double> value; source.Read(column.fName, entry, 1, *value); keys << value->at(0); }
+                else if (type == "bool") { PooledBuffer<bool> value; source.Read(column.fName, entry, 1, *value); keys << value->at(0); }
+            }
+            return keys.tellp() > 0 ? keys.str() + ")" : "";
+        }
+
+        // Entry ranges along the cluster boundaries, none longer than kBatchEntries
+        std::vector<ScanRange> ScheduleRanges(std::vector<long long> ends, long long nEntries) {
+            ends.push_back(nEntries);
+            std::sort(ends.begin(), ends.end());
+            ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+            std::vector<ScanRange> ranges;
+            const long long maxEntries = kBatchEntries;
+            long long first = 0;
+            long long last = 0;
+            for (long long end : ends) {
+                if (end <= last || end > nEntries) {
+                    continue;
+                }
+                if (end - first <= maxEntries) {
+                    last = end; // Merged with the clusters before
+                    continue;
+                }
+                if (last > first) {
+                    ranges.push_back({ first, last - first });
+                    first = last;
+                }
+                while (end - first > maxEntries) {
+                    ranges.push_back({ first, maxEntries });
+                    first += maxEntries;
+                }
+                last = end;
+            }
+            if (last > first) {
+                ranges.push_back({ first, last - first });
+            }
+            return ranges;
+        }
+
+        // The runs of consecutive entries passing a selection, from its result for entries first, first + 1, ...
+        std::vector<ScanRange> SelectedRuns(long long first, const std::vector<char>& pass) {
+            std::vector<ScanRange> runs;
+            for (std::size_t k = 0; k < pass.size(); ++k) {
+                if (!pass[k]) {
+                    continue;
+                }
+                if (!runs.empty() && runs.back().fFirst + runs.back().fNEntries == first + static_cast<long long>(k)) {
+                    ++runs.back().fNEntries;
+                }
+                else {
+                    runs.push_back({ first + static_cast<long long>(k), 1 });
+                }
+            }
+            return runs;
+        }
+
+        // True if the fail-fast rule of the plan ends the scan, given the outcome of the ranges so far for the
+        // columns and then the derived quantities
+        bool StopsScan(const ScanPlan& plan, const std::vector<long long>& mismatch, const std::vector<bool>& failed) {
+            for (std::size_t c = 0; c < mismatch.size(); ++c) {
+                const bool differs = mismatch[c] >= 0 || failed[c];
+                const bool key = c < plan.fColumns.size() && plan.fColumns[c].fKey;
+                if (differs && (plan.fRequest.fFailFast == FailFast::kAnyIssue || (plan.fRequest.fFailFast == FailFast::kKeyColumns && key))) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    } // namespace
+
+    void ScanStatistics::Fill(double value) {
+        ++fEntries;
+        const double delta = value - fMean;
+        fMean += delta / fEntries;
+        fSumSquares += delta * (value - fMean);
+        if (fHistogram) {
+            fHistogram->Fill(value);
+        }
+    }
+
+    double ScanStatistics::GetStdDev() const {
+        return fEntries > 0 ? std::sqrt(fSumSquares / fEntries) : 0.0;
+    }
+
+    std::tuple<int, double, double> ScanStatistics::GetSummary() const {
+        return { static_cast<int>(fEntries), fMean, GetStdDev() };
+    }
+
+    ScanPlan PlanScan(const PairSpec& pair, const ScanRequest& request) {
+        ScanPlan plan;
+        plan.fPair = pair;
+        plan.fRequest = request;
+
+        Checker checker(pair.fTTreeFile, pair.fRNTupleFile, pair.fTTreeName, pair.fRNTupleName);
+        plan.fEntries = checker.CountEntries();
+        if (request.fStructure) {
+            plan.fFields = checker.CountFields();
+            plan.fFieldNames = checker.CompareFieldNames();
+        }
+        plan.fFieldTypes = checker.CompareFieldTypes();
+
+        // The columns each check needs, merged into one list
+        const auto isStatisticType = [](const std::string& type) {
+            return std::find(kStatisticTypes.begin(), kStatisticTypes.end(), type) != kStatisticTypes.end();
+        };
+        const bool sameEntries = plan.fEntries.first == plan.fEntries.second;
+        for (const auto& types : plan.fFieldTypes) {
+            const std::string& ttreeType = std::get<1>(types);
+            const std::string& rntupleType = std::get<2>(types);
+
+            ScanColumn column;
+            column.fName = std::get<0>(types);
+            column.fTTreeType = ttreeType == "No match" ? "" : MapFieldType(ttreeType);
+            column.fRNTupleType = rntupleType == "No match" ? "" : MapFieldType(rntupleType);
+            const bool exact = MatchFieldTypes(ttreeType, rntupleType) == FieldTypeMatch::kExact;
+            if (column.fTTreeType == "Missing" && column.fRNTupleType == "Missing") {
+                // A type the Checker does not know, compared by a registered comparator if one matches it in both files
+                auto comparator = ComparatorRegistry::Instance().Find(ttreeType);
+                if (comparator && comparator == ComparatorRegistry::Instance().Find(rntupleType)) {
+                    column.fComparator = std::move(comparator);
+                    column.fTTreeType = ttreeType;
+                    column.fRNTupleType = rntupleType;
+                }
+            }
+            column.fKey = std::find(request.fKeyColumns.begin(), request.fKeyColumns.end(), column.fName) != request.fKeyColumns.end();
+            if (column.fKey && (!exact || !isStatisticType(column.fTTreeType))) {
+                throw std::runtime_error("Key column must be a scalar column of the same type in both files: " + column.fName);
+            }
+
+            const bool selected = (request.fColumns.empty() || MatchesAny(request.fColumns, column.fName)) && !MatchesAny(request.fIgnore, column.fName);
+            if (!selected && !column.fKey) {
+                continue;
+            }
+            column.fCompare = (request.fValues || column.fKey) && sameEntries && (exact || column.fComparator);
+            for (const auto& tolerance : request.fTolerances) {
+                if (!column.fKey && fnmatch(tolerance.fPattern.c_str(), column.fName.c_str(), 0) == 0) {
+                    column.fAbsoluteTolerance = tolerance.fAbsolute;
+                    column.fRelativeTolerance = tolerance.fRelative;
+                    break;
+                }
+            }
+
+            column.fStatistics = request.fStatistics && selected
+                                 && (isStatisticType(column.fTTreeType) || isStatisticType(column.fRNTupleType)
+                                     || (column.fComparator && column.fComparator->fAccumulate));
+            if (column.fCompare || column.fStatistics) {
+                plan.fColumns.push_back(column);
+            }
+        }
+        for (const auto& key : request.fKeyColumns) {
+            if (std::none_of(plan.fColumns.begin(), plan.fColumns.end(), [&](const ScanColumn& column) { return column.fName == key; })) {
+                throw std::runtime_error("Key column not found in both files: " + key);
+            }
+        }
+        std::stable_partition(plan.fColumns.begin(), plan.fColumns.end(), [](const ScanColumn& column) { return column.fKey; });
+
+        // One schedule for both files, along the clusters of the RNTuple
+        std::vector<long long> clusterEnds;
+        const auto descriptor = FilePool::Instance().GetDescriptor(pair.fRNTupleFile, pair.fRNTupleName);
+        for (const auto& cluster : descriptor->GetClusterIterable()) {
+            clusterEnds.push_back(cluster.GetFirstEntryIndex() + cluster.GetNEntries());
+        }
+        if (!request.fSelection.empty()) {
+            plan.fSelection = Selection(request.fSelection);
+            for (const auto& name : plan.fSelection.GetColumns()) {
+                auto it = std::find_if(plan.fFieldTypes.begin(), plan.fFieldTypes.end(),
+                                       [&](const auto& types) { return std::get<0>(types) == name && std::get<1>(types) != "No match"; });
+                if (it == plan.fFieldTypes.end()) {
+                    throw std::runtime_error("Selection column not found in the TTree: " + name);
+                }
+                plan.fSelection.SetColumnType(name, MapFieldType(std::get<1>(*it)));
+            }
+        }
+
+        // Derived quantities are compiled once, with the types their columns have in each file
+        for (const auto& derived : request.fDerived) {
+            if (std::any_of(plan.fFieldTypes.begin(), plan.fFieldTypes.end(), [&](const auto& types) { return std::get<0>(types) == derived.fName; })) {
+                throw std::runtime_error("Derived quantity is named like a column: " + derived.fName);
+            }
+            ScanDerived compiled;
+            compiled.fName = derived.fName;
+            compiled.fExpression = Expression(derived.fExpression);
+            for (const auto& name : compiled.fExpression.GetColumns()) {
+                auto it = std::find_if(plan.fFieldTypes.begin(), plan.fFieldTypes.end(), [&](const auto& types) { return std::get<0>(types) == name; });
+                const std::string ttreeType = it == plan.fFieldTypes.end() || std::get<1>(*it) == "No match" ? "" : MapFieldType(std::get<1>(*it));
+                const std::string rntupleType = it == plan.fFieldTypes.end() || std::get<2>(*it) == "No match" ? "" : MapFieldType(std::get<2>(*it));
+                if (!isStatisticType(ttreeType) || !isStatisticType(rntupleType)) {
+                    throw std::runtime_error("Derived quantity " + derived.fName + " reads " + name + ", which is not a scalar column in both files");
+                }
+                compiled.fTTreeTypes.push_back(ttreeType);
+                compiled.fRNTupleTypes.push_back(rntupleType);
+            }
+            for (const auto& tolerance : request.fTolerances) {
+                if (fnmatch(tolerance.fPattern.c_str(), derived.fName.c_str(), 0) == 0) {
+                    compiled.fAbsoluteTolerance = tolerance.fAbsolute;
+                    compiled.fRelativeTolerance = tolerance.fRelative;
+                    break;
+                }
+            }
+            if (request.fValues && sameEntries) {
+                plan.fDerived.push_back(compiled);
+            }
+        }
+
+        if (!plan.fColumns.empty() || !plan.fDerived.empty()) {
+            plan.fRanges = ScheduleRanges(clusterEnds, std::max(plan.fEntries.first, plan.fEntries.second));
+        }
+        return plan;
+    }
+
+    ScanResult RunScan(const ScanPlan& plan, ScanVisitor* visitor, ScanControl* control) {
+        ScanResult result;
+        const auto start = std::chrono::steady_clock::now();
+
+        if (plan.fRequest.fStatistics && plan.fRequest.fHistograms) {
+            for (std::size_t k = 0; k < kStatisticTypes.size(); ++k) {
+                result.fTTreeStatistics[k].fHistogram = MakeHistogram("TTree", kStatisticTypes[k]);
+                result.fRNTupleStatistics[k].fHistogram = MakeHistogram("RNTuple", kStatisticTypes[k]);
+            }
+        }
+        if (plan.fRequest.fValues && plan.fEntries.first != plan.fEntries.second) {
+            result.fWarnings.push_back("Values not compared: the entry counts differ");
+        }
+
+        // Custom columns count in statistics of their own, filled by their comparators
+        std::vector<std::size_t> columnStatistics(plan.fColumns.size(), 0);
+        for (std::size_t c = 0; c < plan.fColumns.size(); ++c) {
+            if (plan.fColumns[c].fComparator && plan.fColumns[c].fStatistics) {
+                columnStatistics[c] = result.fColumnStatistics.size();
+                result.fColumnStatistics.push_back({ plan.fColumns[c].fName, ScanStatistics(), ScanStatistics() });
+            }
+        }
+
+        TTreeSource ttree(plan.fPair.fTTreeFile, plan.fPair.fTTreeName);
+        RNTupleSource rntuple(plan.fPair.fRNTupleFile, plan.fPair.fRNTupleName);
+        const long long ttreeEntries = plan.fEntries.first;
+        const long long rntupleEntries = plan.fEntries.second;
+
+        // First differing entry of each compared column and then of each derived quantity, and those that could not be read
+        const std::size_t nChecked = plan.fColumns.size() + plan.fDerived.size();
+        std::vector<long long> mismatch(nChecked, -1);
+        std::vector<bool> failed(nChecked, false);
+        std::vector<char> pass;                                    // Selection result of each entry of a range
+        const long long nScanned = plan.fRanges.empty() ? 0 : plan.fRanges.back().fFirst + plan.fRanges.back().fNEntries;
+        if (control) {
+            control->fEntriesTotal = nScanned;
+        }
+        for (const auto& range : plan.fRanges) {
+            if (control && control->fCancel) {
+                result.fCancelled = true;
+                result.fWarnings.push_back("Scan cancelled at entry " + std::to_string(range.fFirst) + " of " + std::to_string(nScanned)
+                                           + "; the statistics only cover the entries before");
+                break;
+            }
+            if (StopsScan(plan, mismatch, failed)) {
+                result.fWarnings.push_back("Scan stopped at entry " + std::to_string(range.fFirst) + " of " + std::to_string(nScanned)
+                                           + " by the fail-fast rule; the statistics only cover the entries before");
+                break;
+            }
+            // The selection is evaluated first; only the runs of entries passing it are read for the columns
+            std::vector<ScanRange> runs{ range };
+            if (!plan.fSelection.IsEmpty()) {
+                try {
+                    result.fNReads += plan.fSelection.Evaluate(ttree, range.fFirst, ClipRange(range, ttreeEntries), pass);
+                }
+                catch (const std::exception& e) {
+                    result.fIssues.push_back("Cannot evaluate the selection: " + std::string(e.what()));
+                    break;
+                }
+                runs = SelectedRuns(range.fFirst, pass);
+            }
+            for (const auto& run : runs) {
+                result.fNSelected += run.fNEntries;
+            }
+            if (visitor) {
+                visitor->OnRange(range);
+            }
+
+            for (std::size_t c = 0; c < plan.fColumns.size(); ++c) {
+                const ScanColumn& column = plan.fColumns[c];
+                MemoryPhase phase("Scan", column.fName);
+                for (const auto& run : runs) {
+                    if (failed[c]) {
+                        break;
+                    }
+                    ScanStatistics* ttreeStatistics = nullptr;
+                    ScanStatistics* rntupleStatistics = nullptr;
+                    if (column.fStatistics && column.fComparator) {
+                        ttreeStatistics = &result.fColumnStatistics[columnStatistics[c]].fTTree;
+                        rntupleStatistics = &result.fColumnStatistics[columnStatistics[c]].fRNTuple;
+                    }
+                    else if (column.fStatistics) {
+                        ttreeStatistics = FindStatistics(result.fTTreeStatistics, column.fTTreeType);
+                        rntupleStatistics = FindStatistics(result.fRNTupleStatistics, column.fRNTupleType);
+                    }
+                    const bool compare = column.fCompare && mismatch[c] < 0;
+                    if (!compare && !ttreeStatistics && !rntupleStatistics) {
+                        break; // Nothing left to do for this column
+                    }
+
+                    try {
+                        long long offset = -1;
+                        if (compare) {
+                            const std::string& type = column.fTTreeType;
+                            if (column.fComparator) offset = column.fComparator->fCompare(ttree, rntuple, column.fName, run.fFirst, run.fNEntries,
+                                                                                           ttreeStatistics, rntupleStatistics);
+                            else if (type == "int") offset = CompareScalar<int>(ttree, rntuple, column, run, ttreeStatistics, rntupleStatistics, visitor);
+                            else if (type == "float") offset = CompareScalar<float>(ttree, rntuple, column, run, ttreeStatistics, rntupleStatistics, visitor);
+                            else if (type == "double") offset = CompareScalar<double>(ttree, rntuple, column, run, ttreeStatistics, rntupleStatistics, visitor);
+                            else if (type == "bool") offset = CompareScalar<bool>(ttree, rntuple, column, run, ttreeStatistics, rntupleStatistics, visitor);
+                            else offset = FindFirstMismatch(type, ttree, run.fFirst, rntuple, run.fFirst, column.fName, run.fNEntries);
+                            result.fNReads += 2;
+                        }
+                        else if (column.fComparator) {
+                            result.fNReads += AccumulateCustom(*column.fComparator, ttree, column.fName, run.fFirst,
+                                                               ClipRange(run, ttreeEntries), ttreeStatistics);
+                            result.fNReads += AccumulateCustom(*column.fComparator, rntuple, column.fName, run.fFirst,
+                                                               ClipRange(run, rntupleEntries), rntupleStatistics);
+                        }
+                        else {
+                            result.fNReads += ReadForStatistics(ttree, column.fName, column.fTTreeType, run.fFirst,
+                                                                ClipRange(run, ttreeEntries), ttreeStatistics, { visitor, ScanSide::kTTree });
+                            result.fNReads += ReadForStatistics(rntuple, column.fName, column.fRNTupleType, run.fFirst,
+                                                                ClipRange(run, rntupleEntries), rntupleStatistics, { visitor, ScanSide::kRNTuple });
+                        }
+                        if (offset >= 0) {
+                            mismatch[c] = run.fFirst + offset;
+                            if (visitor) {
+                                visitor->OnMismatch({ column.fName, mismatch[c], column.fKey, false });
+                            }
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        failed[c] = true;
+                        result.fIssues.push_back("Cannot read " + column.fName + ": " + e.what());
+                        if (visitor) {
+                            visitor->OnError(column.fName, e.what());
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t d = 0; d < plan.fDerived.size(); ++d) {
+                const std::size_t c = plan.fColumns.size() + d;
+                MemoryPhase phase("Scan", plan.fDerived[d].fName);
+                for (const auto& run : runs) {
+                    if (failed[c] || mismatch[c] >= 0) {
+                        break;
+                    }
+                    try {
+                        const long long offset = CompareDerived(ttree, rntuple, plan.fDerived[d], run, visitor);
+                        result.fNReads += 2 * plan.fDerived[d].fExpression.GetColumns().size();
+                        if (offset >= 0) {
+                            mismatch[c] = run.fFirst + offset;
+                            if (visitor) {
+                                visitor->OnMismatch({ plan.fDerived[d].fName, mismatch[c], false, true });
+                            }
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        failed[c] = true;
+                        result.fIssues.push_back("Cannot compute " + plan.fDerived[d].fName + ": " + e.what());
+                        if (visitor) {
+                            visitor->OnError(plan.fDerived[d].fName, e.what());
+                        }
+                    }
+                }
+            }
+            if (control) {
+                control->fEntriesDone = range.fFirst + range.fNEntries;
+            }
+        }
+
+        for (std::size_t c = 0; c < plan.fColumns.size(); ++c) {
+            if (plan.fColumns[c].fCompare && !failed[c]) {
+                ++result.fNCompared;
+                if (mismatch[c] >= 0) {
+                    std::string issue = (plan.fColumns[c].fKey ? "Key column " : "") + plan.fColumns[c].fName + " differs at entry "
+                                        + std::to_string(mismatch[c]);
+                    if (!plan.fColumns[c].fKey) {
+                        try {
+                            issue += DescribeKeys(ttree, plan, mismatch[c]);
+                        }
+                        catch (const std::exception&) {
+                            // Reported without the keys; a key column that cannot be read is an issue of its own
+                        }
+                    }
+                    result.fIssues.push_back(issue);
+                }
+            }
+        }
+        for (std::size_t d = 0; d < plan.fDerived.size(); ++d) {
+            const std::size_t c = plan.fColumns.size() + d;
+            if (failed[c]) {
+                continue;
+            }
+            ++result.fNCompared;
+            if (mismatch[c] >= 0) {
+                std::string issue = "Derived quantity " + plan.fDerived[d].fName + " differs at entry " + std::to_string(mismatch[c]);
+                try {
+                    issue += DescribeKeys(ttree, plan, mismatch[c]);
+                }
+                catch (const std::exception&) {
+                    // Reported without the keys, as for the columns
+                }
+                result.fIssues.push_back(issue);
+            }
+        }
+
+        result.fPassed = result.fIssues.empty() && !result.fCancelled;
+        result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+} // namespace Checker
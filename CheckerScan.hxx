@@ -0,0 +1,285 @@
+/// \file CheckerScan.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERSCAN_HXX
+#define CHECKERSCAN_HXX
+
+#include "CheckerBatch.hxx"
+#include "CheckerExpression.hxx"
+#include "CheckerSelection.hxx"
+
+#include <TH1.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief When a scan stops before the end of the files.
+     */
+    enum class FailFast {
+        kNever,
+        kAnyIssue,   // After the range in which the first column differs or cannot be read
+        kKeyColumns  // After the range in which a key column differs: the entries no longer line up
+    };
+
+    /**
+     * @brief How close the values of the columns matching a pattern must be.
+     *
+     * Two values are equal if |a - b| <= fAbsolute + fRelative * max(|a|, |b|). Applies to scalar columns.
+     */
+    struct ColumnTolerance {
+        std::string fPattern; // Column name or shell pattern, e.g. "jet_*"
+        double fAbsolute = 0;
+        double fRelative = 0;
+    };
+
+    /**
+     * @brief The engine that reads the payload of a scan.
+     */
+    enum class ScanEngine {
+        kNative,    // RunScan: the columns are read range by range through ColumnSource
+        kDataFrame  // RunFrameScan: one RDataFrame event loop per file, on ROOT's implicit multi-threading
+    };
+
+    /**
+     * @brief A quantity computed from the columns of each entry, e.g. pt = sqrt(px*px + py*py), and compared as
+     *        if it were a column.
+     */
+    struct DerivedQuantity {
+        std::string fName;
+        std::string fExpression; // Of scalar columns, see Expression
+    };
+
+    /**
+     * @brief The checks a scan runs, and how each column is treated.
+     *
+     * The structural checks only need metadata. The value comparison and the statistics need the payload;
+     * they share one pass over both files, so every column is read once however many checks use it.
+     * Column names in the lists may be shell patterns.
+     */
+    struct ScanRequest {
+        bool fStructure = true;  // Entry counts, field counts, names and types
+        bool fValues = true;     // Entry by entry comparison of every column whose type matches exactly
+        bool fStatistics = true; // Entries, mean and standard deviation of all values of each scalar type
+        bool fHistograms = true; // A histogram per scalar type, filled with the statistics
+        std::vector<std::string> fColumns;         // Columns compared and counted in the statistics; empty for all
+        std::vector<std::string> fIgnore;          // Columns never read, even if listed in fColumns
+        std::vector<std::string> fKeyColumns;      // Read first in every range, always compared exactly, and printed with every difference
+        std::vector<ColumnTolerance> fTolerances;  // The first matching pattern applies
+        FailFast fFailFast = FailFast::kNever;
+        std::string fSelection;                    // Only entries passing this cut (see Selection) are compared and counted
+        std::vector<DerivedQuantity> fDerived;     // Compared in addition to the columns
+        ScanEngine fEngine = ScanEngine::kNative;
+    };
+
+    struct CustomComparator;
+
+    /**
+     * @brief A column read by the scan.
+     */
+    struct ScanColumn {
+        std::string fName;
+        std::string fTTreeType;   // Common type in the TTree (see MapFieldType), empty if the TTree has no such column
+        std::string fRNTupleType; // Common type in the RNTuple, empty if the RNTuple has no such column
+        std::shared_ptr<const CustomComparator> fComparator; // For a custom type (see RegisterComparator); the types are then the stored ones
+        bool fCompare = false;    // Compared value by value; both types are then the same
+        bool fStatistics = false; // Counted in the statistics of its type
+        bool fKey = false;        // A key column of the request
+        double fAbsoluteTolerance = 0;
+        double fRelativeTolerance = 0;
+    };
+
+    /**
+     * @brief A derived quantity of the request, compiled and with the types of its columns in both files.
+     */
+    struct ScanDerived {
+        std::string fName;
+        Expression fExpression;
+        std::vector<std::string> fTTreeTypes;   // Common type of each column of the expression in the TTree
+        std::vector<std::string> fRNTupleTypes; // The same for the RNTuple
+        double fAbsoluteTolerance = 0;
+        double fRelativeTolerance = 0;
+    };
+
+    /**
+     * @brief Entries [fFirst, fFirst + fNEntries) of both files.
+     */
+    struct ScanRange {
+        long long fFirst = 0;
+        long long fNEntries = 0;
+    };
+
+    /**
+     * @brief The metadata of a pair and the I/O schedule of its scan.
+     */
+    struct ScanPlan {
+        PairSpec fPair;
+        ScanRequest fRequest;
+        std::pair<int, int> fEntries;                                              // As returned by Checker::CountEntries
+        std::pair<int, int> fFields;                                               // Checker::CountFields, with fStructure
+        std::vector<std::pair<std::string, std::string>> fFieldNames;              // Checker::CompareFieldNames, with fStructure
+        std::vector<std::tuple<std::string, std::string, std::string>> fFieldTypes; // Checker::CompareFieldTypes
+        std::vector<ScanColumn> fColumns; // Columns needed by the value comparison or the statistics, key columns first
+        std::vector<ScanDerived> fDerived; // Compared after the columns of each range
+        std::vector<ScanRange> fRanges;   // Entry ranges read one after the other, each for all columns
+        Selection fSelection;             // Evaluated on the TTree at the start of every range
+    };
+
+    /**
+     * @brief Entries, mean and standard deviation of all values of one type in one file, and their histogram.
+     */
+    struct ScanStatistics {
+        long long fEntries = 0;
+        double fMean = 0;
+        double fSumSquares = 0;          // Of the differences to the mean
+        std::shared_ptr<TH1> fHistogram; // Set by RunScan when statistics are requested
+
+        void Fill(double value);
+        double GetStdDev() const;
+
+        /**
+         * @brief Returns (entries, mean, standard deviation), as CheckerCLI::HistogramDrawStat takes them.
+         */
+        std::tuple<int, double, double> GetSummary() const;
+    };
+
+    /**
+     * @brief The statistics of one column of a custom type, filled by the fAccumulate of its comparator.
+     */
+    struct ColumnStatistics {
+        std::string fColumn;
+        ScanStatistics fTTree;
+        ScanStatistics fRNTuple;
+    };
+
+    /**
+     * @brief Outcome of a scan.
+     */
+    struct ScanResult {
+        bool fPassed = false;               // No value differs, every column could be read and the scan was not cancelled
+        std::size_t fNCompared = 0;         // Columns compared value by value
+        std::vector<std::string> fIssues;   // Columns whose values differ, or that could not be read
+        std::vector<std::string> fWarnings;
+        std::array<ScanStatistics, 4> fTTreeStatistics;   // int, float, double and bool values of the TTree
+        std::array<ScanStatistics, 4> fRNTupleStatistics; // The same for the RNTuple
+        std::vector<ColumnStatistics> fColumnStatistics;  // Custom columns whose comparator accumulates statistics
+        std::size_t fNReads = 0;            // Reads of one column of one file over one range or run of selected entries
+        long long fNSelected = 0;           // Entries scanned, after the selection
+        bool fCancelled = false;            // Stopped by ScanControl::fCancel; the scan then has not passed
+        double fSeconds = 0;
+    };
+
+    /**
+     * @brief The file a batch of values was read from.
+     */
+    enum class ScanSide { kTTree, kRNTuple };
+
+    /**
+     * @brief The first difference of a column or derived quantity, as soon as the scan finds it.
+     */
+    struct ScanMismatch {
+        std::string fName;     // Column or derived quantity
+        long long fEntry = -1; // First differing entry
+        bool fKey = false;     // A key column: the entries after it no longer line up
+        bool fDerived = false;
+    };
+
+    /**
+     * @brief Receives what RunScan reads and finds while it runs, instead of waiting for the ScanResult.
+     *
+     * Every function does nothing by default, so a visitor overrides only what it needs; with the statistics
+     * and histograms switched off in the request, the scan builds nothing else. The batches are the scan's own
+     * buffers, valid only during the call. All calls come from the thread running the scan.
+     */
+    class ScanVisitor {
+    public:
+        virtual ~ScanVisitor() = default;
+
+        /// Before the columns of a range are read, after its selection
+        virtual void OnRange(const ScanRange& /*range*/) {}
+
+        /// Each batch of a scalar column or derived quantity read by the scan, entries [first, first + values.size())
+        /// or, with a selection, one run of selected entries
+        virtual void OnBatch(ScanSide /*side*/, const std::string& /*name*/, long long /*first*/, const std::vector<int>& /*values*/) {}
+        virtual void OnBatch(ScanSide /*side*/, const std::string& /*name*/, long long /*first*/, const std::vector<float>& /*values*/) {}
+        virtual void OnBatch(ScanSide /*side*/, const std::string& /*name*/, long long /*first*/, const std::vector<double>& /*values*/) {}
+        virtual void OnBatch(ScanSide /*side*/, const std::string& /*name*/, long long /*first*/, const std::vector<bool>& /*values*/) {}
+
+        /// Once per column or derived quantity, at its first difference
+        virtual void OnMismatch(const ScanMismatch& /*mismatch*/) {}
+
+        /// A column that cannot be read or a derived quantity that cannot be computed; it is not read again
+        virtual void OnError(const std::string& /*name*/, const std::string& /*message*/) {}
+    };
+
+    /**
+     * @brief Shared between a running scan and other threads: its progress, and a request to stop it.
+     */
+    struct ScanControl {
+        std::atomic<bool> fCancel{ false };         // Set from any thread; the scan stops before its next range
+        std::atomic<long long> fEntriesDone{ 0 };   // End of the last range scanned, set by the scan
+        std::atomic<long long> fEntriesTotal{ 0 };  // End of the last range of the plan, set when the scan starts
+    };
+
+    /**
+     * @brief Collects the metadata the requested checks need and schedules the scan, without reading any payload.
+     *
+     * The column list is the union of what the checks need: every selected column of matching type for the
+     * value comparison, and every selected int, float, double and bool column of either file for the statistics.
+     * A column of a type the Checker does not know is compared if both files store it as types that the same
+     * registered comparator matches (see RegisterComparator).
+     * The key columns come first, and each column carries its tolerance. Values are only compared if both files
+     * have the same number of entries.
+     *
+     * The entry ranges follow the clusters of the RNTuple: small clusters are merged and large ones cut, so that
+     * no range is longer than kBatchEntries, and all columns are read for a range before the next one starts.
+     * Both files are thus walked once, front to back, instead of once per check and column.
+     *
+     * @throws std::runtime_error if either side cannot be opened, a key column is not a scalar column of the
+     *         same type in both files, the selection is malformed or names a column the TTree lacks, or a derived
+     *         quantity is malformed, named like a column or reads a column that is not scalar in both files.
+     */
+    ScanPlan PlanScan(const PairSpec& pair, const ScanRequest& request = ScanRequest());
+
+    /**
+     * @brief Runs the scan of a plan: reads every range of every column once from each file, and feeds the
+     *        values to the comparison and the statistics.
+     *
+     * With a selection, its columns are read first for every range, and the other columns only for the runs of
+     * entries that pass it; a range without such entries costs no more than the selection.
+     *
+     * A difference is reported at the first differing entry of the column, with the values of the key columns
+     * at that entry. A run stopped by the fail-fast rule says so in a warning; its statistics then only cover
+     * the ranges read. Derived quantities are computed batch by batch from their columns in each file and
+     * compared like columns, with the tolerance matching their name.
+     *
+     * @param visitor Gets the batches and differences as the scan proceeds, if set.
+     * @param control Receives the progress and may cancel the scan, if set. A cancelled scan says so in a
+     *                warning and covers only the ranges read, like one stopped by the fail-fast rule.
+     * @throws std::runtime_error if either side cannot be opened.
+     */
+    ScanResult RunScan(const ScanPlan& plan, ScanVisitor* visitor = nullptr, ScanControl* control = nullptr);
+
+} // namespace Checker
+
+#endif // CHECKERSCAN_HXX
@@ -0,0 +1,199 @@
+/// \file CheckerSelection.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerSelection.hxx"
+#include "CheckerBuffers.hxx"
+#include "CheckerSource.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <stdexcept>
+
+namespace Checker {
+
+    namespace {
+
+        // Splits "a >= 2 && b<3" into "a", ">=", "2", "&&", "b", "<", "3"
+        std::vector<std::string> Tokenize(const std::string& expression) {
+            std::vector<std::string> tokens;
+            std::size_t i = 0;
+            while (i < expression.size()) {
+                const char c = expression[i];
+                if (std::isspace(static_cast<unsigned char>(c))) {
+                    ++i;
+                }
+                else if (std::string("<>=!&").find(c) != std::string::npos) {
+                    const std::size_t length = i + 1 < expression.size() && std::string("=&").find(expression[i + 1]) != std::string::npos ? 2 : 1;
+                    tokens.push_back(expression.substr(i, length));
+                    i += length;
+                }
+                else {
+                    const std::size_t start = i;
+                    while (i < expression.size() && !std::isspace(static_cast<unsigned char>(expression[i]))
+                           && std::string("<>=!&").find(expression[i]) == std::string::npos) {
+                        ++i;
+                    }
+                    tokens.push_back(expression.substr(start, i - start));
+                }
+            }
+            return tokens;
+        }
+
+        bool ParseNumber(const std::string& token, double& value) {
+            std::size_t end = 0;
+            try {
+                value = std::stod(token, &end);
+            }
+            catch (const std::exception&) {
+                return false;
+            }
+            return end == token.size();
+        }
+
+        template <typename T, typename Op>
+        void Apply(ColumnSource& source, const std::string& column, long long first, long long n, std::vector<char>& pass, Op&& test) {
+            PooledBuffer<T> values;
+            source.Read(column, first, n, *values);
+            for (long long k = 0; k < n; ++k) {
+                pass[k] = pass[k] && test(static_cast<double>((*values)[k]));
+            }
+        }
+
+    } // namespace
+
+    Selection::Selection(const std::string& expression) : fExpression(expression) {
+        const auto tokens = Tokenize(expression);
+        const auto fail = [&](const std::string& message) {
+            throw std::runtime_error("Malformed selection '" + expression + "': " + message);
+        };
+        const auto parseOperator = [&](const std::string& token, bool swapped) {
+            if (token == "==") return Operator::kEqual;
+            if (token == "!=") return Operator::kNotEqual;
+            if (token == "<") return swapped ? Operator::kGreater : Operator::kLess;
+            if (token == "<=") return swapped ? Operator::kGreaterEqual : Operator::kLessEqual;
+            if (token == ">") return swapped ? Operator::kLess : Operator::kGreater;
+            if (token == ">=") return swapped ? Operator::kLessEqual : Operator::kGreaterEqual;
+            fail("expected a comparison operator, got '" + token + "'");
+            return Operator::kEqual;
+        };
+
+        for (std::size_t i = 0; i < tokens.size(); i += 4) {
+            if (i + 3 > tokens.size()) {
+                fail("expected <column> <operator> <number>");
+            }
+            Condition condition;
+            if (ParseNumber(tokens[i], condition.fValue)) {
+                condition.fColumn = tokens[i + 2];
+                condition.fOperator = parseOperator(tokens[i + 1], true);
+            }
+            else if (ParseNumber(tokens[i + 2], condition.fValue)) {
+                condition.fColumn = tokens[i];
+                condition.fOperator = parseOperator(tokens[i + 1], false);
+            }
+            else {
+                fail("each comparison needs one number");
+            }
+            double ignored;
+            if (ParseNumber(condition.fColumn, ignored)) {
+                fail("each comparison needs one column");
+            }
+            fConditions.push_back(condition);
+
+            if (i + 3 < tokens.size() && tokens[i + 3] != "&&" && tokens[i + 3] != "and") {
+                fail("comparisons must be joined by &&, got '" + tokens[i + 3] + "'");
+            }
+            if (i + 3 == tokens.size() - 1) {
+                fail("expression ends with " + tokens[i + 3]);
+            }
+        }
+
+        // Conditions on the same column are evaluated on one read, in the order the columns first appear
+        std::vector<Condition> grouped;
+        for (const auto& condition : fConditions) {
+            const bool seen = std::any_of(grouped.begin(), grouped.end(), [&](const Condition& c) { return c.fColumn == condition.fColumn; });
+            if (seen) {
+                continue;
+            }
+            std::copy_if(fConditions.begin(), fConditions.end(), std::back_inserter(grouped),
+                         [&](const Condition& c) { return c.fColumn == condition.fColumn; });
+        }
+        fConditions.swap(grouped);
+    }
+
+    std::vector<std::string> Selection::GetColumns() const {
+        std::vector<std::string> columns;
+        for (const auto& condition : fConditions) {
+            if (columns.empty() || columns.back() != condition.fColumn) {
+                columns.push_back(condition.fColumn);
+            }
+        }
+        return columns;
+    }
+
+    void Selection::SetColumnType(const std::string& column, const std::string& type) {
+        if (type != "int" && type != "float" && type != "double" && type != "bool") {
+            throw std::runtime_error("Selection column must be an int, float, double or bool column: " + column + " is " + type);
+        }
+        for (auto& condition : fConditions) {
+            if (condition.fColumn == column) {
+                condition.fType = type;
+            }
+        }
+    }
+
+    std::size_t Selection::Evaluate(ColumnSource& source, long long first, long long n, std::vector<char>& pass) const {
+        pass.assign(n, 1);
+        std::size_t nReads = 0;
+        for (std::size_t i = 0; i < fConditions.size();) {
+            if (std::find(pass.begin(), pass.end(), 1) == pass.end()) {
+                break; // No entry left to test
+            }
+
+            // All conditions on this column in one read
+            std::size_t end = i;
+            while (end < fConditions.size() && fConditions[end].fColumn == fConditions[i].fColumn) {
+                ++end;
+            }
+            const auto test = [&](double value) {
+                for (std::size_t k = i; k < end; ++k) {
+                    const double bound = fConditions[k].fValue;
+                    bool holds = false;
+                    switch (fConditions[k].fOperator) {
+                    case Operator::kLess: holds = value < bound; break;
+                    case Operator::kLessEqual: holds = value <= bound; break;
+                    case Operator::kGreater: holds = value > bound; break;
+                    case Operator::kGreaterEqual: holds = value >= bound; break;
+                    case Operator::kEqual: holds = value == bound; break;
+                    case Operator::kNotEqual: holds = value != bound; break;
+                    }
+                    if (!holds) return false;
+                }
+                return true;
+            };
+
+            const std::string& column = fConditions[i].fColumn;
+            const std::string& type = fConditions[i].fType;
+            if (type == "int") Apply<int>(source, column, first, n, pass, test);
+            else if (type == "float") Apply<float>(source, column, first, n, pass, test);
+            else if (type == "bool") Apply<bool>(source, column, first, n, pass, test);
+            else Apply<double>(source, column, first, n, pass, test);
+            ++nReads;
+            i = end;
+        }
+        return nReads;
+    }
+
+} // namespace Checker
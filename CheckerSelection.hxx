@@ -0,0 +1,83 @@
+/// \file CheckerSelection.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERSELECTION_HXX
+#define CHECKERSELECTION_HXX
+
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    class ColumnSource;
+
+    /**
+     * @brief A cut on the entries of a scan: comparisons of scalar columns with numbers, all of which must hold.
+     *
+     *     nJet > 2 && run >= 355100 && run <= 355200
+     *
+     * The operators are <, <=, >, >=, == and !=; `and` may be written for &&. The column may also stand on the
+     * right, as in `2 < nJet`.
+     */
+    class Selection {
+    public:
+        Selection() = default;
+
+        /**
+         * @throws std::runtime_error if the expression is malformed.
+         */
+        explicit Selection(const std::string& expression);
+
+        bool IsEmpty() const { return fConditions.empty(); }
+        const std::string& GetExpression() const { return fExpression; }
+
+        /**
+         * @brief Returns the columns the selection reads, each once, in the order they are evaluated.
+         */
+        std::vector<std::string> GetColumns() const;
+
+        /**
+         * @brief Sets the common type (see MapFieldType) a column is read as.
+         *
+         * @throws std::runtime_error unless the type is int, float, double or bool.
+         */
+        void SetColumnType(const std::string& column, const std::string& type);
+
+        /**
+         * @brief Sets pass[k] to whether entry first + k passes, for entries [first, first + n).
+         *
+         * The columns are read one after the other, and the remaining ones not at all once no entry passes.
+         *
+         * @return The number of columns read.
+         */
+        std::size_t Evaluate(ColumnSource& source, long long first, long long n, std::vector<char>& pass) const;
+
+    private:
+        enum class Operator { kLess, kLessEqual, kGreater, kGreaterEqual, kEqual, kNotEqual };
+
+        struct Condition {
+            std::string fColumn;
+            std::string fType = "double";
+            Operator fOperator = Operator::kEqual;
+            double fValue = 0;
+        };
+
+        std::string fExpression;
+        std::vector<Condition> fConditions; // Grouped by column
+    };
+
+} // namespace Checker
+
+#endif // CHECKERSELECTION_HXX
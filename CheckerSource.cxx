@@ -0,0 +1,406 @@
+/// \file CheckerSource.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerSource.hxx"
+#include "CheckerBatch.hxx"
+#include "CheckerCLI.hxx"
+#include "CheckerFilePool.hxx"
+
+#include <ROOT/RField.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <TBranch.h>
+#include <TClass.h>
+#include <TLeaf.h>
+#include <TROOT.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace Checker {
+
+    TTreeSource::TTreeSource(const std::string& file, const std::string& name)
+        : fPath(file), fName(name), fFile(FilePool::Instance().GetFile(file)) {
+        if (!fFile) {
+            throw std::runtime_error("Cannot open TTree file: " + file);
+        }
+        fTree = fFile->Get<TTree>(name.c_str());
+        if (!fTree) {
+            throw std::runtime_error("Cannot find TTree: " + name + " in file: " + file);
+        }
+    }
+
+    long long TTreeSource::GetNEntries() {
+        return fTree->GetEntries();
+    }
+
+    std::vector<std::pair<std::string, std::string>> TTreeSource::GetColumns() {
+        std::vector<std::pair<std::string, std::string>> columns;
+        const auto branches = fTree->GetListOfBranches();
+        for (int i = 0; i < branches->GetEntries(); ++i) {
+            const auto branch = dynamic_cast<TBranch*>(branches->At(i));
+            if (!branch) {
+                continue;
+            }
+            const std::string branchName = branch->GetName();
+            const auto leaf = branch->GetLeaf(branchName.c_str());
+            columns.emplace_back(branchName, leaf ? leaf->GetTypeName() : "");
+        }
+        return columns;
+    }
+
+    template <typename T>
+    void TTreeSource::ReadRange(const std::string& column, long long first, long long n, std::vector<T>& values) {
+        TBranch* branch = fTree->GetBranch(column.c_str());
+        if (!branch) {
+            throw std::runtime_error("Cannot find branch: " + column + " in " + GetDescription());
+        }
+        T value;
+        branch->SetAddress(&value);
+        values.clear();
+        for (long long j = first; j < first + n; ++j) {
+            branch->GetEntry(j);
+            values.push_back(value);
+        }
+        branch->ResetAddress();
+    }
+
+    void TTreeSource::Read(const std::string& column, long long first, long long n, std::vector<int>& values) { ReadRange(column, first, n, values); }
+    void TTreeSource::Read(const std::string& column, long long first, long long n, std::vector<float>& values) { ReadRange(column, first, n, values); }
+    void TTreeSource::Read(const std::string& column, long long first, long long n, std::vector<double>& values) { ReadRange(column, first, n, values); }
+    void TTreeSource::Read(const std::string& column, long long first, long long n, std::vector<bool>& values) { ReadRange(column, first, n, values); }
+
+    template <typename T>
+    void TTreeSource::ReadVectorRange(const std::string& column, long long first, long long n, std::vector<T>& values, std::vector<std::size_t>& sizes) {
+        TBranch* branch = fTree->GetBranch(column.c_str());
+        if (!branch) {
+            throw std::runtime_error("Cannot find branch: " + column + " in " + GetDescription());
+        }
+        PooledBuffer<T> entryValues(0);
+        std::vector<T>* vec = entryValues.Get();
+        branch->SetAddress(&vec);
+        values.clear();
+        sizes.clear();
+        for (long long j = first; j < first + n; ++j) {
+            branch->GetEntry(j);
+            values.insert(values.end(), vec->begin(), vec->end());
+            sizes.push_back(vec->size());
+        }
+        branch->ResetAddress();
+    }
+
+    void TTreeSource::ReadVector(const std::string& column, long long first, long long n, std::vector<int>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(column, first, n, values, sizes); }
+    void TTreeSource::ReadVector(const std::string& column, long long first, long long n, std::vector<float>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(column, first, n, values, sizes); }
+    void TTreeSource::ReadVector(const std::string& column, long long first, long long n, std::vector<double>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(column, first, n, values, sizes); }
+    void TTreeSource::ReadVector(const std::string& column, long long first, long long n, std::vector<bool>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(column, first, n, values, sizes); }
+
+    void TTreeSource::ReadObjects(const std::string& column, long long first, long long n, const std::function<void(const void*)>& visit) {
+        TBranch* branch = fTree->GetBranch(column.c_str());
+        if (!branch) {
+            throw std::runtime_error("Cannot find branch: " + column + " in " + GetDescription());
+        }
+        TClass* objectClass = nullptr;
+        EDataType dataType = kOther_t;
+        if (branch->GetExpectedType(objectClass, dataType) != 0) {
+            throw std::runtime_error("Cannot tell the type of branch: " + column + " in " + GetDescription());
+        }
+
+        if (objectClass) {
+            // Objects are read through a pointer to an instance owned here
+            void* object = objectClass->New();
+            branch->SetAddress(&object);
+            for (long long j = first; j < first + n; ++j) {
+                branch->GetEntry(j);
+                visit(object);
+            }
+            branch->ResetAddress();
+            objectClass->Destructor(object);
+        }
+        else {
+            alignas(std::max_align_t) unsigned char value[sizeof(std::max_align_t)];
+            branch->SetAddress(value);
+            for (long long j = first; j < first + n; ++j) {
+                branch->GetEntry(j);
+                visit(value);
+            }
+            branch->ResetAddress();
+        }
+    }
+
+    RNTupleSource::RNTupleSource(const std::string& file, const std::string& name)
+        : fPath(file), fName(name), fDescriptor(FilePool::Instance().GetDescriptor(file, name)) {}
+
+    std::unique_ptr<ROOT::Experimental::RNTupleReader> RNTupleSource::OpenReader(std::unique_ptr<ROOT::Experimental::RNTupleModel> model) {
+        if (!fFile) {
+            fFile = FilePool::Instance().GetFile(fPath);
+        }
+        if (!fFile || fFile->IsZombie()) {
+            throw std::runtime_error("Cannot open RNTuple file: " + fPath);
+        }
+        return OpenRNTupleReader(*fFile, fName, std::move(model));
+    }
+
+    long long RNTupleSource::GetNEntries() {
+        return fDescriptor->GetNEntries();
+    }
+
+    std::vector<std::pair<std::string, std::string>> RNTupleSource::GetColumns() {
+        std::vector<std::pair<std::string, std::string>> columns;
+        const int fieldCount = fDescriptor->GetNFields();
+        for (int i = 0; i < fieldCount - 1; ++i) {
+            try {
+                const auto& fieldDescriptor = fDescriptor->GetFieldDescriptor(i);
+                const std::string& fieldName = fieldDescriptor.GetFieldName();
+                if (fieldName != "_0") { // Skip fields named "_0"
+                    columns.emplace_back(fieldName, fieldDescriptor.GetTypeName());
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error accessing field descriptor at index " << i << ": " << e.what() << std::endl;
+            }
+        }
+        return columns;
+    }
+
+    template <typename T>
+    void RNTupleSource::ReadRange(std::map<std::string, View<T>>& views, const std::string& column, long long first, long long n, std::vector<T>& values) {
+        if (!fReader) {
+            fReader = OpenReader();
+        }
+        auto it = views.find(column);
+        if (it == views.end()) {
+            it = views.emplace(column, fReader->GetView<T>(column)).first;
+        }
+        values.clear();
+        for (long long j = first; j < first + n; ++j) {
+            values.push_back(it->second(j));
+        }
+    }
+
+    void RNTupleSource::Read(const std::string& column, long long first, long long n, std::vector<int>& values) { ReadRange(fIntViews, column, first, n, values); }
+    void RNTupleSource::Read(const std::string& column, long long first, long long n, std::vector<float>& values) { ReadRange(fFloatViews, column, first, n, values); }
+    void RNTupleSource::Read(const std::string& column, long long first, long long n, std::vector<double>& values) { ReadRange(fDoubleViews, column, first, n, values); }
+    void RNTupleSource::Read(const std::string& column, long long first, long long n, std::vector<bool>& values) { ReadRange(fBoolViews, column, first, n, values); }
+
+    template <typename T>
+    void RNTupleSource::ReadVectorRange(std::map<std::string, View<std::vector<T>>>& views, const std::string& column, long long first, long long n,
+                                        std::vector<T>& values, std::vector<std::size_t>& sizes) {
+        if (!fReader) {
+            fReader = OpenReader();
+        }
+        auto it = views.find(column);
+        if (it == views.end()) {
+            it = views.emplace(column, fReader->GetView<std::vector<T>>(column)).first;
+        }
+        values.clear();
+        sizes.clear();
+        for (long long j = first; j < first + n; ++j) {
+            const auto& vec = it->second(j);
+            values.insert(values.end(), vec.begin(), vec.end());
+            sizes.push_back(vec.size());
+        }
+    }
+
+    void RNTupleSource::ReadVector(const std::string& column, long long first, long long n, std::vector<int>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(fIntVectorViews, column, first, n, values, sizes); }
+    void RNTupleSource::ReadVector(const std::string& column, long long first, long long n, std::vector<float>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(fFloatVectorViews, column, first, n, values, sizes); }
+    void RNTupleSource::ReadVector(const std::string& column, long long first, long long n, std::vector<double>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(fDoubleVectorViews, column, first, n, values, sizes); }
+    void RNTupleSource::ReadVector(const std::string& column, long long first, long long n, std::vector<bool>& values, std::vector<std::size_t>& sizes) { ReadVectorRange(fBoolVectorViews, column, first, n, values, sizes); }
+
+    void RNTupleSource::ReadObjects(const std::string& column, long long first, long long n, const std::function<void(const void*)>& visit) {
+        // A reader whose model holds only this field, created from its stored type name, so that its entry holds one object
+        auto it = fObjectReaders.find(column);
+        if (it == fObjectReaders.end()) {
+            const auto fieldId = fDescriptor->FindFieldId(column);
+            if (fieldId == ROOT::Experimental::kInvalidDescriptorId) {
+                throw std::runtime_error("Cannot find field: " + column + " in " + GetDescription());
+            }
+            auto model = ROOT::Experimental::RNTupleModel::Create();
+            model->AddField(ROOT::Experimental::RFieldBase::Create(column, fDescriptor->GetFieldDescriptor(fieldId).GetTypeName()).Unwrap());
+            it = fObjectReaders.emplace(column, OpenReader(std::move(model))).first;
+        }
+        auto& reader = *it->second;
+        const auto object = reader.GetModel().GetDefaultEntry().GetPtr<void>(column);
+        for (long long j = first; j < first + n; ++j) {
+            reader.LoadEntry(j);
+            visit(object.get());
+        }
+    }
+
+    SourceKind DetectSourceKind(const std::string& file, const std::string& name) {
+        const auto ttrees = ListTTrees(file);
+        if (std::find(ttrees.begin(), ttrees.end(), name) != ttrees.end()) {
+            return SourceKind::kTTree;
+        }
+        const auto rntuples = ListRNTuples(file);
+        if (std::find(rntuples.begin(), rntuples.end(), name) != rntuples.end()) {
+            return SourceKind::kRNTuple;
+        }
+        throw std::runtime_error("Cannot find TTree or RNTuple: " + name + " in file: " + file);
+    }
+
+    std::unique_ptr<ColumnSource> OpenSource(const SourceSpec& spec) {
+        if (spec.fKind == SourceKind::kTTree) {
+            return std::make_unique<TTreeSource>(spec.fFile, spec.fName);
+        }
+        return std::make_unique<RNTupleSource>(spec.fFile, spec.fName);
+    }
+
+    long long FindFirstMismatch(const std::string& type, ColumnSource& a, long long firstA, ColumnSource& b, long long firstB,
+                                const std::string& column, long long n) {
+        if (type == "int") return FindFirstMismatch<int>(a, firstA, b, firstB, column, n);
+        if (type == "float") return FindFirstMismatch<float>(a, firstA, b, firstB, column, n);
+        if (type == "double") return FindFirstMismatch<double>(a, firstA, b, firstB, column, n);
+        if (type == "bool") return FindFirstMismatch<bool>(a, firstA, b, firstB, column, n);
+        if (type == "vector<int>") return FindFirstVectorMismatch<int>(a, firstA, b, firstB, column, n);
+        if (type == "vector<float>") return FindFirstVectorMismatch<float>(a, firstA, b, firstB, column, n);
+        if (type == "vector<double>") return FindFirstVectorMismatch<double>(a, firstA, b, firstB, column, n);
+        if (type == "vector<bool>") return FindFirstVectorMismatch<bool>(a, firstA, b, firstB, column, n);
+        throw std::runtime_error("Cannot compare values of type: " + type);
+    }
+
+    SourceResult CompareSources(const SourceSpec& a, const SourceSpec& b, unsigned nThreads, Checkpoint* checkpoint) {
+        SourceResult result;
+        const auto start = std::chrono::steady_clock::now();
+        auto finish = [&]() {
+            result.fPassed = result.fIssues.empty();
+            result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        };
+
+        auto sourceA = OpenSource(a);
+        auto sourceB = OpenSource(b);
+        result.fEntriesA = sourceA->GetNEntries();
+        result.fEntriesB = sourceB->GetNEntries();
+        if (result.fEntriesA != result.fEntriesB) {
+            result.fIssues.push_back("Entry count differs: " + std::to_string(result.fEntriesA) + " (" + sourceA->GetDescription()
+                                     + ") vs " + std::to_string(result.fEntriesB) + " (" + sourceB->GetDescription() + ")");
+        }
+
+        // Pair the columns by name and keep the ones of the same type for the value comparison
+        std::vector<std::pair<std::string, std::string>> columns; // Name and common type
+        auto columnsB = sourceB->GetColumns();
+        for (const auto& columnA : sourceA->GetColumns()) {
+            auto match = std::find_if(columnsB.begin(), columnsB.end(), [&](const auto& columnB) { return columnB.first == columnA.first; });
+            if (match == columnsB.end()) {
+                result.fIssues.push_back("Column only in " + sourceA->GetDescription() + ": " + columnA.first);
+                continue;
+            }
+            const std::string typeA = MapFieldType(columnA.second);
+            const std::string typeB = MapFieldType(match->second);
+            if (typeA == "Missing" || typeB == "Missing") {
+                result.fWarnings.push_back("Values not compared for " + columnA.first + ": " + columnA.second + " vs " + match->second);
+            }
+            else if (typeA != typeB) {
+                result.fIssues.push_back("Type mismatch for " + columnA.first + ": " + columnA.second + " vs " + match->second);
+            }
+            else {
+                columns.emplace_back(columnA.first, typeA);
+            }
+            columnsB.erase(match);
+        }
+        for (const auto& columnB : columnsB) {
+            result.fIssues.push_back("Column only in " + sourceB->GetDescription() + ": " + columnB.first);
+        }
+        if (!result.fIssues.empty()) {
+            return finish(); // Values only line up once both sides agree in length and structure
+        }
+        result.fNColumns = columns.size();
+
+        // Cut every column into entry ranges; each range is one work item
+        const long long nEntries = result.fEntriesA;
+        if (nThreads == 0) {
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const long long rangeSize = std::max<long long>(16 * kBatchEntries, (nEntries + nThreads - 1) / nThreads);
+        struct WorkItem {
+            std::size_t fColumn;
+            long long fFirst;
+            long long fNEntries;
+        };
+        std::vector<WorkItem> items;
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            for (long long first = 0; first < nEntries; first += rangeSize) {
+                items.push_back({ c, first, std::min(rangeSize, nEntries - first) });
+            }
+        }
+        nThreads = std::max<unsigned>(1, std::min<std::size_t>(nThreads, items.size()));
+        if (nThreads > 1) {
+            ROOT::EnableThreadSafety();
+        }
+
+        std::vector<long long> mismatches(items.size(), -1);
+        std::vector<std::string> errors(items.size());
+        std::atomic<std::size_t> nextItem{ 0 };
+        auto worker = [&]() {
+            std::unique_ptr<ColumnSource> workerA;
+            std::unique_ptr<ColumnSource> workerB;
+            for (std::size_t i = nextItem++; i < items.size(); i = nextItem++) {
+                const auto& item = items[i];
+                const auto& column = columns[item.fColumn];
+                const std::string key = "range\t" + column.first + "\t" + std::to_string(item.fFirst) + "\t" + std::to_string(item.fNEntries);
+                std::vector<std::string> fields;
+                if (checkpoint && checkpoint->Find(key, fields) && fields.size() == 1) {
+                    mismatches[i] = std::atoll(fields[0].c_str());
+                    continue;
+                }
+                try {
+                    if (!workerA) {
+                        workerA = OpenSource(a);
+                        workerB = OpenSource(b);
+                    }
+                    mismatches[i] = FindFirstMismatch(column.second, *workerA, item.fFirst, *workerB, item.fFirst, column.first, item.fNEntries);
+                    if (checkpoint) {
+                        checkpoint->Record(key, { std::to_string(mismatches[i]) });
+                    }
+                }
+                catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < nThreads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker(); // The calling thread works as well
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        // Report the first difference of every column; the items of a column are in entry order
+        std::vector<bool> reported(columns.size(), false);
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            const auto& name = columns[items[i].fColumn].first;
+            if (reported[items[i].fColumn]) {
+                continue;
+            }
+            if (!errors[i].empty()) {
+                result.fIssues.push_back("Cannot compare " + name + ": " + errors[i]);
+                reported[items[i].fColumn] = true;
+            }
+            else if (mismatches[i] >= 0) {
+                result.fIssues.push_back(name + " differs at entry " + std::to_string(items[i].fFirst + mismatches[i]));
+                reported[items[i].fColumn] = true;
+            }
+        }
+        return finish();
+    }
+
+} // namespace Checker
@@ -0,0 +1,299 @@
+/// \file CheckerSource.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERSOURCE_HXX
+#define CHECKERSOURCE_HXX
+
+#include "CheckerBuffers.hxx"
+#include "CheckerCheckpoint.hxx"
+
+#include <ROOT/RNTupleDescriptor.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <TFile.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Read access to the scalar and vector columns of one TTree or RNTuple, by entry range.
+     *
+     * The comparison kernels only talk to this interface, so the same code compares a TTree with an RNTuple,
+     * two RNTuples or two TTrees. A source is used by one thread at a time; parallel kernels open one source
+     * per side and worker thread.
+     */
+    class ColumnSource {
+    public:
+        virtual ~ColumnSource() = default;
+
+        /// "<file>:<name>", for reports
+        virtual std::string GetDescription() const = 0;
+        virtual long long GetNEntries() = 0;
+
+        /**
+         * @brief Returns the name and stored type name (e.g. Int_t or std::int32_t) of every top-level column.
+         */
+        virtual std::vector<std::pair<std::string, std::string>> GetColumns() = 0;
+
+        /**
+         * @brief Replaces the content of values with entries [first, first + n) of a scalar column.
+         *
+         * @throws std::runtime_error if the column does not exist.
+         */
+        virtual void Read(const std::string& column, long long first, long long n, std::vector<int>& values) = 0;
+        virtual void Read(const std::string& column, long long first, long long n, std::vector<float>& values) = 0;
+        virtual void Read(const std::string& column, long long first, long long n, std::vector<double>& values) = 0;
+        virtual void Read(const std::string& column, long long first, long long n, std::vector<bool>& values) = 0;
+
+        /**
+         * @brief Replaces the content of values with the elements of entries [first, first + n) of a vector column,
+         *        flattened in entry order, and the content of sizes with the number of elements of each entry.
+         *
+         * @throws std::runtime_error if the column does not exist.
+         */
+        virtual void ReadVector(const std::string& column, long long first, long long n, std::vector<int>& values, std::vector<std::size_t>& sizes) = 0;
+        virtual void ReadVector(const std::string& column, long long first, long long n, std::vector<float>& values, std::vector<std::size_t>& sizes) = 0;
+        virtual void ReadVector(const std::string& column, long long first, long long n, std::vector<double>& values, std::vector<std::size_t>& sizes) = 0;
+        virtual void ReadVector(const std::string& column, long long first, long long n, std::vector<bool>& values, std::vector<std::size_t>& sizes) = 0;
+
+        /**
+         * @brief Reads entries [first, first + n) of a column of any type ROOT has a dictionary for, and calls visit
+         *        with the address of each object, of the stored type and valid until the next call.
+         *
+         * For custom column types (see RegisterComparator); the scalar and vector reads above are faster.
+         *
+         * @throws std::runtime_error if the column does not exist.
+         */
+        virtual void ReadObjects(const std::string& column, long long first, long long n, const std::function<void(const void*)>& visit) = 0;
+    };
+
+    /**
+     * @brief Column source reading a TTree, through a file lent to it alone by the FilePool.
+     */
+    class TTreeSource : public ColumnSource {
+    public:
+        /**
+         * @throws std::runtime_error if the file cannot be opened or holds no TTree of that name.
+         */
+        TTreeSource(const std::string& file, const std::string& name);
+
+        std::string GetDescription() const override { return fPath + ":" + fName; }
+        long long GetNEntries() override;
+        std::vector<std::pair<std::string, std::string>> GetColumns() override;
+
+        void Read(const std::string& column, long long first, long long n, std::vector<int>& values) override;
+        void Read(const std::string& column, long long first, long long n, std::vector<float>& values) override;
+        void Read(const std::string& column, long long first, long long n, std::vector<double>& values) override;
+        void Read(const std::string& column, long long first, long long n, std::vector<bool>& values) override;
+
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<int>& values, std::vector<std::size_t>& sizes) override;
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<float>& values, std::vector<std::size_t>& sizes) override;
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<double>& values, std::vector<std::size_t>& sizes) override;
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<bool>& values, std::vector<std::size_t>& sizes) override;
+
+        void ReadObjects(const std::string& column, long long first, long long n, const std::function<void(const void*)>& visit) override;
+
+    private:
+        template <typename T>
+        void ReadRange(const std::string& column, long long first, long long n, std::vector<T>& values);
+        template <typename T>
+        void ReadVectorRange(const std::string& column, long long first, long long n, std::vector<T>& values, std::vector<std::size_t>& sizes);
+
+        std::string fPath;
+        std::string fName;
+        std::shared_ptr<TFile> fFile;
+        TTree* fTree = nullptr;
+    };
+
+    /**
+     * @brief Column source reading an RNTuple. Metadata comes from the FilePool descriptor; the reader and the
+     *        column views are created on the first Read, from the RNTuple anchor of a file lent by the FilePool.
+     */
+    class RNTupleSource : public ColumnSource {
+    public:
+        /**
+         * @throws std::runtime_error (or a ROOT::Experimental::RException) if the RNTuple cannot be read.
+         */
+        RNTupleSource(const std::string& file, const std::string& name);
+
+        std::string GetDescription() const override { return fPath + ":" + fName; }
+        long long GetNEntries() override;
+        std::vector<std::pair<std::string, std::string>> GetColumns() override;
+
+        void Read(const std::string& column, long long first, long long n, std::vector<int>& values) override;
+        void Read(const std::string& column, long long first, long long n, std::vector<float>& values) override;
+        void Read(const std::string& column, long long first, long long n, std::vector<double>& values) override;
+        void Read(const std::string& column, long long first, long long n, std::vector<bool>& values) override;
+
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<int>& values, std::vector<std::size_t>& sizes) override;
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<float>& values, std::vector<std::size_t>& sizes) override;
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<double>& values, std::vector<std::size_t>& sizes) override;
+        void ReadVector(const std::string& column, long long first, long long n, std::vector<bool>& values, std::vector<std::size_t>& sizes) override;
+
+        void ReadObjects(const std::string& column, long long first, long long n, const std::function<void(const void*)>& visit) override;
+
+    private:
+        template <typename T>
+        using View = decltype(std::declval<ROOT::Experimental::RNTupleReader&>().template GetView<T>(std::string()));
+
+        template <typename T>
+        void ReadRange(std::map<std::string, View<T>>& views, const std::string& column, long long first, long long n, std::vector<T>& values);
+        template <typename T>
+        void ReadVectorRange(std::map<std::string, View<std::vector<T>>>& views, const std::string& column, long long first, long long n,
+                             std::vector<T>& values, std::vector<std::size_t>& sizes);
+
+        // Opens a reader through the file lent by the FilePool, lending it on first use
+        std::unique_ptr<ROOT::Experimental::RNTupleReader> OpenReader(std::unique_ptr<ROOT::Experimental::RNTupleModel> model = nullptr);
+
+        std::string fPath;
+        std::string fName;
+        std::shared_ptr<const ROOT::Experimental::RNTupleDescriptor> fDescriptor;
+        std::shared_ptr<TFile> fFile; // Lent by the FilePool; declared before the readers, which read through it
+        std::unique_ptr<ROOT::Experimental::RNTupleReader> fReader;
+        std::map<std::string, View<int>> fIntViews;
+        std::map<std::string, View<float>> fFloatViews;
+        std::map<std::string, View<double>> fDoubleViews;
+        std::map<std::string, View<bool>> fBoolViews;
+        std::map<std::string, View<std::vector<int>>> fIntVectorViews;
+        std::map<std::string, View<std::vector<float>>> fFloatVectorViews;
+        std::map<std::string, View<std::vector<double>>> fDoubleVectorViews;
+        std::map<std::string, View<std::vector<bool>>> fBoolVectorViews;
+        std::map<std::string, std::unique_ptr<ROOT::Experimental::RNTupleReader>> fObjectReaders; // One field each, for ReadObjects
+    };
+
+    /**
+     * @brief Which kind of object a column source reads.
+     */
+    enum class SourceKind {
+        kTTree,
+        kRNTuple
+    };
+
+    /**
+     * @brief Where to find one side of a comparison.
+     */
+    struct SourceSpec {
+        SourceKind fKind = SourceKind::kRNTuple;
+        std::string fFile;
+        std::string fName;
+    };
+
+    /**
+     * @brief Looks at the keys of the file to tell whether the object is a TTree or an RNTuple.
+     *
+     * @throws std::runtime_error if the file cannot be opened or holds neither under that name.
+     */
+    SourceKind DetectSourceKind(const std::string& file, const std::string& name);
+
+    /**
+     * @brief Opens a TTreeSource or RNTupleSource for the given side.
+     */
+    std::unique_ptr<ColumnSource> OpenSource(const SourceSpec& spec);
+
+    /**
+     * @brief Returns the offset of the first entry at which two columns differ, or -1 if they are equal.
+     *
+     * Reads n entries, starting at firstA in a and at firstB in b, in batches of kBatchEntries.
+     */
+    template <typename T>
+    long long FindFirstMismatch(ColumnSource& a, long long firstA, ColumnSource& b, long long firstB, const std::string& column, long long n) {
+        PooledBuffer<T> batchA;
+        PooledBuffer<T> batchB;
+        for (long long first = 0; first < n; first += kBatchEntries) {
+            const long long count = std::min<long long>(kBatchEntries, n - first);
+            a.Read(column, firstA + first, count, *batchA);
+            b.Read(column, firstB + first, count, *batchB);
+            auto diff = std::mismatch(batchA->begin(), batchA->end(), batchB->begin(), batchB->end());
+            if (diff.first != batchA->end() || diff.second != batchB->end()) {
+                return first + (diff.first - batchA->begin());
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief FindFirstMismatch for vector columns: an entry differs if its number of elements or any element differs.
+     */
+    template <typename T>
+    long long FindFirstVectorMismatch(ColumnSource& a, long long firstA, ColumnSource& b, long long firstB, const std::string& column, long long n) {
+        PooledBuffer<T> valuesA;
+        PooledBuffer<T> valuesB;
+        std::vector<std::size_t> sizesA;
+        std::vector<std::size_t> sizesB;
+        for (long long first = 0; first < n; first += kBatchEntries) {
+            const long long count = std::min<long long>(kBatchEntries, n - first);
+            a.ReadVector(column, firstA + first, count, *valuesA, sizesA);
+            b.ReadVector(column, firstB + first, count, *valuesB, sizesB);
+            if (sizesA == sizesB && *valuesA == *valuesB) {
+                continue;
+            }
+            std::size_t offset = 0;
+            for (std::size_t k = 0; k < sizesA.size() && k < sizesB.size(); ++k) {
+                if (sizesA[k] != sizesB[k] || !std::equal(valuesA->begin() + offset, valuesA->begin() + offset + sizesA[k], valuesB->begin() + offset)) {
+                    return first + k;
+                }
+                offset += sizesA[k];
+            }
+            return first + std::min(sizesA.size(), sizesB.size());
+        }
+        return -1;
+    }
+
+    /**
+     * @brief FindFirstMismatch for a column of the given common type ("int", "float", "double", "bool" or a
+     *        vector of these, as returned by MapFieldType).
+     *
+     * @throws std::runtime_error for any other type.
+     */
+    long long FindFirstMismatch(const std::string& type, ColumnSource& a, long long firstA, ColumnSource& b, long long firstB,
+                                const std::string& column, long long n);
+
+    /**
+     * @brief Outcome of comparing two sources of any kind.
+     */
+    struct SourceResult {
+        bool fPassed = false;
+        long long fEntriesA = 0;
+        long long fEntriesB = 0;
+        std::size_t fNColumns = 0;          // Columns compared value by value
+        std::vector<std::string> fIssues;
+        std::vector<std::string> fWarnings; // Columns not compared value by value
+        double fSeconds = 0;
+    };
+
+    /**
+     * @brief Compares two TTrees, two RNTuples, or a TTree with an RNTuple.
+     *
+     * Checks entry counts, column names and types, then compares every common column value by value.
+     * The columns are cut into entry ranges that are handed to nThreads workers, each with its own pair of
+     * sources.
+     *
+     * @param nThreads Number of worker threads; 0 uses one per hardware thread.
+     * @param checkpoint If set, entry ranges recorded in it are not compared again and every compared range is
+     *                   recorded with the offset of its first difference.
+     * @throws std::runtime_error if either side cannot be opened.
+     */
+    SourceResult CompareSources(const SourceSpec& a, const SourceSpec& b, unsigned nThreads = 0, Checkpoint* checkpoint = nullptr);
+
+} // namespace Checker
+
+#endif // CHECKERSOURCE_HXX
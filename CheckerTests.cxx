@@ -16,17 +16,44 @@
 #include <gtest/gtest.h>
 #include <TFile.h>
 #include <TTree.h>
+#include <TROOT.h>
 #include <ROOT/RNTuple.hxx>
 #include <ROOT/RNTupleModel.hxx>
 #include <ROOT/RNTupleWriteOptions.hxx>
 #include <ROOT/RNTupleWriter.hxx>
 #include <ROOT/RNTupleInspector.hxx>
 #include "Checker.hxx"
+#include "CheckerAsync.hxx"
+#include "CheckerBaseline.hxx"
+#include "CheckerBatch.hxx"
+#include "CheckerBuffers.hxx"
+#include "CheckerChain.hxx"
+#include "CheckerCheckpoint.hxx"
+#include "CheckerComparators.hxx"
+#include "CheckerDaemon.hxx"
+#include "CheckerExpression.hxx"
+#include "CheckerFilePool.hxx"
+#include "CheckerFrame.hxx"
+#include "CheckerGenerator.hxx"
+#include "CheckerMemory.hxx"
+#include "CheckerPlan.hxx"
+#include "CheckerPolicy.hxx"
+#include "CheckerScan.hxx"
+#include "CheckerSelection.hxx"
+#include "CheckerSource.hxx"
+#include "CheckerVariants.hxx"
+#include "CheckerWatch.hxx"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <cstdio>
+#include <fstream>
 #include <map>
+#include <sstream>
+#include <thread>
 #include <variant>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 #include <string>
 
@@ -200,6 +227,43 @@ protected:
     const char* rntupleFile = "test_rntuple.root";
 };
 
+// Fixture of the tests that write their own files with the generator, named after the test so that tests
+// running in parallel do not share them
+class GeneratedPairTest : public ::testing::Test {
+
+protected:
+    void SetUp() override {
+        const std::string test = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        ttreeFile = "gen_" + test + "_ttree.root";
+        rntupleFile = "gen_" + test + "_rntuple.root";
+    }
+
+    void TearDown() override {
+        std::remove(ttreeFile.c_str());
+        std::remove(rntupleFile.c_str());
+        Checker::ComparatorRegistry::Instance().Clear();
+    }
+
+    // Writes a TTree and an RNTuple named "gen" with one column per type, e.g. "i,vf,d", and the given
+    // mismatches (see ParseMismatch) in the RNTuple
+    Checker::GeneratorConfig Generate(long long entries, const std::string& types, const std::vector<std::string>& mismatches = {},
+                                      bool sequential = false) {
+        Checker::GeneratorConfig config;
+        config.fEntries = entries;
+        config.fTypes = Checker::ParseColumnTypes(types);
+        config.fColumns = static_cast<int>(config.fTypes.size());
+        config.fSequential = sequential;
+        for (const auto& mismatch : mismatches) {
+            config.fMismatches.push_back(Checker::ParseMismatch(mismatch));
+        }
+        Checker::GeneratePairs(config, ttreeFile, rntupleFile, "gen", "gen");
+        return config;
+    }
+
+    std::string ttreeFile;
+    std::string rntupleFile;
+};
+
 TEST_F(CheckerTest, TTreeExists) {
     Checker::Checker checker(ttreeFile, rntupleFile, "tree_0", "rntuple_0");
     EXPECT_TRUE(checker.TTreeExists());
@@ -353,6 +417,763 @@ TEST_F(CheckerTest, ReadBoolFromRNTuple) {
     }
 }
 
+TEST_F(CheckerTest, MemoryProfilePerColumn) {
+    auto& profile = Checker::MemoryProfile::Instance();
+    profile.Reset();
+    profile.SetEnabled(true);
+    {
+        Checker::Checker checker(ttreeFile, rntupleFile, "tree_0", "rntuple_0");
+        Checker::MemoryPhase phase("Read");
+        checker.ReadIntFromTTree();
+        checker.ReadIntFromRNTuple();
+    }
+    profile.SetEnabled(false);
+
+    auto phases = profile.GetPhases();
+    ASSERT_EQ(phases.count("Read"), 1u);
+    ASSERT_EQ(phases.count("ReadIntFromTTree/value"), 1u);
+    ASSERT_EQ(phases.count("ReadIntFromRNTuple/value"), 1u);
+    EXPECT_EQ(phases["Read"].fCalls, 1u);
+    EXPECT_GT(phases["Read"].fPeakRSSMB, 0);
+    EXPECT_EQ(phases["ReadIntFromTTree/value"].fPeakRSSMB, 0); // Only top-level phases read the peak
+    if (Checker::MemoryProfile::CountsAllocations()) {
+        EXPECT_GE(phases["Read"].fBytes, phases["ReadIntFromTTree/value"].fBytes + phases["ReadIntFromRNTuple/value"].fBytes);
+        EXPECT_GE(phases["ReadIntFromTTree/value"].fBytes, entryNo * sizeof(int));
+    }
+
+    // The native scan reports each column it reads as a phase of its own
+    profile.Reset();
+    profile.SetEnabled(true);
+    const Checker::ScanPlan plan = Checker::PlanScan({ ttreeFile, rntupleFile, "tree_0", "rntuple_0" });
+    Checker::RunScan(plan);
+    profile.SetEnabled(false);
+    phases = profile.GetPhases();
+    ASSERT_FALSE(plan.fColumns.empty());
+    for (const auto& column : plan.fColumns) {
+        EXPECT_EQ(phases.count("Scan/" + column.fName), 1u) << column.fName;
+    }
+    profile.Reset();
+}
+
+TEST_F(CheckerTest, LazyConstruction) {
+    // Nothing is opened until a check needs it
+    Checker::Checker missing("missing_ttree.root", "missing_rntuple.root", "tree_0", "rntuple_0");
+    EXPECT_FALSE(missing.TTreeExists());
+    EXPECT_FALSE(missing.RNTupleExists());
+    EXPECT_THROW(missing.CountEntries(), std::runtime_error);
+
+    Checker::Checker wrongName(ttreeFile, rntupleFile, "tree_0", "no_such_rntuple");
+    EXPECT_THROW(wrongName.CompareFieldNames(), std::runtime_error);
+
+    // Metadata checks work from the descriptor alone
+    Checker::Checker checker(ttreeFile, rntupleFile, "tree_0", "rntuple_0");
+    auto entries = checker.CountEntries();
+    EXPECT_EQ(entries.first, entryNo);
+    EXPECT_EQ(entries.second, entryNo);
+}
+
+TEST_F(CheckerTest, FilePoolSharesFiles) {
+    auto& pool = Checker::FilePool::Instance();
+    pool.Clear();
+    const std::size_t opened = pool.GetNOpened();
+
+    // Checking several trees of the same pair of files opens each file once
+    for (int i = 0; i < 3; ++i) {
+        Checker::Checker checker(ttreeFile, rntupleFile, "tree_" + std::to_string(i), "rntuple_" + std::to_string(i));
+        checker.CountFields();
+    }
+    EXPECT_EQ(pool.GetNOpened() - opened, 2u);
+
+    // Files held at the same time are distinct; a released file is reused on another thread
+    {
+        auto first = pool.GetFile(ttreeFile);
+        auto second = pool.GetFile(ttreeFile);
+        ASSERT_TRUE(first && second);
+        EXPECT_NE(first, second);
+    }
+    const std::size_t openedBefore = pool.GetNOpened();
+    std::thread([&]() { EXPECT_TRUE(pool.GetFile(ttreeFile)); }).join();
+    EXPECT_EQ(pool.GetNOpened(), openedBefore);
+
+    // Descriptors are parsed once per RNTuple
+    EXPECT_EQ(pool.GetDescriptor(rntupleFile, "rntuple_0"), pool.GetDescriptor(rntupleFile, "rntuple_0"));
+    EXPECT_NE(pool.GetDescriptor(rntupleFile, "rntuple_0"), pool.GetDescriptor(rntupleFile, "rntuple_1"));
+}
+
+TEST_F(CheckerTest, BatchFromManifest) {
+    const char* manifestFile = "test_manifest.txt";
+    {
+        std::ofstream manifest(manifestFile);
+        manifest << "# ttreeFile rntupleFile ttreeName rntupleName\n"
+                 << ttreeFile << " " << rntupleFile << " tree_0 rntuple_0\n"
+                 << "\n"
+                 << ttreeFile << " " << rntupleFile << " tree_1 rntuple_1   # entry 42 missing\n"
+                 << "test_ttre*.root test_rntupl*.root tree_0 rntuple_0\n"
+                 << "missing_ttree.root " << rntupleFile << " tree_0 rntuple_0\n"
+                 << "missing_run_*.root missing_run_*_rntuple.root tree_0 rntuple_0\n";
+    }
+    const auto pairs = Checker::ReadManifest(manifestFile);
+    ASSERT_EQ(pairs.size(), 5u);
+    EXPECT_EQ(pairs[2].fTTreeFile, ttreeFile);      // Glob expanded
+    EXPECT_EQ(pairs[2].fRNTupleFile, rntupleFile);  // Matched part substituted
+
+    const auto results = Checker::RunBatch(pairs, 2);
+    ASSERT_EQ(results.size(), pairs.size());
+    EXPECT_TRUE(results[0].fPassed);
+    EXPECT_FALSE(results[1].fPassed);
+    EXPECT_FALSE(results[1].fIssues.empty());
+    EXPECT_TRUE(results[2].fPassed);
+    EXPECT_FALSE(results[3].fPassed);
+    EXPECT_FALSE(results[3].fError.empty());
+    EXPECT_FALSE(results[4].fPassed); // A pattern without matches is an error, not an empty expansion
+    EXPECT_NE(results[4].fError.find("No file matches"), std::string::npos);
+
+    {
+        std::ofstream manifest(manifestFile);
+        manifest << ttreeFile << " " << rntupleFile << " tree_0\n";
+    }
+    EXPECT_THROW(Checker::ReadManifest(manifestFile), std::runtime_error);
+    std::remove(manifestFile);
+}
+
+TEST_F(CheckerTest, PairAllTrees) {
+    EXPECT_EQ(Checker::ListTTrees(ttreeFile).size(), 5u);
+    EXPECT_EQ(Checker::ListRNTuples(rntupleFile).size(), 5u);
+
+    // The names differ, so nothing pairs without a rule
+    auto unpaired = Checker::PairByName(ttreeFile, rntupleFile);
+    EXPECT_TRUE(unpaired.fPairs.empty());
+    EXPECT_EQ(unpaired.fUnpairedTTrees.size(), 5u);
+    EXPECT_EQ(unpaired.fUnpairedRNTuples.size(), 5u);
+
+    auto pairing = Checker::PairByName(ttreeFile, rntupleFile, "tree_:rntuple_");
+    ASSERT_EQ(pairing.fPairs.size(), 5u);
+    EXPECT_TRUE(pairing.fUnpairedTTrees.empty());
+    EXPECT_TRUE(pairing.fUnpairedRNTuples.empty());
+    EXPECT_EQ(pairing.fPairs[3].fTTreeName, "tree_3");
+    EXPECT_EQ(pairing.fPairs[3].fRNTupleName, "rntuple_3");
+
+    EXPECT_THROW(Checker::PairByName(ttreeFile, rntupleFile, "no_colon"), std::runtime_error);
+}
+
+TEST(CheckerChain, MapChainEntries) {
+    // Boundaries at 3 and 5 on the TTree side, 4 on the RNTuple side
+    auto segments = Checker::MapChainEntries({ 3, 0, 2 }, { 4, 1 });
+    ASSERT_EQ(segments.size(), 3u);
+    EXPECT_EQ(segments[0].fNEntries, 3);
+    EXPECT_EQ(segments[1].fTTreeFile, 2u);
+    EXPECT_EQ(segments[1].fRNTupleFile, 0u);
+    EXPECT_EQ(segments[1].fFirstEntry, 3);
+    EXPECT_EQ(segments[1].fRNTupleEntry, 3);
+    EXPECT_EQ(segments[1].fNEntries, 1);
+    EXPECT_EQ(segments[2].fTTreeEntry, 1);
+    EXPECT_EQ(segments[2].fRNTupleFile, 1u);
+    EXPECT_EQ(segments[2].fRNTupleEntry, 0);
+}
+
+TEST_F(CheckerTest, CompareChains) {
+    const std::vector<std::string> ttreeFiles = { ttreeFile, ttreeFile };
+    auto result = Checker::CompareChains(ttreeFiles, { rntupleFile, rntupleFile }, "tree_0", "rntuple_0", 2);
+    EXPECT_TRUE(result.fPassed);
+    EXPECT_EQ(result.fTTreeEntries, 2 * entryNo);
+    EXPECT_EQ(result.fNSegments, 2u);
+    EXPECT_EQ(result.fNColumns, 4u);
+
+    auto shorter = Checker::CompareChains(ttreeFiles, { rntupleFile }, "tree_0", "rntuple_0", 2);
+    EXPECT_FALSE(shorter.fPassed);
+
+    EXPECT_EQ(Checker::ReadFileList(std::string(ttreeFile) + "," + rntupleFile).size(), 2u);
+    EXPECT_THROW(Checker::ReadFileList("@missing_list.txt"), std::runtime_error);
+}
+
+TEST_F(CheckerTest, CompareVariants) {
+    // rntuple_0 matches tree_0, rntuple_1 misses an entry, rntuple_2 misses a field
+    auto results = Checker::CompareVariants(ttreeFile, "tree_0", {
+        { rntupleFile, "rntuple_0" }, { rntupleFile, "rntuple_1" }, { rntupleFile, "rntuple_2" }, { "missing_rntuple.root", "rntuple_0" } });
+    ASSERT_EQ(results.size(), 4u);
+    EXPECT_TRUE(results[0].fPassed);
+    EXPECT_EQ(results[0].fNColumns, 4u);
+    EXPECT_FALSE(results[1].fPassed);
+    EXPECT_FALSE(results[2].fPassed);
+    EXPECT_FALSE(results[3].fPassed);
+    EXPECT_FALSE(results[3].fError.empty());
+
+    EXPECT_THROW(Checker::CompareVariants(ttreeFile, "no_such_tree", { { rntupleFile, "rntuple_0" } }), std::runtime_error);
+}
+
+TEST_F(CheckerTest, SameFormatComparison) {
+    using Checker::SourceKind;
+    EXPECT_EQ(Checker::DetectSourceKind(ttreeFile, "tree_0"), SourceKind::kTTree);
+    EXPECT_EQ(Checker::DetectSourceKind(rntupleFile, "rntuple_0"), SourceKind::kRNTuple);
+    EXPECT_THROW(Checker::DetectSourceKind(rntupleFile, "no_such_rntuple"), std::runtime_error);
+
+    // RNTuple against RNTuple: rntuple_4 has the same fields as rntuple_0 but other energy values
+    auto same = Checker::CompareSources({ SourceKind::kRNTuple, rntupleFile, "rntuple_0" }, { SourceKind::kRNTuple, rntupleFile, "rntuple_0" }, 2);
+    EXPECT_TRUE(same.fPassed);
+    EXPECT_EQ(same.fNColumns, 4u);
+    auto changed = Checker::CompareSources({ SourceKind::kRNTuple, rntupleFile, "rntuple_0" }, { SourceKind::kRNTuple, rntupleFile, "rntuple_4" }, 2);
+    EXPECT_FALSE(changed.fPassed);
+    ASSERT_EQ(changed.fIssues.size(), 1u);
+    EXPECT_NE(changed.fIssues[0].find("energy differs at entry 0"), std::string::npos);
+
+    // TTree against TTree, and the mixed case through the same kernel
+    EXPECT_TRUE(Checker::CompareSources({ SourceKind::kTTree, ttreeFile, "tree_0" }, { SourceKind::kTTree, ttreeFile, "tree_0" }).fPassed);
+    EXPECT_TRUE(Checker::CompareSources({ SourceKind::kTTree, ttreeFile, "tree_0" }, { SourceKind::kRNTuple, rntupleFile, "rntuple_0" }).fPassed);
+}
+
+TEST_F(CheckerTest, DaemonCachesAndServes) {
+    const std::string socketPath = "test_checker.sock";
+    Checker::Daemon daemon(socketPath, 2);
+
+    // Requests are answered directly, and repeated checks of unchanged files come from the cache
+    const std::string pair = std::string(ttreeFile) + " " + rntupleFile + " tree_0 rntuple_0";
+    EXPECT_EQ(daemon.HandleRequest("PING"), "OK\tPONG");
+    EXPECT_EQ(daemon.HandleRequest(pair).compare(0, 5, "PASS\t"), 0);
+    const std::string cached = daemon.HandleRequest(pair);
+    EXPECT_NE(cached.find("\t1\t"), std::string::npos);
+    EXPECT_EQ(daemon.GetNCached(), 1u);
+    EXPECT_EQ(daemon.HandleRequest("only three fields").compare(0, 6, "ERROR\t"), 0);
+
+    // Over the socket, responses stream back in request order
+    std::thread server([&]() { daemon.Serve(); });
+    std::ostringstream responses;
+    bool passed = false;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        try {
+            passed = Checker::SubmitJobs(socketPath, { { ttreeFile, rntupleFile, "tree_0", "rntuple_0" },
+                                                       { ttreeFile, rntupleFile, "tree_1", "rntuple_1" } }, responses);
+            break;
+        }
+        catch (const std::runtime_error&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Not listening yet
+        }
+    }
+    EXPECT_FALSE(passed); // tree_1 and rntuple_1 differ
+    EXPECT_EQ(responses.str().compare(0, 5, "PASS\t"), 0);
+    EXPECT_NE(responses.str().find("\nFAIL\t"), std::string::npos);
+
+    // A manifest larger than the socket buffers is answered while it is still being sent
+    const std::vector<Checker::PairSpec> many(20000, { ttreeFile, rntupleFile, "tree_0", "rntuple_0" });
+    std::ostringstream manyResponses;
+    EXPECT_TRUE(Checker::SubmitJobs(socketPath, many, manyResponses));
+
+    daemon.Stop();
+    server.join();
+}
+
+TEST(CheckerWatch, MatchTTreeFile) {
+    EXPECT_EQ(Checker::MatchTTreeFile("out/run_7_rntuple.root", "ttree:rntuple"), "out/run_7_ttree.root");
+    EXPECT_EQ(Checker::MatchTTreeFile("out/run_7_rntuple.root", ":_rntuple", "in"), "in/run_7.root");
+    EXPECT_EQ(Checker::MatchTTreeFile("out/run_7.root", "ttree:rntuple"), "");
+    EXPECT_THROW(Checker::MatchTTreeFile("run_7_rntuple.root", "ttree"), std::runtime_error);
+}
+
+TEST_F(CheckerTest, WatchVerifiesNewFiles) {
+    const std::string directory = "test_watch";
+    mkdir(directory.c_str(), 0755);
+    auto copy = [&](const char* file) {
+        std::ifstream in(file, std::ios::binary);
+        std::ofstream out(directory + "/" + file, std::ios::binary);
+        out << in.rdbuf();
+    };
+
+    Checker::Watcher watcher(directory, "ttree:rntuple", "tree_:rntuple_", 2);
+    std::mutex mutex;
+    std::vector<Checker::PairResult> results;
+    std::thread watch([&]() {
+        watcher.Watch([&](const Checker::PairResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result);
+        });
+    });
+    auto nResults = [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return results.size();
+    };
+
+    for (int wait = 0; wait < 500 && !watcher.IsWatching(); ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // The RNTuple file lands first and waits for its TTree file
+    copy(rntupleFile);
+    copy(ttreeFile);
+    for (int wait = 0; wait < 3000 && nResults() < 5; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    watcher.Stop();
+    watch.join();
+
+    ASSERT_GE(results.size(), 5u);
+    std::map<std::string, bool> passed;
+    for (const auto& result : results) {
+        passed[result.fPair.fTTreeName] = result.fPassed;
+    }
+    EXPECT_TRUE(passed["tree_0"]);
+    EXPECT_FALSE(passed["tree_1"]);
+
+    std::remove((directory + "/" + ttreeFile).c_str());
+    std::remove((directory + "/" + rntupleFile).c_str());
+    rmdir(directory.c_str());
+}
+
+// Fixture of the checkpoint tests: the checkpoint file is named after the test, so that tests running in parallel
+// do not share it, and removed even if the test fails
+class CheckpointTest : public CheckerTest {
+
+protected:
+    void SetUp() override {
+        CheckerTest::SetUp();
+        path = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + "_checkpoint.txt";
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        CheckerTest::TearDown();
+    }
+
+    std::string path;
+};
+
+TEST_F(CheckpointTest, RoundTripAndFingerprint) {
+    {
+        Checker::Checkpoint checkpoint(path, "run A");
+        checkpoint.Record("range\tenergy\t0\t100", { "-1" });
+        checkpoint.Record("pair\tx", { "0", "1.5", "", "Ifirst\tissue\nwith breaks" });
+    } // Written on destruction
+
+    Checker::Checkpoint resumed(path, "run A");
+    EXPECT_EQ(resumed.GetNRestored(), 2u);
+    std::vector<std::string> fields;
+    ASSERT_TRUE(resumed.Find("pair\tx", fields));
+    ASSERT_EQ(fields.size(), 4u);
+    EXPECT_EQ(fields[3], "Ifirst\tissue\nwith breaks");
+    EXPECT_FALSE(resumed.Find("range\tenergy\t100\t100", fields));
+
+    Checker::Checkpoint other(path, "run B");
+    EXPECT_EQ(other.GetNRestored(), 0u);
+    other.Remove();
+    EXPECT_FALSE(std::ifstream(path).good());
+}
+
+TEST_F(CheckpointTest, BatchResumesFromCheckpoint) {
+    const auto pairs = Checker::PairByName(ttreeFile, rntupleFile, "tree_:rntuple_").fPairs;
+    const std::string fingerprint = Checker::Checkpoint::Fingerprint({ ttreeFile, rntupleFile }, "batch");
+
+    std::vector<Checker::PairResult> first;
+    {
+        Checker::Checkpoint checkpoint(path, fingerprint);
+        first = Checker::RunBatch(pairs, 2, true, &checkpoint);
+    }
+
+    Checker::Checkpoint checkpoint(path, fingerprint);
+    EXPECT_EQ(checkpoint.GetNRestored(), pairs.size());
+    const auto resumed = Checker::RunBatch(pairs, 2, true, &checkpoint);
+    ASSERT_EQ(resumed.size(), first.size());
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(resumed[i].fPassed, first[i].fPassed);
+        EXPECT_EQ(resumed[i].fIssues, first[i].fIssues);
+    }
+}
+
+TEST_F(CheckerTest, PlanRunsCheapChecksFirst) {
+    const auto plan = Checker::PlanChecks({ ttreeFile, rntupleFile, "tree_0", "rntuple_0" });
+    ASSERT_EQ(plan.fColumns.size(), 4u);
+    for (std::size_t i = 1; i < plan.fColumns.size(); ++i) {
+        EXPECT_LE(plan.fColumns[i - 1].fCost, plan.fColumns[i].fCost);
+    }
+    EXPECT_TRUE(Checker::RunPlan(plan).fPassed);
+
+    // A broken structure fails without reading any values
+    const auto broken = Checker::RunPlan(Checker::PlanChecks({ ttreeFile, rntupleFile, "tree_1", "rntuple_1" }), true);
+    EXPECT_FALSE(broken.fPassed);
+    ASSERT_EQ(broken.fWarnings.size(), 1u);
+    EXPECT_NE(broken.fWarnings[0].find("not run"), std::string::npos);
+}
+
+TEST_F(GeneratedPairTest, VectorColumnsAndFailFast) {
+    const auto config = Generate(1000, "i,vf,d", { "value:vfloat_1:7" });
+
+    const auto plan = Checker::PlanChecks({ ttreeFile, rntupleFile, "gen", "gen" });
+    ASSERT_EQ(plan.fColumns.size(), 3u);
+    EXPECT_EQ(plan.fColumns.back().fType, "vector<float>"); // The longest column comes last
+    EXPECT_NEAR(plan.fColumns.back().fMeanVectorSize, config.fVectorLength, 1.5);
+
+    const auto result = Checker::RunPlan(plan, true);
+    EXPECT_FALSE(result.fPassed);
+    ASSERT_EQ(result.fIssues.size(), 1u);
+    EXPECT_EQ(result.fIssues[0], "vfloat_1 differs at entry 7");
+}
+
+TEST_F(GeneratedPairTest, OnePassForValuesAndStatistics) {
+    Generate(10000, "i,vf,d", { "value:double_2:5000" });
+
+    const auto plan = Checker::PlanScan({ ttreeFile, rntupleFile, "gen", "gen" });
+    ASSERT_EQ(plan.fColumns.size(), 3u);
+    long long next = 0;
+    for (const auto& range : plan.fRanges) {
+        EXPECT_EQ(range.fFirst, next);
+        EXPECT_GT(range.fNEntries, 0);
+        EXPECT_LE(range.fNEntries, static_cast<long long>(Checker::kBatchEntries));
+        next += range.fNEntries;
+    }
+    EXPECT_EQ(next, 10000);
+
+    const auto result = Checker::RunScan(plan);
+    EXPECT_FALSE(result.fPassed);
+    EXPECT_EQ(result.fNCompared, 3u);
+    ASSERT_EQ(result.fIssues.size(), 1u);
+    EXPECT_EQ(result.fIssues[0], "double_2 differs at entry 5000");
+    EXPECT_EQ(result.fNReads, 2 * plan.fColumns.size() * plan.fRanges.size()); // Every column once per file and range
+    EXPECT_EQ(result.fTTreeStatistics[0].fEntries, 10000);
+    EXPECT_EQ(result.fTTreeStatistics[0].GetSummary(), result.fRNTupleStatistics[0].GetSummary());
+    EXPECT_EQ(result.fRNTupleStatistics[2].fEntries, 10000);
+}
+
+TEST_F(GeneratedPairTest, VisitorStreamsBatchesAndMismatches) {
+    Generate(10000, "i,vf,d", { "value:double_2:5000" });
+
+    struct Recorder : Checker::ScanVisitor {
+        long long fNext[2] = { 0, 0 }; // Next int_0 entry expected from each file
+        std::size_t fNRanges = 0;
+        std::vector<Checker::ScanMismatch> fMismatches;
+
+        using Checker::ScanVisitor::OnBatch;
+        void OnRange(const Checker::ScanRange&) override { ++fNRanges; }
+        void OnBatch(Checker::ScanSide side, const std::string& name, long long first, const std::vector<int>& values) override {
+            auto& next = fNext[side == Checker::ScanSide::kTTree ? 0 : 1];
+            EXPECT_EQ(name, "int_0");
+            EXPECT_EQ(first, next);
+            next += values.size();
+        }
+        void OnMismatch(const Checker::ScanMismatch& mismatch) override { fMismatches.push_back(mismatch); }
+    } recorder;
+
+    Checker::ScanRequest request;
+    request.fStatistics = false;
+    request.fHistograms = false;
+    Checker::Checker checker(ttreeFile, rntupleFile, "gen", "gen");
+    const auto result = checker.Scan(recorder, request);
+    EXPECT_EQ(recorder.fNext[0], 10000);
+    EXPECT_EQ(recorder.fNext[1], 10000);
+    EXPECT_GT(recorder.fNRanges, 1u);
+    ASSERT_EQ(recorder.fMismatches.size(), 1u);
+    EXPECT_EQ(recorder.fMismatches[0].fName, "double_2");
+    EXPECT_EQ(recorder.fMismatches[0].fEntry, 5000);
+    EXPECT_EQ(result.fIssues.size(), 1u);
+}
+
+TEST_F(GeneratedPairTest, RunsScansConcurrentlyAndCancels) {
+    Generate(10000, "i,vf,d", { "value:double_2:5000" });
+
+    // Holds the scan in its first range until the test has cancelled it
+    struct Gate : Checker::ScanVisitor {
+        std::shared_future<void> fOpen;
+        void OnRange(const Checker::ScanRange&) override { fOpen.wait(); }
+    } gate;
+    std::promise<void> open;
+    gate.fOpen = open.get_future().share();
+
+    Checker::Checker checker(ttreeFile, rntupleFile, "gen", "gen");
+    auto held = checker.StartScan(Checker::ScanRequest(), &gate);
+    const auto full = checker.StartScan(Checker::ScanRequest());
+    held.Cancel();
+    open.set_value();
+
+    const auto& result = full.Get();
+    ASSERT_EQ(result.fIssues.size(), 1u);
+    EXPECT_EQ(result.fIssues[0], "double_2 differs at entry 5000");
+    EXPECT_EQ(full.GetEntriesDone(), 10000);
+    EXPECT_DOUBLE_EQ(full.GetProgress(), 1.0);
+
+    const auto& cancelled = held.Get();
+    EXPECT_TRUE(cancelled.fCancelled);
+    EXPECT_FALSE(cancelled.fPassed);
+    EXPECT_LT(held.GetEntriesDone(), held.GetEntriesTotal());
+    EXPECT_TRUE(held.IsCancelled());
+    EXPECT_FALSE(Checker::ScanHandle().IsValid());
+}
+
+TEST(CheckerPolicy, ParsesSectionsAndRejectsUnknownKeys) {
+    std::istringstream in("# Policy\n[checks]\nhistograms = false\nfail_fast = keys\n\n"
+                          "[columns]\ncompare = [\"double_*\", int_0]\nkeys = int_0\n\n"
+                          "[tolerance]\n\"double_*\" = 1.5  # Generated differences are 1\n"
+                          "[relative_tolerance]\n\"double_*\" = 1e-6\n");
+    const auto request = Checker::ParseCheckPolicy(in, "test");
+    EXPECT_TRUE(request.fValues);
+    EXPECT_FALSE(request.fHistograms);
+    EXPECT_EQ(request.fFailFast, Checker::FailFast::kKeyColumns);
+    EXPECT_EQ(request.fColumns, (std::vector<std::string>{ "double_*", "int_0" }));
+    EXPECT_EQ(request.fKeyColumns, (std::vector<std::string>{ "int_0" }));
+    ASSERT_EQ(request.fTolerances.size(), 1u);
+    EXPECT_EQ(request.fTolerances[0].fAbsolute, 1.5);
+    EXPECT_EQ(request.fTolerances[0].fRelative, 1e-6);
+
+    std::istringstream unknownKey("[checks]\nvalue = true\n");
+    EXPECT_THROW(Checker::ParseCheckPolicy(unknownKey, "test"), std::runtime_error);
+    std::istringstream badNumber("[tolerance]\npx = small\n");
+    EXPECT_THROW(Checker::ParseCheckPolicy(badNumber, "test"), std::runtime_error);
+}
+
+TEST_F(GeneratedPairTest, ScanAppliesColumnPolicies) {
+    Generate(10000, "i,vf,d", { "value:double_2:5000", "value:int_0:6000" });
+    const Checker::PairSpec pair{ ttreeFile, rntupleFile, "gen", "gen" };
+
+    Checker::ScanRequest request;
+    request.fColumns = { "double_*" };
+    request.fKeyColumns = { "int_0" };
+    request.fTolerances = { { "double_*", 1.5, 0 } };
+    request.fFailFast = Checker::FailFast::kKeyColumns;
+
+    auto plan = Checker::PlanScan(pair, request);
+    ASSERT_EQ(plan.fColumns.size(), 2u); // The vector column is not selected
+    EXPECT_EQ(plan.fColumns[0].fName, "int_0");
+    EXPECT_EQ(plan.fColumns[1].fAbsoluteTolerance, 1.5);
+
+    // The double difference is within the tolerance; the key difference stops the scan
+    auto result = Checker::RunScan(plan);
+    ASSERT_EQ(result.fIssues.size(), 1u);
+    EXPECT_EQ(result.fIssues[0], "Key column int_0 differs at entry 6000");
+    ASSERT_FALSE(result.fWarnings.empty());
+    EXPECT_EQ(result.fWarnings.back().rfind("Scan stopped", 0), 0u);
+
+    // Without tolerance the double difference is reported with its key
+    request.fTolerances.clear();
+    request.fFailFast = Checker::FailFast::kNever;
+    result = Checker::RunScan(Checker::PlanScan(pair, request));
+    ASSERT_EQ(result.fIssues.size(), 2u);
+    EXPECT_EQ(result.fIssues[1].rfind("double_2 differs at entry 5000 (int_0=", 0), 0u);
+
+    request.fKeyColumns = { "vfloat_1" };
+    EXPECT_THROW(Checker::PlanScan(pair, request), std::runtime_error);
+}
+
+TEST(CheckerSelection, ParsesConjunctions) {
+    const Checker::Selection selection("run >= 100 && nJet>2 and run <= 200");
+    EXPECT_EQ(selection.GetColumns(), (std::vector<std::string>{ "run", "nJet" }));
+    EXPECT_EQ(Checker::Selection("2 < nJet").GetColumns(), (std::vector<std::string>{ "nJet" }));
+
+    EXPECT_THROW(Checker::Selection("nJet > 2 &&"), std::runtime_error);
+    EXPECT_THROW(Checker::Selection("nJet > run"), std::runtime_error);
+    EXPECT_THROW(Checker::Selection("nJet ~ 2"), std::runtime_error);
+    EXPECT_THROW(Checker::Selection("nJet > 2 || run < 3"), std::runtime_error);
+}
+
+TEST_F(GeneratedPairTest, ScanReadsOnlySelectedEntries) {
+    Generate(10000, "i,vf,d", { "value:double_2:2500", "value:double_2:5000" }, true); // int_0 holds the entry number
+
+    Checker::ScanRequest request;
+    request.fSelection = "int_0 >= 2000 && int_0 < 3000";
+    const auto plan = Checker::PlanScan({ ttreeFile, rntupleFile, "gen", "gen" }, request);
+    const auto result = Checker::RunScan(plan);
+
+    ASSERT_EQ(result.fIssues.size(), 1u); // The difference at entry 5000 is not selected
+    EXPECT_EQ(result.fIssues[0], "double_2 differs at entry 2500");
+    EXPECT_EQ(result.fNSelected, 1000);
+    EXPECT_EQ(result.fTTreeStatistics[0].fEntries, 1000);
+    EXPECT_NEAR(result.fTTreeStatistics[0].fMean, 2499.5, 1e-9);
+    // One selection read per range, and the columns only for the range holding the selected entries
+    EXPECT_EQ(result.fNReads, plan.fRanges.size() + 2 * plan.fColumns.size());
+
+    request.fSelection = "missing > 1";
+    EXPECT_THROW(Checker::PlanScan({ ttreeFile, rntupleFile, "gen", "gen" }, request), std::runtime_error);
+}
+
+TEST(CheckerExpression, CompilesAndFoldsConstants) {
+    const Checker::Expression expression("sqrt(px*px + py*py) * (2 * 3 - 1) / -x");
+    EXPECT_EQ(expression.GetColumns(), (std::vector<std::string>{ "px", "py", "x" }));
+    EXPECT_EQ(expression.ToCpp(),
+              "((std::sqrt(((double(px) * double(px)) + (double(py) * double(py)))) * 5) / (-double(x)))");
+    EXPECT_EQ(Checker::Expression("pow(2, 10) + 0.5").ToCpp(), "1024.5");
+
+    EXPECT_THROW(Checker::Expression(""), std::runtime_error);
+    EXPECT_THROW(Checker::Expression("px +"), std::runtime_error);
+    EXPECT_THROW(Checker::Expression("(px"), std::runtime_error);
+    EXPECT_THROW(Checker::Expression("cbrt(px)"), std::runtime_error);
+    EXPECT_THROW(Checker::Expression("px ^ 2"), std::runtime_error);
+}
+
+TEST_F(GeneratedPairTest, ScanComparesDerivedQuantitiesInBatches) {
+    Generate(10000, "i,vf,d", { "value:double_2:7000" }, true); // int_0 holds the entry number
+
+    // Both differ where double_2 does, but the difference of the scaled quantity, 1e6, is within its tolerance
+    Checker::ScanRequest request;
+    request.fColumns = { "int_0" };
+    request.fDerived.push_back({ "sum", "double_2 + int_0 / 2" });
+    request.fDerived.push_back({ "scaled", "double_2 * 1e6" });
+    request.fTolerances.push_back({ "scaled", 2e6, 0 });
+    const auto plan = Checker::PlanScan({ ttreeFile, rntupleFile, "gen", "gen" }, request);
+    ASSERT_EQ(plan.fDerived.size(), 2u);
+    const auto result = Checker::RunScan(plan);
+
+    ASSERT_EQ(result.fIssues.size(), 1u);
+    EXPECT_EQ(result.fIssues[0], "Derived quantity sum differs at entry 7000");
+    EXPECT_EQ(result.fNCompared, 3u);
+
+    request.fDerived = { { "bad", "vfloat_1 * 2" } };
+    EXPECT_THROW(Checker::PlanScan({ ttreeFile, rntupleFile, "gen", "gen" }, request), std::runtime_error);
+}
+
+TEST_F(GeneratedPairTest, MatchesNativeScanAndComparesDerivedQuantities) {
+    Generate(10000, "i,vf,d", { "value:double_2:2500" }, true); // int_0 holds the entry number
+
+    Checker::ScanRequest request;
+    request.fHistograms = false;
+    request.fDerived.push_back({ "twice", "2 * int_0" });
+    request.fDerived.push_back({ "shifted", "double_2 + int_0" });
+    const auto plan = Checker::PlanScan({ ttreeFile, rntupleFile, "gen", "gen" }, request);
+    const auto native = Checker::RunScan(plan);
+    const auto frame = Checker::RunFrameScan(plan, 2);
+    EXPECT_FALSE(ROOT::IsImplicitMTEnabled()); // Only enabled while the scan ran
+
+    ASSERT_EQ(frame.fIssues.size(), 2u);
+    EXPECT_EQ(frame.fIssues[0], "double_2 differs at entry 2500"); // Located by the rescan of the differing column
+    EXPECT_EQ(frame.fIssues[1], "Derived quantity shifted differs at entry 2500");
+    EXPECT_EQ(frame.fIssues, native.fIssues);
+    EXPECT_EQ(frame.fNCompared, native.fNCompared);
+    EXPECT_EQ(frame.fNSelected, 10000);
+    for (std::size_t k = 0; k < frame.fTTreeStatistics.size(); ++k) {
+        EXPECT_EQ(frame.fTTreeStatistics[k].fEntries, native.fTTreeStatistics[k].fEntries);
+        EXPECT_NEAR(frame.fTTreeStatistics[k].fMean, native.fTTreeStatistics[k].fMean, 1e-6);
+        EXPECT_NEAR(frame.fRNTupleStatistics[k].GetStdDev(), native.fRNTupleStatistics[k].GetStdDev(), 1e-6);
+    }
+}
+
+TEST_F(GeneratedPairTest, ScanUsesRegisteredComparator) {
+    Generate(100, "i,s", { "value:string_1:60" });
+    const Checker::PairSpec pair{ ttreeFile, rntupleFile, "gen", "gen" };
+
+    // Without a comparator the string column is not compared
+    Checker::ScanRequest request;
+    request.fHistograms = false;
+    auto result = Checker::RunScan(Checker::PlanScan(pair, request));
+    EXPECT_TRUE(result.fIssues.empty());
+    EXPECT_EQ(result.fNCompared, 1u);
+
+    // Matches "string" in the TTree and "std::string" in the RNTuple, and compares by operator==
+    Checker::TypeComparator<std::string> comparator;
+    comparator.fAccumulate = [](const std::vector<std::string>& values, Checker::ScanStatistics& statistics) {
+        for (const auto& value : values) statistics.Fill(value.size());
+    };
+    Checker::RegisterComparator("*string", comparator);
+    result = Checker::RunScan(Checker::PlanScan(pair, request));
+    ASSERT_EQ(result.fIssues.size(), 1u);
+    EXPECT_EQ(result.fIssues[0], "string_1 differs at entry 60");
+    EXPECT_EQ(result.fNCompared, 2u);
+    ASSERT_EQ(result.fColumnStatistics.size(), 1u);
+    EXPECT_EQ(result.fColumnStatistics[0].fTTree.fEntries, 100);
+    EXPECT_NEAR(result.fColumnStatistics[0].fRNTuple.fMean, result.fColumnStatistics[0].fTTree.fMean + 0.01, 1e-9); // One "*" appended
+}
+
+TEST(CheckerBuffers, PoolRecyclesBuffers) {
+    auto& pool = Checker::BufferPool<float>::ForThread();
+    const float* data = nullptr;
+    {
+        Checker::PooledBuffer<float> buffer(1000);
+        EXPECT_TRUE(buffer->empty());
+        EXPECT_GE(buffer->capacity(), 1000u);
+        buffer->assign(1000, 1.0f);
+        data = buffer->data();
+    }
+    ASSERT_GE(pool.GetNFree(), 1u);
+    {
+        // The released buffer comes back emptied, with its storage intact
+        Checker::PooledBuffer<float> buffer(500);
+        EXPECT_TRUE(buffer->empty());
+        EXPECT_EQ(buffer->data(), data);
+    }
+}
+
+TEST_F(GeneratedPairTest, GeneratedPairMatches) {
+    Checker::GeneratorConfig config;
+    config.fEntries = 1000;
+    config.fColumns = 8;
+    config.fTypes = Checker::ParseColumnTypes("i,f,d,b");
+    Checker::GenerateTTree(config, ttreeFile, "gen");
+    Checker::GenerateRNTuple(config, rntupleFile, "gen");
+
+    {
+        Checker::Checker checker(ttreeFile, rntupleFile, "gen", "gen");
+        auto [ttreeEntries, rntupleEntries] = checker.CountEntries();
+        EXPECT_EQ(ttreeEntries, config.fEntries);
+        EXPECT_EQ(rntupleEntries, config.fEntries);
+        auto [ttreeFields, rntupleFields] = checker.CountFields();
+        EXPECT_EQ(ttreeFields, config.fColumns);
+        EXPECT_EQ(rntupleFields, config.fColumns);
+        EXPECT_EQ(checker.ReadIntFromTTree(), checker.ReadIntFromRNTuple());
+        EXPECT_EQ(checker.ReadDoubleFromTTree(), checker.ReadDoubleFromRNTuple());
+    }
+}
+
+TEST(CheckerGenerator, ParseColumnTypes) {
+    auto types = Checker::ParseColumnTypes("i,vector<float>,vb");
+    ASSERT_EQ(types.size(), 3u);
+    EXPECT_TRUE(types[0] == Checker::GenColumnType::kInt);
+    EXPECT_TRUE(types[1] == Checker::GenColumnType::kFloatVector);
+    EXPECT_TRUE(types[2] == Checker::GenColumnType::kBoolVector);
+    EXPECT_THROW(Checker::ParseColumnTypes("i,long"), std::invalid_argument);
+}
+
+TEST_F(GeneratedPairTest, InjectedMismatches) {
+    Checker::GeneratorConfig config;
+    config.fEntries = 100;
+    config.fSequential = true;
+    config.fNames = fieldsbranches;
+    config.fMismatches.push_back(Checker::ParseMismatch("value:value:42"));
+    config.fMismatches.push_back(Checker::ParseMismatch("rename:energy:mass@1"));
+    Checker::GeneratePairs(config, ttreeFile, rntupleFile, "tree", "rntuple", 1, 2);
+
+    {
+        Checker::Checker checker(ttreeFile, rntupleFile, "tree_0", "rntuple_0");
+        std::vector<int> ttreeValues = checker.ReadIntFromTTree();
+        std::vector<int> rntupleValues = checker.ReadIntFromRNTuple();
+        ASSERT_EQ(ttreeValues.size(), rntupleValues.size());
+        for (int i = 0; i < ttreeValues.size(); ++i) {
+            EXPECT_EQ(ttreeValues[i] == rntupleValues[i], i != 42);
+        }
+    }
+    {
+        Checker::Checker checker(ttreeFile, rntupleFile, "tree_1", "rntuple_1");
+        auto fieldNames = checker.CompareFieldNames();
+        EXPECT_TRUE(std::find(fieldNames.begin(), fieldNames.end(), std::make_pair(std::string("energy"), std::string("No match"))) != fieldNames.end());
+    }
+
+    EXPECT_THROW(Checker::ParseMismatch("value:energy"), std::invalid_argument);
+}
+
+TEST(CheckerBaseline, ThresholdAndMissingMetrics) {
+    const auto baseline = Checker::ParseBaseline(
+        "{ \"entries\": 1000, \"note\": \"recorded\", \"benchmarks\": {"
+        " \"Read\": { \"throughput\": 100.0, \"peak_rss_mb\": 50.0 },"
+        " \"Compare\": { \"throughput\": 10.0, \"peak_rss_mb\": 0 } } }");
+    EXPECT_EQ(baseline.fEntries, 1000);
+    EXPECT_TRUE(baseline.IsRecorded());
+    std::ostringstream out;
+
+    // Throughput may drop and peak memory may grow by up to the threshold
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 1000, { { "Read", 80.0, 60.0 } }, 0.25, out), Checker::BaselineStatus::kPassed);
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 1000, { { "Read", 70.0, 50.0 } }, 0.25, out), Checker::BaselineStatus::kFailed);
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 1000, { { "Read", 100.0, 65.0 } }, 0.25, out), Checker::BaselineStatus::kFailed);
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 1000, { { "Read", 70.0, 50.0 } }, 0.5, out), Checker::BaselineStatus::kPassed);
+
+    // A benchmark without a baseline, a metric recorded as 0 and a different number of entries fail
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 1000, { { "Read", 100.0, 50.0 }, { "Scan", 1.0, 1.0 } }, 0.25, out),
+              Checker::BaselineStatus::kFailed);
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 1000, { { "Compare", 10.0, 1.0 } }, 0.25, out), Checker::BaselineStatus::kFailed);
+    EXPECT_EQ(Checker::CheckBaseline(baseline, 2000, { { "Read", 100.0, 50.0 } }, 0.25, out), Checker::BaselineStatus::kFailed);
+    EXPECT_NE(out.str().find("Scan: no baseline recorded  MISSING"), std::string::npos);
+    EXPECT_NE(out.str().find("Compare: baseline metric missing or 0  MISSING"), std::string::npos);
+
+    // A baseline of zeros has not been recorded yet, so there is nothing to gate against
+    const auto unrecorded = Checker::ParseBaseline("{ \"entries\": 1000, \"benchmarks\": { \"Read\": { \"throughput\": 0, \"peak_rss_mb\": 0 } } }");
+    EXPECT_FALSE(unrecorded.IsRecorded());
+    EXPECT_EQ(Checker::CheckBaseline(unrecorded, 1000, { { "Read", 100.0, 50.0 } }, 0.25, out), Checker::BaselineStatus::kNotRecorded);
+    EXPECT_FALSE(Checker::ParseBaseline("{ \"entries\": 1000 }").IsRecorded());
+
+    EXPECT_THROW(Checker::ParseBaseline("{ \"entries\": }"), std::runtime_error);
+    EXPECT_THROW(Checker::ParseBaseline("[]"), std::runtime_error);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
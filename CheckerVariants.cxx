@@ -0,0 +1,169 @@
+/// \file CheckerVariants.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerVariants.hxx"
+#include "Checker.hxx"
+#include "CheckerBuffers.hxx"
+#include "CheckerCLI.hxx"
+#include "CheckerSource.hxx"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+
+namespace Checker {
+
+    namespace {
+
+        // A variant taking part in the value comparison of one column
+        struct ColumnTarget {
+            ColumnSource* fSource;
+            VariantResult* fResult;
+        };
+
+        // Reads each batch of the reference column once and compares it with the same batch of every target
+        template <typename T>
+        void StreamColumn(ColumnSource& reference, const std::string& name, long long nEntries, const std::vector<ColumnTarget>& targets) {
+            PooledBuffer<T> referenceBatch;
+            PooledBuffer<T> candidateBatch;
+            std::vector<long long> mismatch(targets.size(), -1);
+            std::size_t nOpen = targets.size(); // Targets without a difference so far
+            for (long long first = 0; first < nEntries && nOpen > 0; first += kBatchEntries) {
+                const long long count = std::min<long long>(kBatchEntries, nEntries - first);
+                reference.Read(name, first, count, *referenceBatch);
+
+                for (std::size_t k = 0; k < targets.size(); ++k) {
+                    if (mismatch[k] >= 0) {
+                        continue;
+                    }
+                    targets[k].fSource->Read(name, first, count, *candidateBatch);
+                    auto diff = std::mismatch(referenceBatch->begin(), referenceBatch->end(), candidateBatch->begin());
+                    if (diff.first != referenceBatch->end()) {
+                        mismatch[k] = first + (diff.first - referenceBatch->begin());
+                        --nOpen;
+                    }
+                }
+            }
+
+            for (std::size_t k = 0; k < targets.size(); ++k) {
+                if (mismatch[k] >= 0) {
+                    targets[k].fResult->fIssues.push_back(name + " differs at entry " + std::to_string(mismatch[k]));
+                }
+            }
+        }
+
+    } // namespace
+
+    std::vector<VariantResult> CompareVariants(const std::string& ttreeFile, const std::string& ttreeName,
+                                               const std::vector<VariantSpec>& variants) {
+        TTreeSource reference(ttreeFile, ttreeName);
+        const long long nEntries = reference.GetNEntries();
+
+        std::vector<VariantResult> results(variants.size());
+        std::vector<std::unique_ptr<RNTupleSource>> sources(variants.size());
+        std::map<std::string, std::string> columnTypes;                 // Scalar column -> "int", "float", ...
+        std::map<std::string, std::vector<std::size_t>> columnVariants; // Scalar column -> variants comparing it
+
+        // Structural checks per variant, from metadata only
+        for (std::size_t k = 0; k < variants.size(); ++k) {
+            auto& result = results[k];
+            result.fVariant = variants[k];
+            try {
+                Checker checker(ttreeFile, variants[k].fRNTupleFile, ttreeName, variants[k].fRNTupleName);
+                const auto entries = checker.CountEntries();
+                if (entries.first != entries.second) {
+                    result.fIssues.push_back("Entry count differs: " + std::to_string(entries.first) + " (TTree) vs "
+                                             + std::to_string(entries.second) + " (RNTuple)");
+                }
+
+                std::vector<std::string> columns;
+                for (const auto& types : checker.CompareFieldTypes()) {
+                    const std::string& name = std::get<0>(types);
+                    const std::string& ttreeType = std::get<1>(types);
+                    const std::string& rntupleType = std::get<2>(types);
+                    if (ttreeType == "No match") {
+                        result.fIssues.push_back("Field only in RNTuple: " + name);
+                        continue;
+                    }
+                    if (rntupleType == "No match") {
+                        result.fIssues.push_back("Field only in TTree: " + name);
+                        continue;
+                    }
+                    const std::string type = MapFieldType(ttreeType);
+                    switch (MatchFieldTypes(ttreeType, rntupleType)) {
+                    case FieldTypeMatch::kExact:
+                        if (type.find("vector") == std::string::npos) {
+                            columns.push_back(name);
+                            columnTypes[name] = type;
+                        }
+                        break;
+                    case FieldTypeMatch::kMismatch:
+                        result.fIssues.push_back("Type mismatch for " + name + ": " + ttreeType + " vs " + rntupleType);
+                        break;
+                    default:
+                        result.fWarnings.push_back("Values not compared for " + name + ": " + ttreeType + " vs " + rntupleType);
+                        break;
+                    }
+                }
+
+                // Only variants with the same structure take part in the value comparison
+                if (result.fIssues.empty()) {
+                    sources[k] = std::make_unique<RNTupleSource>(variants[k].fRNTupleFile, variants[k].fRNTupleName);
+                    result.fNColumns = columns.size();
+                    for (const auto& name : columns) {
+                        columnVariants[name].push_back(k);
+                    }
+                }
+            }
+            catch (const std::exception& e) {
+                result.fError = e.what();
+            }
+        }
+
+        // One pass over the reference per column, shared by all variants
+        for (const auto& column : columnVariants) {
+            const std::string& name = column.first;
+            std::vector<ColumnTarget> targets;
+            for (std::size_t k : column.second) {
+                if (results[k].fError.empty()) {
+                    targets.push_back({ sources[k].get(), &results[k] });
+                }
+            }
+            if (targets.empty()) {
+                continue;
+            }
+            try {
+                const std::string& type = columnTypes[name];
+                if (type == "int") StreamColumn<int>(reference, name, nEntries, targets);
+                else if (type == "float") StreamColumn<float>(reference, name, nEntries, targets);
+                else if (type == "double") StreamColumn<double>(reference, name, nEntries, targets);
+                else if (type == "bool") StreamColumn<bool>(reference, name, nEntries, targets);
+            }
+            catch (const std::exception& e) {
+                for (auto& target : targets) {
+                    target.fResult->fIssues.push_back("Cannot compare " + name + ": " + e.what());
+                }
+            }
+        }
+
+        for (auto& result : results) {
+            result.fPassed = result.fError.empty() && result.fIssues.empty();
+        }
+        return results;
+    }
+
+} // namespace Checker
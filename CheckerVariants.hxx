@@ -0,0 +1,59 @@
+/// \file CheckerVariants.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERVARIANTS_HXX
+#define CHECKERVARIANTS_HXX
+
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief One RNTuple written from the reference TTree, e.g. with other compression or cluster settings.
+     */
+    struct VariantSpec {
+        std::string fRNTupleFile;
+        std::string fRNTupleName;
+    };
+
+    /**
+     * @brief Outcome of comparing one variant with the reference TTree.
+     */
+    struct VariantResult {
+        VariantSpec fVariant;
+        bool fPassed = false;
+        std::size_t fNColumns = 0;          // Scalar columns compared value by value
+        std::vector<std::string> fIssues;
+        std::vector<std::string> fWarnings; // Columns not compared, e.g. float against double
+        std::string fError;                 // Set if the variant could not be read at all
+    };
+
+    /**
+     * @brief Compares one TTree with several RNTuple variants, reading the TTree only once.
+     *
+     * Each variant is first checked for entry count, field names and field types. The scalar columns of the
+     * variants that pass are then compared value by value: every TTree batch is read once and handed to the
+     * comparator of each variant, so the cost on the reference side does not grow with the number of variants.
+     *
+     * @return One result per variant, in the order of the input.
+     * @throws std::runtime_error if the TTree cannot be read.
+     */
+    std::vector<VariantResult> CompareVariants(const std::string& ttreeFile, const std::string& ttreeName,
+                                               const std::vector<VariantSpec>& variants);
+
+} // namespace Checker
+
+#endif // CHECKERVARIANTS_HXX
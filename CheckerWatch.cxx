@@ -0,0 +1,189 @@
+/// \file CheckerWatch.cxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "CheckerWatch.hxx"
+
+#include <TROOT.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Checker {
+
+    namespace {
+
+        // How often Watch() looks at the stop flag while no file is written
+        constexpr int kPollMilliseconds = 200;
+
+        std::pair<std::string, std::string> SplitFileRule(const std::string& fileRule) {
+            const std::size_t colon = fileRule.find(':');
+            if (colon == std::string::npos || colon + 1 == fileRule.size()) {
+                throw std::runtime_error("File rule must have the form <from>:<to> with a non-empty <to>: " + fileRule);
+            }
+            return { fileRule.substr(0, colon), fileRule.substr(colon + 1) };
+        }
+
+        bool FileExists(const std::string& path) {
+            struct stat info;
+            return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+        }
+
+    } // namespace
+
+    std::string MatchTTreeFile(const std::string& rntupleFile, const std::string& fileRule, const std::string& ttreeDirectory) {
+        const auto rule = SplitFileRule(fileRule);
+        const std::size_t slash = rntupleFile.rfind('/');
+        const std::string directory = slash == std::string::npos ? "" : rntupleFile.substr(0, slash + 1);
+        std::string name = rntupleFile.substr(directory.size());
+
+        const std::size_t pos = name.rfind(rule.second);
+        if (pos == std::string::npos) {
+            return "";
+        }
+        name.replace(pos, rule.second.size(), rule.first);
+        return (ttreeDirectory.empty() ? directory : ttreeDirectory + "/") + name;
+    }
+
+    Watcher::Watcher(const std::string& directory, const std::string& fileRule, const std::string& pairRule, unsigned maxJobs,
+                     const std::string& ttreeDirectory)
+        : fDirectory(directory), fFileRule(fileRule), fPairRule(pairRule),
+          fMaxJobs(maxJobs ? maxJobs : std::max(1u, std::thread::hardware_concurrency())), fTTreeDirectory(ttreeDirectory) {
+        SplitFileRule(fileRule); // Fail here rather than on the first file
+    }
+
+    void Watcher::Watch(const ResultCallback& onResult) {
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot initialize inotify: " + std::string(std::strerror(errno)));
+        }
+        if (inotify_add_watch(fd, fDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            const std::string error = std::strerror(errno);
+            close(fd);
+            throw std::runtime_error("Cannot watch directory: " + fDirectory + ": " + error);
+        }
+
+        ROOT::EnableThreadSafety();
+        std::mutex callbackMutex;
+        auto report = [&](const PairResult& result) {
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            onResult(result);
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < fMaxJobs; ++t) {
+            workers.emplace_back(&Watcher::RunJobs, this, std::cref(report));
+        }
+
+        fWatching = true;
+        alignas(inotify_event) char buffer[16 * 1024];
+        while (!fStop) {
+            pollfd ready{ fd, POLLIN, 0 };
+            if (poll(&ready, 1, kPollMilliseconds) <= 0) {
+                continue; // Timeout or signal: look at the stop flag again
+            }
+            const ssize_t n = read(fd, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < n;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0 && !(event->mask & IN_ISDIR) && event->name[0] != '.') {
+                    OnFileWritten(fDirectory + "/" + event->name);
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        fWatching = false;
+        fQueueChanged.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        close(fd);
+    }
+
+    void Watcher::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(fQueueMutex);
+            fStop = true;
+        }
+        fQueueChanged.notify_all();
+    }
+
+    std::vector<PairResult> Watcher::VerifyFile(const std::string& rntupleFile, const std::string& ttreeFile) const {
+        std::vector<PairResult> results;
+        try {
+            const auto pairing = PairByName(ttreeFile, rntupleFile, fPairRule);
+            for (const auto& pair : pairing.fPairs) {
+                results.push_back(CheckPair(pair));
+            }
+            const auto unpaired = ReportUnpaired(pairing, ttreeFile, rntupleFile);
+            results.insert(results.end(), unpaired.begin(), unpaired.end());
+        }
+        catch (const std::exception& e) {
+            PairResult result;
+            result.fPair = { ttreeFile, rntupleFile, "", "" };
+            result.fError = e.what();
+            results.push_back(result);
+        }
+        return results;
+    }
+
+    void Watcher::OnFileWritten(const std::string& path) {
+        std::lock_guard<std::mutex> lock(fQueueMutex);
+
+        // A TTree file that an RNTuple file was waiting for
+        auto waiting = fWaiting.find(path);
+        if (waiting != fWaiting.end()) {
+            fQueue.emplace_back(waiting->second, path);
+            fWaiting.erase(waiting);
+            fQueueChanged.notify_one();
+        }
+
+        const std::string ttreeFile = MatchTTreeFile(path, fFileRule, fTTreeDirectory);
+        if (ttreeFile.empty() || ttreeFile == path) {
+            return; // Not an RNTuple file by the rule
+        }
+        if (FileExists(ttreeFile)) {
+            fQueue.emplace_back(path, ttreeFile);
+            fQueueChanged.notify_one();
+        }
+        else {
+            fWaiting[ttreeFile] = path;
+        }
+    }
+
+    void Watcher::RunJobs(const ResultCallback& onResult) {
+        while (true) {
+            std::pair<std::string, std::string> job;
+            {
+                std::unique_lock<std::mutex> lock(fQueueMutex);
+                fQueueChanged.wait(lock, [&]() { return fStop || !fQueue.empty(); });
+                if (fStop) {
+                    return;
+                }
+                job = fQueue.front();
+                fQueue.pop_front();
+            }
+            for (const auto& result : VerifyFile(job.first, job.second)) {
+                onResult(result);
+            }
+        }
+    }
+
+} // namespace Checker
@@ -0,0 +1,119 @@
+/// \file CheckerWatch.hxx
+/// \ingroup NTuple ROOT7
+/// \author Ida Caspary <ida.caspary@gmail.com>
+/// \date 2024-10-14
+/// \warning This is part of the ROOT 7 prototype! It will change without notice. It might trigger earthquakes. Feedback
+/// is welcome!
+
+/*************************************************************************
+ * Copyright (C) 1995-2023, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef CHECKERWATCH_HXX
+#define CHECKERWATCH_HXX
+
+#include "CheckerBatch.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Checker {
+
+    /**
+     * @brief Returns the TTree file matching an RNTuple file by a file naming rule `<from>:<to>`.
+     *
+     * The rule reads like the pairing rule of PairByName, from the TTree side: the last `<to>` in the file
+     * name of the RNTuple file is replaced by `<from>`, so "ttree:rntuple" maps run_7_rntuple.root to
+     * run_7_ttree.root. If ttreeDirectory is not empty, the TTree file is looked for there instead of next to
+     * the RNTuple file.
+     *
+     * @return The path of the TTree file, or an empty string if the file name does not contain `<to>`.
+     * @throws std::runtime_error if the rule has no ':' or an empty `<to>`.
+     */
+    std::string MatchTTreeFile(const std::string& rntupleFile, const std::string& fileRule, const std::string& ttreeDirectory = "");
+
+    /**
+     * @brief Watches a directory with inotify and verifies every RNTuple file as soon as it is written.
+     *
+     * A file counts as written when it is closed after writing or moved into the directory, so converters
+     * that write to a temporary name and rename it are handled as well. Files whose name does not match the
+     * file rule, or starts with '.', are ignored. Every TTree of the matching TTree file is paired by name with
+     * an RNTuple of the new file (see PairByName) and each pair is verified with CheckPair. Trees or RNTuples
+     * left without a partner are reported as failed pairs.
+     *
+     * If the TTree file does not exist yet, the RNTuple file waits until the TTree file is written to the
+     * watched directory. At most GetMaxJobs() files are verified at the same time; further files queue up.
+     */
+    class Watcher {
+    public:
+        /// Called once per pair, from the worker thread that verified it; calls are serialized
+        using ResultCallback = std::function<void(const PairResult&)>;
+
+        /**
+         * @param directory Directory watched for new RNTuple files.
+         * @param fileRule Rule mapping an RNTuple file to its TTree file, see MatchTTreeFile.
+         * @param pairRule Rule pairing the trees and RNTuples inside the files, see PairByName.
+         * @param maxJobs Files verified at the same time; 0 uses one per hardware thread.
+         * @param ttreeDirectory Directory of the TTree files; empty for the watched directory.
+         */
+        Watcher(const std::string& directory, const std::string& fileRule = "ttree:rntuple", const std::string& pairRule = "",
+                unsigned maxJobs = 0, const std::string& ttreeDirectory = "");
+
+        Watcher(const Watcher&) = delete;
+        Watcher& operator=(const Watcher&) = delete;
+
+        /**
+         * @brief Watches the directory and reports every verified pair until Stop() is called.
+         *
+         * Files queued but not yet started when Stop() is called are dropped; running ones are finished.
+         *
+         * @throws std::runtime_error if the directory cannot be watched.
+         */
+        void Watch(const ResultCallback& onResult);
+
+        /**
+         * @brief Makes Watch() return. Safe to call from any thread, also from the callback.
+         */
+        void Stop();
+
+        /**
+         * @brief Pairs and verifies one RNTuple file with its TTree file, as Watch() does for each new file.
+         */
+        std::vector<PairResult> VerifyFile(const std::string& rntupleFile, const std::string& ttreeFile) const;
+
+        unsigned GetMaxJobs() const { return fMaxJobs; }
+        /// True once Watch() receives the events of the directory
+        bool IsWatching() const { return fWatching; }
+
+    private:
+        // Queues the RNTuple file, or an RNTuple file waiting for this TTree file
+        void OnFileWritten(const std::string& path);
+        void RunJobs(const ResultCallback& onResult);
+
+        std::string fDirectory;
+        std::string fFileRule;
+        std::string fPairRule;
+        unsigned fMaxJobs;
+        std::string fTTreeDirectory;
+        std::atomic<bool> fStop{ false };
+        std::atomic<bool> fWatching{ false };
+
+        std::mutex fQueueMutex;
+        std::condition_variable fQueueChanged;
+        std::deque<std::pair<std::string, std::string>> fQueue; // RNTuple file and TTree file
+        std::map<std::string, std::string> fWaiting;            // Missing TTree file -> RNTuple file waiting for it
+    };
+
+} // namespace Checker
+
+#endif // CHECKERWATCH_HXX
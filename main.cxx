@@ -15,53 +15,171 @@
 
 #include "Checker.hxx"
 #include "CheckerCLI.hxx"
+#include <climits>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 using namespace Checker;
 
-int main(int argc, char *argv[]) {
-    gErrorIgnoreLevel = kError;
+namespace {
 
-    // Check if the number of arguments is less than 9; if true, print usage instructions and exit
-    if (argc < 9) {
-        std::cerr << "Usage: " << argv[0] << " -t <ttreeFile> -r <rntupleFile> -tn <ttreeName> -rn <rntupleName>\n";
-        exit(1);
+    void PrintUsage(const char* argv0) {
+        std::cerr << "Usage: " << argv0 << " -t <ttreeFile> -r <rntupleFile> -tn <ttreeName> -rn <rntupleName> [--policy <file>] [--select <cut>] [--engine native|dataframe] [-v] [-m]\n"
+                  << "       " << argv0 << " -t <ttreeFile> -r <rntupleFile> -tn <ttreeName> -rn <rntupleName> (--fail-fast | --plan) [-v]\n"
+                  << "       " << argv0 << " -t <ttreeFile> -r <rntupleFile> --all [--pair-rule <from>:<to>] [-j <threads>] [-v]\n"
+                  << "       " << argv0 << " --chain -t <ttreeFiles> -r <rntupleFiles> -tn <ttreeName> -rn <rntupleName> [-j <threads>] [-v]\n"
+                  << "       " << argv0 << " --variants -t <ttreeFile> -r <rntupleFiles> -tn <ttreeName> -rn <rntupleName[s]> [-v]\n"
+                  << "       " << argv0 << " -a <fileA> -an <nameA> -b <fileB> -bn <nameB> [-j <threads>] [-v]\n"
+                  << "       " << argv0 << " --manifest <file> [-j <threads>] [--checkpoint <file>] [-v]\n"
+                  << "       " << argv0 << " --serve <socket> [-j <jobs>]\n"
+                  << "       " << argv0 << " --submit <socket> (-t ... -rn ... | --manifest <file>)\n"
+                  << "       " << argv0 << " --watch <directory> [--file-rule <from>:<to>] [--pair-rule <from>:<to>] [-j <jobs>]\n";
+    }
+
+    // Reads a thread or job count; false unless the whole value is a non-negative number that fits
+    bool ParseCount(const std::string& value, unsigned& count) {
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        try {
+            const unsigned long parsed = std::stoul(value);
+            if (parsed > UINT_MAX) {
+                return false;
+            }
+            count = static_cast<unsigned>(parsed);
+            return true;
+        }
+        catch (const std::out_of_range&) {
+            return false;
+        }
     }
 
+} // namespace
+
+int main(int argc, char *argv[]) {
+    gErrorIgnoreLevel = kError;
+
     // Create a configuration object to store command-line arguments
     CheckerConfig config;
     bool verbose = false; // Initialize a flag to check if verbose mode should be enabled
 
     // Loop through the command-line arguments to parse options and their values
-    for (int i = 1; i < argc; i += 2) {
+    for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i]; // Store the current argument in a string
-        if (arg == "-t") {
-            config.fTTreeFile = argv[i + 1];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-t" && hasValue) {
+            config.fTTreeFile = argv[++i];
         }
-        else if (arg == "-r") {
-            config.fRNTupleFile = argv[i + 1];
+        else if (arg == "-r" && hasValue) {
+            config.fRNTupleFile = argv[++i];
         }
-        else if (arg == "-tn") {
-            config.fTTreeName = argv[i + 1];
+        else if (arg == "-tn" && hasValue) {
+            config.fTTreeName = argv[++i];
         }
-        else if (arg == "-rn") {
-            config.fRNTupleName = argv[i + 1];
+        else if (arg == "-rn" && hasValue) {
+            config.fRNTupleName = argv[++i];
         }
         else if (arg == "-v") {
             verbose = true;  // Enable verbosity if '-v' is passed
         }
+        else if (arg == "-m") {
+            config.fMemoryReport = true;  // Print memory per phase and column after the check
+        }
+        else if (arg == "--manifest" && hasValue) {
+            config.fManifest = argv[++i];  // Verify every pair listed in the manifest
+        }
+        else if ((arg == "-j" || arg == "--threads") && hasValue) {
+            if (!ParseCount(argv[++i], config.fThreads)) {
+                std::cerr << "Invalid value for " << arg << ": " << argv[i] << " (expected a number of threads)" << std::endl;
+                PrintUsage(argv[0]);
+                exit(1);
+            }
+        }
+        else if (arg == "--all") {
+            config.fAllPairs = true;  // Pair every TTree of -t with an RNTuple of -r
+        }
+        else if (arg == "--pair-rule" && hasValue) {
+            config.fPairRule = argv[++i];
+        }
+        else if (arg == "--chain") {
+            config.fChain = true;  // -t and -r are comma-separated or @file lists of files
+        }
+        else if (arg == "--variants") {
+            config.fVariants = true;  // -r (and optionally -rn) list the RNTuple variants of the one TTree
+        }
+        else if (arg == "-a" && hasValue) {
+            config.fFileA = argv[++i];  // Same-format mode: -a/-an and -b/-bn name any two TTrees or RNTuples
+        }
+        else if (arg == "-an" && hasValue) {
+            config.fNameA = argv[++i];
+        }
+        else if (arg == "-b" && hasValue) {
+            config.fFileB = argv[++i];
+        }
+        else if (arg == "-bn" && hasValue) {
+            config.fNameB = argv[++i];
+        }
+        else if (arg == "--serve" && hasValue) {
+            config.fServeSocket = argv[++i];  // Stay resident and take jobs on this Unix socket
+        }
+        else if (arg == "--submit" && hasValue) {
+            config.fSubmitSocket = argv[++i];  // Hand the job(s) to the daemon on this socket
+        }
+        else if (arg == "--fail-fast") {
+            config.fFailFast = true;  // Run the cheapest checks first and stop at the first failure
+        }
+        else if (arg == "--plan") {
+            config.fShowPlan = true;  // Print the planned checks with their estimated costs
+        }
+        else if (arg == "--checkpoint" && hasValue) {
+            config.fCheckpoint = argv[++i];  // Resume an interrupted batch, chain or same-format run
+        }
+        else if (arg == "--watch" && hasValue) {
+            config.fWatchDirectory = argv[++i];  // Verify RNTuple files as they are written to this directory
+        }
+        else if (arg == "--file-rule" && hasValue) {
+            config.fFileRule = argv[++i];
+        }
+        else if (arg == "--select" && hasValue) {
+            config.fSelection = argv[++i];  // Only check the entries passing this cut, e.g. "nJet > 2 && run >= 100"
+        }
+        else if (arg == "--engine" && hasValue) {
+            config.fEngine = argv[++i];  // native, or dataframe for RDataFrame event loops on -j threads
+        }
+        else if (arg == "--policy" && hasValue) {
+            config.fPolicy = argv[++i];  // Select the checks, columns, tolerances and fail-fast rule from this file
+        }
         else {
             std::cerr << "Unknown option: " << arg << std::endl;
             exit(1);
         }
     }
 
+    // Without a manifest -t, -r, -tn and -rn are required (only -t and -r with --all), or all of -a, -an, -b and -bn;
+    // --serve and --watch need none of them. If missing, print usage and exit
+    const bool missingFiles = config.fTTreeFile.empty() || config.fRNTupleFile.empty();
+    const bool missingNames = config.fTTreeName.empty() || config.fRNTupleName.empty();
+    const bool sameFormat = !config.fFileA.empty() && !config.fNameA.empty() && !config.fFileB.empty() && !config.fNameB.empty();
+    if (config.fServeSocket.empty() && config.fWatchDirectory.empty() && config.fManifest.empty() && !sameFormat && (missingFiles || (!config.fAllPairs && missingNames))) {
+        PrintUsage(argv[0]);
+        exit(1);
+    }
+
+    // --fail-fast and --plan run the planned checks, which take none of the scan options
+    if ((config.fFailFast || config.fShowPlan) && (!config.fPolicy.empty() || !config.fSelection.empty() || !config.fEngine.empty())) {
+        std::cerr << "--fail-fast and --plan cannot be combined with --policy, --select or --engine;"
+                  << " set fail_fast in the policy to stop the scan early" << std::endl;
+        PrintUsage(argv[0]);
+        exit(1);
+    }
+
     // Set the flag to indicate the comparison should run
     config.fShouldRun = true;
 
     CheckerCLI cli;            // Create a CLI object to handle user interaction and output
     cli.SetVerbosity(verbose); // Set verbosity in the CLI object based on the command-line option
-    cli.RunAll(config);        // Run the main comparison logic using the configured options
+    const bool passed = cli.RunAll(config); // Run the main comparison logic using the configured options
 
-    return 0;  // Exit the program successfully
+    return passed ? 0 : 1;  // Exit with an error if a batch run found a failing pair
 }